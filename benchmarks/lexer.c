@@ -0,0 +1,113 @@
+/**
+ * @file lexer.c
+ * @brief Lexer throughput on a large synthetic source.
+ *
+ * Builds two corpora, one shaped like generated modules (functions with
+ * arithmetic, keywords, string literals and a few comments) and one that is
+ * mostly documentation comments and long string literals, lexes each a few
+ * times and reports the best run in MB/s and millions of tokens per second.
+ *
+ * Usage: bench_lexer [megabytes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lexer.h"
+
+#define LEX_REPETITIONS 5
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static size_t appendCode(char *buf, size_t capacity, int i) {
+    return snprintf(buf, capacity,
+        "// helper %d: scales the input and folds in the loop counter\n"
+        "fn compute_%d(value: int, scale: i64) -> int {\n"
+        "    let total: int = value * %d + (scale >> 2);\n"
+        "    /* walk the range once,\n"
+        "       accumulating into total */\n"
+        "    for (let k: int = 0; k < %d; k++) {\n"
+        "        if (total >= 1000 && k != 3) { total -= k; } else { total += 2; }\n"
+        "    }\n"
+        "    const label: str = \"module %d \\\"generated\\\"\";\n"
+        "    return total <<= 1;\n"
+        "}\n\n",
+            i, i, i % 97, i % 13 + 1, i);
+}
+
+static size_t appendComments(char *buf, size_t capacity, int i) {
+    return snprintf(buf, capacity,
+        "/*\n"
+        " * compute_%d walks the input range once and folds every element into a\n"
+        " * running total. Values above the threshold are reduced by the counter,\n"
+        " * everything else is bumped by two, which keeps the result bounded.\n"
+        " */\n"
+        "// The label below is only used when tracing is enabled; it is kept in\n"
+        "// the binary so that release and debug builds have the same layout.\n"
+        "const doc_%d: str = \"compute_%d: folds the range into a bounded running total, "
+        "see the block comment above for the exact rule\";\n\n",
+        i, i, i);
+}
+
+typedef size_t (*AppendFn)(char *buf, size_t capacity, int i);
+
+static char *generateCorpus(AppendFn append, size_t targetBytes, size_t *outLen) {
+    size_t capacity = targetBytes + 4096;
+    char *buf = malloc(capacity);
+    if (!buf) return NULL;
+
+    size_t len = 0;
+    for (int i = 0; len < targetBytes; i++) {
+        len += append(buf + len, capacity - len, i);
+    }
+    *outLen = len;
+    return buf;
+}
+
+static int benchCorpus(const char *name, AppendFn append, size_t megabytes) {
+    size_t len;
+    char *corpus = generateCorpus(append, megabytes << 20, &len);
+    if (!corpus) {
+        fprintf(stderr, "Cannot allocate %zu MB corpus\n", megabytes);
+        return 0;
+    }
+
+    double best = 0;
+    size_t tokenCount = 0;
+    for (int rep = 0; rep < LEX_REPETITIONS; rep++) {
+        double t0 = nowMs();
+        TokenList *tokens = lex(corpus, "bench");
+        double elapsed = nowMs() - t0;
+        if (!tokens) {
+            fprintf(stderr, "Lexing failed\n");
+            free(corpus);
+            return 0;
+        }
+        tokenCount = tokens->count;
+        freeTokens(tokens);
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+
+    double mb = len / (1024.0 * 1024.0);
+    printf("%10s %10.1f %10zu %10.2f %10.1f %12.2f\n", name, mb, tokenCount, best,
+           mb / (best / 1e3), tokenCount / (best * 1e3));
+    free(corpus);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? (size_t)atoi(argv[1]) : 64;
+    if (megabytes == 0) megabytes = 64;
+
+    printf("%10s %10s %10s %10s %10s %12s\n", "corpus", "MB", "tokens", "best ms", "MB/s",
+           "Mtokens/s");
+    if (!benchCorpus("code", appendCode, megabytes)) return 1;
+    if (!benchCorpus("comments", appendComments, megabytes)) return 1;
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file moduleGraph.c
+ * @brief Module discovery and topological sort on synthetic projects.
+ *
+ * Generates projects of increasing size where module i imports i-1, i/2
+ * and i/3, then times findModules and topoSortModules (best of a few runs).
+ * The per-module cost should stay flat as the project grows.
+ *
+ * Usage: bench_module_graph [modules] [jobs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "build.h"
+
+#define SORT_REPETITIONS 5
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void modulePath(char *out, size_t size, const char *dir, int i) {
+    snprintf(out, size, "%s/m%d.orn", dir, i);
+}
+
+static int generateProject(const char *dir, int count) {
+    char path[512];
+    for (int i = 0; i < count; i++) {
+        modulePath(path, sizeof(path), dir, i);
+        FILE *f = fopen(path, "w");
+        if (!f) return 0;
+        if (i > 0) fprintf(f, "import \"m%d\";\n", i - 1);
+        if (i > 3) fprintf(f, "import \"m%d\";\n", i / 2);
+        if (i > 5) fprintf(f, "import \"m%d\";\n", i / 3);
+        fprintf(f, "export fn f%d(x: int) -> int { return x + %d; }\n", i, i);
+        fclose(f);
+    }
+    return 1;
+}
+
+static void removeProject(const char *dir, int count) {
+    char path[512];
+    for (int i = 0; i < count; i++) {
+        modulePath(path, sizeof(path), dir, i);
+        remove(path);
+    }
+}
+
+int main(int argc, char **argv) {
+    int sizes[] = {1000, 2500, 5000, 10000};
+    int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+    if (argc > 1) {
+        sizes[0] = atoi(argv[1]);
+        sizeCount = 1;
+    }
+    int jobs = argc > 2 ? atoi(argv[2]) : 0;
+
+    char dir[] = "/tmp/orn-bench-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    printf("%8s %12s %12s %14s %14s\n", "modules", "discover ms", "sort ms", "discover us/m",
+           "sort us/m");
+    int failed = 0;
+    for (int s = 0; s < sizeCount && !failed; s++) {
+        int n = sizes[s];
+        if (!generateProject(dir, n)) {
+            fprintf(stderr, "Cannot generate project in %s\n", dir);
+            failed = 1;
+            break;
+        }
+
+        char entry[512];
+        modulePath(entry, sizeof(entry), dir, n - 1);
+
+        BuildContext ctx = {.jobs = jobs};
+        double t0 = nowMs();
+        int found = findModules(&ctx, entry);
+        double discoverMs = nowMs() - t0;
+
+        // Sorting is cheap enough that the first run is dominated by cold caches
+        double sortMs = 0;
+        int sortedCount = 0;
+        for (int rep = 0; found && rep < SORT_REPETITIONS; rep++) {
+            double t1 = nowMs();
+            int *sorted = topoSortModules(&ctx, &sortedCount);
+            double elapsed = nowMs() - t1;
+            free(sorted);
+            if (!sorted) break;
+            if (rep == 0 || elapsed < sortMs) sortMs = elapsed;
+        }
+
+        if (!found || sortedCount != n) {
+            fprintf(stderr, "Discovery/sort failed for %d modules\n", n);
+            failed = 1;
+        } else {
+            printf("%8d %12.2f %12.3f %14.2f %14.4f\n", n, discoverMs, sortMs,
+                   discoverMs * 1e3 / n, sortMs * 1e3 / n);
+        }
+
+        freeBuildContext(&ctx);
+        removeProject(dir, n);
+    }
+
+    rmdir(dir);
+    return failed;
+}
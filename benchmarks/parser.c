@@ -0,0 +1,124 @@
+/**
+ * @file parser.c
+ * @brief Parser throughput on an expression-heavy synthetic source.
+ *
+ * Builds a corpus shaped like generated numeric code: large constant tables
+ * and functions made of long arithmetic, bitwise and comparison formulas.
+ * The source is lexed once, then ASTGenerator runs a few times over the same
+ * tokens and the best run is reported in MB/s and millions of tokens per
+ * second. ASTGeneratorDeferred is timed the same way, which is the up-front
+ * cost when function bodies are left for later.
+ *
+ * Usage: bench_parser [megabytes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lexer.h"
+#include "parser.h"
+#include "errorHandling.h"
+
+#define PARSE_REPETITIONS 5
+#define TABLE_SIZE 32
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static size_t appendTable(char *buf, size_t capacity, int i) {
+    size_t len = snprintf(buf, capacity, "const table_%d: int[%d] = [", i, TABLE_SIZE);
+    for (int k = 0; k < TABLE_SIZE && len < capacity; k++) {
+        len += snprintf(buf + len, capacity - len, k ? ", %d" : "%d", (i * 31 + k * 7) % 1000);
+    }
+    if (len < capacity) len += snprintf(buf + len, capacity - len, "];\n");
+    return len;
+}
+
+static size_t appendFormula(char *buf, size_t capacity, int i) {
+    return snprintf(buf, capacity,
+        "fn formula_%d(a: int, b: int, c: int) -> int {\n"
+        "    let x: int = (a * %d + b) * (c - 7) / 2 + (a << 2) - (b >> 1) %% 5;\n"
+        "    let y: int = x * x - a * b + c * (a + b) - (x & 255) ^ (y | 16);\n"
+        "    x += y * 3 - -a + (b != c) + (a <= b && b >= c || !(x == y));\n"
+        "    y = a > b ? (x - y) * 2 : y < c ? x + y : (a + b + c) * (a - b - c);\n"
+        "    return x * %d + y / (c + 1) - a %% 7 + (b << 3) - (c >> 2);\n"
+        "}\n\n",
+        i, i % 97 + 1, i % 13 + 1);
+}
+
+static char *generateCorpus(size_t targetBytes, size_t *outLen) {
+    size_t capacity = targetBytes + 4096;
+    char *buf = malloc(capacity);
+    if (!buf) return NULL;
+
+    size_t len = 0;
+    for (int i = 0; len < targetBytes; i++) {
+        len += appendTable(buf + len, capacity - len, i);
+        len += appendFormula(buf + len, capacity - len, i);
+    }
+    *outLen = len;
+    return buf;
+}
+
+typedef ASTContext *(*Generator)(TokenList *tokens);
+
+// Best time in ms over PARSE_REPETITIONS runs, negative if parsing failed
+static double timeParse(Generator generate, TokenList *tokens) {
+    double best = 0;
+    for (int rep = 0; rep < PARSE_REPETITIONS; rep++) {
+        resetErrorCount();
+        double t0 = nowMs();
+        ASTContext *ast = generate(tokens);
+        double elapsed = nowMs() - t0;
+        if (!ast || !ast->root || getErrorCount() > 0) {
+            if (ast) freeASTContext(ast);
+            return -1;
+        }
+        freeASTContext(ast);
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? (size_t)atoi(argv[1]) : 16;
+    if (megabytes == 0) megabytes = 16;
+
+    size_t len;
+    char *corpus = generateCorpus(megabytes << 20, &len);
+    if (!corpus) {
+        fprintf(stderr, "Cannot allocate %zu MB corpus\n", megabytes);
+        return 1;
+    }
+    TokenList *tokens = lex(corpus, "bench");
+    free(corpus);
+    if (!tokens) {
+        fprintf(stderr, "Lexing failed\n");
+        return 1;
+    }
+
+    struct { const char *name; Generator generate; } modes[] = {
+        {"eager", ASTGenerator},
+        {"deferred", ASTGeneratorDeferred},
+    };
+    double mb = len / (1024.0 * 1024.0);
+    printf("%10s %10s %10s %10s %10s %12s\n", "bodies", "MB", "tokens", "best ms", "MB/s",
+           "Mtokens/s");
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        double best = timeParse(modes[i].generate, tokens);
+        if (best < 0) {
+            fprintf(stderr, "Parsing failed\n");
+            freeTokens(tokens);
+            return 1;
+        }
+        printf("%10s %10.1f %10zu %10.2f %10.1f %12.2f\n", modes[i].name, mb, tokens->count,
+               best, mb / (best / 1e3), tokens->count / (best * 1e3));
+    }
+    freeTokens(tokens);
+    return 0;
+}
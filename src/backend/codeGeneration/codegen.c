@@ -1,8 +1,9 @@
 #include "codegen.h"
 #include "emiter.h"
+#include "memTrack.h"
 
 CodeGenContext *createCodeGenContext(void) {
-    CodeGenContext *ctx = calloc(1, sizeof(CodeGenContext));
+    CodeGenContext *ctx = trackedCalloc(MEM_CODEGEN, 1, sizeof(CodeGenContext));
     if (!ctx) return NULL;
     
     ctx->data = sbCreate(4096);
@@ -31,21 +32,21 @@ void freeCodeGenContext(CodeGenContext *ctx) {
     StringEntry *se = ctx->stringPool;
     while (se) {
         StringEntry *next = se->next;
-        free(se);
+        trackedFree(MEM_CODEGEN, se);
         se = next;
     }
     
     VarLoc *vl = ctx->globalVars;
     while (vl) {
         VarLoc *next = vl->next;
-        free(vl);
+        trackedFree(MEM_CODEGEN, vl);
         vl = next;
     }
     
     TempLoc *tl = ctx->globalTemps;
     while (tl) {
         TempLoc *next = tl->next;
-        free(tl);
+        trackedFree(MEM_CODEGEN, tl);
         tl = next;
     }
     
@@ -53,19 +54,19 @@ void freeCodeGenContext(CodeGenContext *ctx) {
         VarLoc *loc = ctx->currentFn->locs;
         while (loc) {
             VarLoc *next = loc->next;
-            free(loc);
+            trackedFree(MEM_CODEGEN, loc);
             loc = next;
         }
         TempLoc *temp = ctx->currentFn->temps;
         while (temp) {
             TempLoc *next = temp->next;
-            free(temp);
+            trackedFree(MEM_CODEGEN, temp);
             temp = next;
         }
-        free(ctx->currentFn);
+        trackedFree(MEM_CODEGEN, ctx->currentFn);
     }
     
-    free(ctx);
+    trackedFree(MEM_CODEGEN, ctx);
 }
 
 void loadOp(CodeGenContext *ctx, IrOperand *op, const char *reg){
@@ -104,13 +105,13 @@ void loadOp(CodeGenContext *ctx, IrOperand *op, const char *reg){
             break;
         case OPERAND_VAR:
         case OPERAND_TEMP: {
-            VarLoc *v = findVar(ctx, op->value.var.name, op->value.var.nameLen);
+            VarLoc *v = op->type == OPERAND_VAR ? findVar(ctx, op->value.var.id) : NULL;
             if (v && v->isAddresable && op->dataType == IR_TYPE_POINTER) {
                 emitInstruction(ctx, "leaq %d(%%rbp), %s", v->stackOffset, getIntReg(reg, IR_TYPE_I64));
                 return;
             }
             int off = op->type == OPERAND_VAR 
-                ? getVarOffset(ctx, op->value.var.name, op->value.var.nameLen) 
+                ? getVarOffset(ctx, op->value.var.id) 
                 : getTempOffset(ctx, op->value.temp.tempNum, op->dataType);
             
             switch(op->dataType){
@@ -137,8 +138,8 @@ void storeOp(CodeGenContext *ctx, const char *reg, IrOperand *op){
     if(op->type != OPERAND_VAR && op->type != OPERAND_TEMP) return;
     int off;
     if (op->type == OPERAND_VAR) {
-        addLocalVar(ctx, op->value.var.name, op->value.var.nameLen, op->dataType);
-        off = getVarOffset(ctx, op->value.var.name, op->value.var.nameLen);
+        addLocalVar(ctx, op->value.var.id, op->dataType);
+        off = getVarOffset(ctx, op->value.var.id);
     } else {
         off = getTempOffset(ctx, op->value.temp.tempNum, op->dataType);
     }
@@ -157,7 +158,7 @@ void genPointerLoad(CodeGenContext *ctx, IrInstruction *inst) {
 
     if (base->type != OPERAND_VAR) return;
 
-    VarLoc *baseVar = findVar(ctx, base->value.var.name, base->value.var.nameLen);
+    VarLoc *baseVar = findVar(ctx, base->value.var.id);
     if (!baseVar) return;
 
     IrDataType elemType = result->dataType;
@@ -201,7 +202,7 @@ void genPointerStore(CodeGenContext *ctx, IrInstruction *inst) {
 
     if (base->type != OPERAND_VAR) return;
 
-    VarLoc *baseVar = findVar(ctx, base->value.var.name, base->value.var.nameLen);
+    VarLoc *baseVar = findVar(ctx, base->value.var.id);
     if (!baseVar) return;
 
     IrDataType elemType = value->dataType;
@@ -383,19 +384,18 @@ void genReqMem(CodeGenContext *ctx, IrInstruction *inst) {
         return;
     }
 
-    addLocalVar(ctx, inst->result.value.var.name, inst->result.value.var.nameLen,
-                inst->result.dataType);
+    addLocalVar(ctx, inst->result.value.var.id, inst->result.dataType);
 
     int arraySize = inst->ar1.value.constant.intVal;
-    markVarAsAddresable(ctx, inst->result.value.var.name, inst->result.value.var.nameLen, arraySize);
+    markVarAsAddresable(ctx, inst->result.value.var.id, arraySize);
 }
 
 void genLoadParam(CodeGenContext *ctx, IrInstruction *inst) {
     IrDataType type = inst->result.dataType;
     int paramIndex = inst->ar2.value.constant.intVal;
     
-    addLocalVar(ctx, inst->result.value.var.name, inst->result.value.var.nameLen, type);
-    int off = getVarOffset(ctx, inst->result.value.var.name, inst->result.value.var.nameLen);
+    addLocalVar(ctx, inst->result.value.var.id, type);
+    int off = getVarOffset(ctx, inst->result.value.var.id);
     
     if (isFloatingPoint(type)) {
         if (paramIndex < 8) {
@@ -417,7 +417,7 @@ void genDeref(CodeGenContext *ctx, IrInstruction *inst) {
     
     // Load the pointer (always 64-bit) into rax
     if (inst->ar1.type == OPERAND_VAR) {
-        int off = getVarOffset(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+        int off = getVarOffset(ctx, inst->ar1.value.var.id);
         emitInstruction(ctx, "movq %d(%%rbp), %%rax", off);
     } else if (inst->ar1.type == OPERAND_TEMP) {
         int off = getTempOffset(ctx, inst->ar1.value.temp.tempNum, IR_TYPE_POINTER);
@@ -439,7 +439,7 @@ void genStore(CodeGenContext *ctx, IrInstruction *inst) {
     
     // Load the pointer (always 64-bit) into rax
     if (inst->ar1.type == OPERAND_VAR) {
-        int off = getVarOffset(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+        int off = getVarOffset(ctx, inst->ar1.value.var.id);
         emitInstruction(ctx, "movq %d(%%rbp), %%rax", off);
     } else if (inst->ar1.type == OPERAND_TEMP) {
         int off = getTempOffset(ctx, inst->ar1.value.temp.tempNum, IR_TYPE_POINTER);
@@ -458,11 +458,11 @@ void genStore(CodeGenContext *ctx, IrInstruction *inst) {
 
 void genAddrof(CodeGenContext *ctx, IrInstruction *inst) {
     if (inst->ar1.type == OPERAND_VAR) {
-        int off = getVarOffset(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+        int off = getVarOffset(ctx, inst->ar1.value.var.id);
         
         if (inst->ar2.type != OPERAND_NONE) {
             // &array[index]: leaq offset(%rbp), %rax; then add index*elemSize
-            VarLoc *var = findVar(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+            VarLoc *var = findVar(ctx, inst->ar1.value.var.id);
             int elemSize = var ? getTypeSize(var->type) : 1;
             loadOp(ctx, &inst->ar2, "c");
             emitInstruction(ctx, "leaq %d(%%rbp), %%rax", off);
@@ -472,9 +472,9 @@ void genAddrof(CodeGenContext *ctx, IrInstruction *inst) {
             emitInstruction(ctx, "addq %%rcx, %%rax");
         } else {
             // &variable
-            VarLoc *var = findVar(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen);
+            VarLoc *var = findVar(ctx, inst->ar1.value.var.id);
             if (!var) {
-                addLocalVar(ctx, inst->ar1.value.var.name, inst->ar1.value.var.nameLen, inst->ar1.dataType);
+                addLocalVar(ctx, inst->ar1.value.var.id, inst->ar1.dataType);
             }
             emitInstruction(ctx, "leaq %d(%%rbp), %%rax", off);
         }
@@ -564,13 +564,12 @@ void genAllocStruct(CodeGenContext *ctx, IrInstruction *inst) {
         return;
     }
     
-    const char *name = inst->result.value.var.name;
-    size_t nameLen = inst->result.value.var.nameLen;
+    NameId name = inst->result.value.var.id;
     int32_t structSize = inst->ar1.value.constant.intVal;
     
-    addLocalVar(ctx, name, nameLen, IR_TYPE_POINTER);
+    addLocalVar(ctx, name, IR_TYPE_POINTER);
     
-    markVarAsAddresable(ctx, name, nameLen, structSize);
+    markVarAsAddresable(ctx, name, structSize);
 }
 
 void genMemberLoad(CodeGenContext *ctx, IrInstruction *inst) {
@@ -584,7 +583,7 @@ void genMemberLoad(CodeGenContext *ctx, IrInstruction *inst) {
     if(structVar->type == OPERAND_TEMP){
         loadOp(ctx, structVar, "a");
     } else if (structVar->type == OPERAND_VAR){
-        VarLoc *v = findVar(ctx, structVar->value.var.name, structVar->value.var.nameLen);
+        VarLoc *v = findVar(ctx, structVar->value.var.id);
         if (!v) return;
 
         if (v->isAddresable) {
@@ -624,7 +623,7 @@ void genMemberStore(CodeGenContext *ctx, IrInstruction *inst){
         loadOp(ctx, structVar, "a");
     } else if (structVar->type == OPERAND_VAR){
         // Find variable to check type
-        VarLoc *v = findVar(ctx, structVar->value.var.name, structVar->value.var.nameLen);
+        VarLoc *v = findVar(ctx, structVar->value.var.id);
         if (!v) return;
 
         if (v->isAddresable) {
@@ -648,8 +647,7 @@ void genStringInit(CodeGenContext *ctx, IrInstruction *inst) {
         return;
     }
 
-    const char *varName = inst->result.value.var.name;
-    size_t varNameLen = inst->result.value.var.nameLen;
+    NameId varName = inst->result.value.var.id;
 
     /* Extract raw string content (strip quotes) */
     const char *raw = inst->ar1.value.constant.str.stringVal;
@@ -670,11 +668,11 @@ void genStringInit(CodeGenContext *ctx, IrInstruction *inst) {
     size_t totalSize = byteCount + 1;  /* +1 for null terminator */
 
     /* Allocate addressable stack space */
-    addLocalVar(ctx, varName, varNameLen, IR_TYPE_I8);
-    markVarAsAddresable(ctx, varName, varNameLen, (int)totalSize);
+    addLocalVar(ctx, varName, IR_TYPE_I8);
+    markVarAsAddresable(ctx, varName, (int)totalSize);
 
     /* Get the base offset of the buffer on stack */
-    VarLoc *v = findVar(ctx, varName, varNameLen);
+    VarLoc *v = findVar(ctx, varName);
     if (!v) return;
     int baseOff = v->stackOffset;
 
@@ -730,10 +728,9 @@ void genCall(CodeGenContext *ctx, IrInstruction *inst) {
         int found = 0;
         for (int i = 0; i < ctx->importCount; i++) {
             ModuleInterface *iface = ctx->imports[i];
-            ExportedFunction *func = iface->functions;
+            ExportedFunction *func = getInterfaceFunctions(iface);
             while (func) {
-                size_t funcNameLen = strlen(func->name);
-                if (funcNameLen == fnLen && memcmp(func->name, fnName, fnLen) == 0) {
+                if (func->nameId == inst->ar1.value.fn.id) {
                     // Found imported function - use mangled name
                     emitInstruction(ctx, "call _Orn_%s__%s", iface->moduleName, func->name);
                     found = 1;
@@ -761,7 +758,7 @@ void genCall(CodeGenContext *ctx, IrInstruction *inst) {
 }
 
 void genFuncBegin(CodeGenContext *ctx, IrInstruction *inst) {
-    FuncInfo *func = calloc(1, sizeof(struct FuncInfo));
+    FuncInfo *func = trackedCalloc(MEM_CODEGEN, 1, sizeof(struct FuncInfo));
     func->name = inst->result.value.fn.name;
     func->nameLen = inst->result.value.fn.nameLen;
     func->stackSize = 0;
@@ -810,7 +807,7 @@ void genFuncEnd(CodeGenContext *ctx, IrInstruction *inst) {
     if (ctx->currentFn) {
         freeVarList(ctx->currentFn->locs);
         freeTempList(ctx->currentFn->temps);
-        free(ctx->currentFn);
+        trackedFree(MEM_CODEGEN, ctx->currentFn);
         ctx->currentFn = NULL;
     }
     ctx->inFn = 0;
@@ -2,6 +2,7 @@
 #include <string.h>
 #include "codegen.h"
 #include "emiter.h"
+#include "memTrack.h"
 
 StringEntry *findStringLit(CodeGenContext *ctx, const char *str, size_t len){
     StringEntry *entry = ctx->stringPool;
@@ -22,7 +23,7 @@ int addStringLit(CodeGenContext *ctx, const char *str, size_t len){
     StringEntry *exists = findStringLit(ctx, str, len);
     if(exists) return exists->labelNum;
 
-    StringEntry *entry = malloc(sizeof(struct StringEntry));
+    StringEntry *entry = trackedMalloc(MEM_CODEGEN, sizeof(struct StringEntry));
     if(!entry) return -1;
 
     entry->str = str;
@@ -66,7 +67,7 @@ int addDoubleLit(CodeGenContext *ctx, double d){
         exists = exists->next;
     }
 
-    DoubleEntry *newEntry = malloc(sizeof(struct DoubleEntry));
+    DoubleEntry *newEntry = trackedMalloc(MEM_CODEGEN, sizeof(struct DoubleEntry));
     newEntry->d = d;
     newEntry->label = ctx->nextLab++;
     newEntry->next = ctx->doublePool;
@@ -86,7 +87,7 @@ int addFloatLit(CodeGenContext *ctx, float f){
         exists = exists->next;
     }
 
-    FloatEntry *newEntry = malloc(sizeof(struct FloatEntry));
+    FloatEntry *newEntry = trackedMalloc(MEM_CODEGEN, sizeof(struct FloatEntry));
     newEntry->f = f;
     newEntry->label = ctx->nextLab++;
     newEntry->next = ctx->floatPool;
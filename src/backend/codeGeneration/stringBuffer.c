@@ -3,11 +3,12 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include "stringBuffer.h"
+#include "memTrack.h"
 
 StringBuffer sbCreate(size_t init){
     StringBuffer sb = {0};
     sb.cap = init > 0 ? init : 1024;
-    sb.data = malloc(sb.cap);
+    sb.data = trackedMalloc(MEM_CODEGEN, sb.cap);
     if(sb.data){
         sb.data[0] = '\0';
         sb.len = 0;
@@ -17,7 +18,7 @@ StringBuffer sbCreate(size_t init){
 
 void sbFree(StringBuffer *sb) {
     if (sb && sb->data) {
-        free(sb->data);
+        trackedFree(MEM_CODEGEN, sb->data);
         sb->data = NULL;
         sb->len = 0;
         sb->cap = 0;
@@ -30,7 +31,7 @@ void sbEnsureCapacity(StringBuffer *sb, size_t needed) {
         while (newCap < sb->len + needed + 1) {
             newCap *= 2;
         }
-        char *newData = realloc(sb->data, newCap);
+        char *newData = trackedRealloc(MEM_CODEGEN, sb->data, newCap);
         if (newData) {
             sb->data = newData;
             sb->cap = newCap;
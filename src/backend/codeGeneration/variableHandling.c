@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "codegen.h"
+#include "memTrack.h"
 
 int isFloatingPoint(IrDataType type){
     return type == IR_TYPE_DOUBLE || type == IR_TYPE_FLOAT;
@@ -123,11 +124,11 @@ const char *getSSESuffix(IrDataType type) {
     return (type == IR_TYPE_FLOAT) ? "ss" : "sd";
 }
 
-void addGlobalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType type) {
-    VarLoc *existing = findVar(ctx, name, len);
+void addGlobalVar(CodeGenContext *ctx, NameId name, IrDataType type) {
+    VarLoc *existing = findVar(ctx, name);
     if (existing) return;
     
-    VarLoc *var = malloc(sizeof(struct VarLoc));
+    VarLoc *var = trackedMalloc(MEM_CODEGEN, sizeof(struct VarLoc));
     if (!var) return;
     
     int size = getTypeSize(type);
@@ -138,7 +139,6 @@ void addGlobalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType
     }
     
     var->name = name;
-    var->nameLen = len;
     var->stackOffset = ctx->globalStackOff;
     var->type = type;
     var->next = ctx->globalVars;
@@ -147,21 +147,21 @@ void addGlobalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType
     ctx->globalVars = var;
 }
 
-void addLocalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType type) {
+void addLocalVar(CodeGenContext *ctx, NameId name, IrDataType type) {
     if (!ctx->currentFn) {
-        addGlobalVar(ctx, name, len, type);
+        addGlobalVar(ctx, name, type);
         return;
     }
     
     VarLoc *loc = ctx->currentFn->locs;
     while (loc) {
-        if (loc->nameLen == len && memcmp(loc->name, name, len) == 0) {
+        if (loc->name == name) {
             return;
         }
         loc = loc->next;
     }
     
-    VarLoc *var = malloc(sizeof(struct VarLoc));
+    VarLoc *var = trackedMalloc(MEM_CODEGEN, sizeof(struct VarLoc));
     if (!var) return;
     
     int size = getTypeSize(type);
@@ -172,7 +172,6 @@ void addLocalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType t
     }
     
     var->name = name;
-    var->nameLen = len;
     var->stackOffset = -ctx->currentFn->stackSize;
     var->type = type;
     var->next = ctx->currentFn->locs;
@@ -181,11 +180,11 @@ void addLocalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType t
     ctx->currentFn->locs = var;
 }
 
-VarLoc *findVar(CodeGenContext *ctx, const char *name, size_t len) {
+VarLoc *findVar(CodeGenContext *ctx, NameId name) {
     if (ctx->currentFn) {
         VarLoc *loc = ctx->currentFn->locs;
         while (loc) {
-            if (loc->nameLen == len && memcmp(loc->name, name, len) == 0) {
+            if (loc->name == name) {
                 return loc;
             }
             loc = loc->next;
@@ -194,7 +193,7 @@ VarLoc *findVar(CodeGenContext *ctx, const char *name, size_t len) {
     
     VarLoc *loc = ctx->globalVars;
     while (loc) {
-        if (loc->nameLen == len && memcmp(loc->name, name, len) == 0) {
+        if (loc->name == name) {
             return loc;
         }
         loc = loc->next;
@@ -203,8 +202,8 @@ VarLoc *findVar(CodeGenContext *ctx, const char *name, size_t len) {
     return NULL;
 }
 
-void markVarAsAddresable(CodeGenContext *ctx, const char *name, size_t len, int arraySize) {
-    VarLoc *var = findVar(ctx, name, len);
+void markVarAsAddresable(CodeGenContext *ctx, NameId name, int arraySize) {
+    VarLoc *var = findVar(ctx, name);
     if (!var) return;
     
     var->isAddresable = 1;
@@ -226,8 +225,8 @@ void markVarAsAddresable(CodeGenContext *ctx, const char *name, size_t len, int
 
 
 //just a wrap
-int getVarOffset(CodeGenContext *ctx, const char *name, size_t len) {
-    VarLoc *var = findVar(ctx, name, len);
+int getVarOffset(CodeGenContext *ctx, NameId name) {
+    VarLoc *var = findVar(ctx, name);
     if (var) return var->stackOffset;
     return 0;
 }
@@ -259,7 +258,7 @@ void addTemp(CodeGenContext *ctx, int tempNum, IrDataType type) {
     TempLoc *exist = findTemp(ctx, tempNum);
     if (exist) return;
     
-    TempLoc *temp = malloc(sizeof(struct TempLoc));
+    TempLoc *temp = trackedMalloc(MEM_CODEGEN, sizeof(struct TempLoc));
     if (!temp) return;
     
     int size = getTypeSize(type);
@@ -305,7 +304,7 @@ int getTempOffset(CodeGenContext *ctx, int tempNum, IrDataType type) {
 void freeVarList(VarLoc *list) {
     while (list) {
         VarLoc *next = list->next;
-        free(list);
+        trackedFree(MEM_CODEGEN, list);
         list = next;
     }
 }
@@ -313,7 +312,7 @@ void freeVarList(VarLoc *list) {
 void freeTempList(TempLoc *list) {
     while (list) {
         TempLoc *next = list->next;
-        free(list);
+        trackedFree(MEM_CODEGEN, list);
         list = next;
     }
 }
\ No newline at end of file
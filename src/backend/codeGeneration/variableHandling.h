@@ -6,8 +6,7 @@
 typedef struct CodeGenContext CodeGenContext;
 
 typedef struct VarLoc {
-    const char *name;
-    size_t nameLen;
+    NameId name;
     int stackOffset;
     IrDataType type;
     struct VarLoc *next;
@@ -25,10 +24,10 @@ typedef struct TempLoc {
 int getTempOffset(CodeGenContext *ctx, int tempNum, IrDataType type);
 void addTemp(CodeGenContext *ctx, int tempNum, IrDataType type);
 TempLoc *findTemp(CodeGenContext *ctx, int tempNum);
-int getVarOffset(CodeGenContext *ctx, const char *name, size_t len);
-VarLoc *findVar(CodeGenContext *ctx, const char *name, size_t len);
-void addLocalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType type);
-void addGlobalVar(CodeGenContext *ctx, const char *name, size_t len, IrDataType type);
+int getVarOffset(CodeGenContext *ctx, NameId name);
+VarLoc *findVar(CodeGenContext *ctx, NameId name);
+void addLocalVar(CodeGenContext *ctx, NameId name, IrDataType type);
+void addGlobalVar(CodeGenContext *ctx, NameId name, IrDataType type);
 const char *getIntReg(const char *base, IrDataType type) ;
 const char *getSSESuffix(IrDataType type);
 const char *getSSEReg(int num);
@@ -38,6 +37,6 @@ int isFloatingPoint(IrDataType type);
 void freeVarList(VarLoc *list);
 void freeTempList(TempLoc *list);
 const char *getParamIntReg(int index, IrDataType type);
-void markVarAsAddresable(CodeGenContext *ctx, const char *name, size_t len, int arraySize);
+void markVarAsAddresable(CodeGenContext *ctx, NameId name, int arraySize);
 
 #endif // VARIABLE_HANDLING_H
\ No newline at end of file
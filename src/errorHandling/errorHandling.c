@@ -22,6 +22,13 @@ static int fatalCount = 0;
 
 static int silentMode = 0; // If set, suppresses error output (used for testing)
 
+/** @internal Buffer the calling thread reports into, NULL prints straight away */
+static _Thread_local DiagnosticBuffer *capture = NULL;
+
+static FILE *diagnosticStream(void) {
+	return capture ? capture->stream : stdout;
+}
+
 void repError(ErrorCode code, const char *extraContext) {
 	reportError(code, NULL, extraContext);
 }
@@ -39,18 +46,25 @@ void printSourceSnippet (ErrorContext * context) {
 	if (!context || !context->source) return;
 	const char *RED_COLOR = RED;
 	const char *RESET_COLOR = RESET;
-	printf("%s%4zu |%s %s\n", GRAY, context->line, RESET_COLOR, context->source);
-	printf("%s     |%s ", GRAY, RESET_COLOR);
+	FILE *out = diagnosticStream();
+	fprintf(out, "%s%4zu |%s %.*s\n", GRAY, context->line, RESET_COLOR, (int)context->sourceLength,
+	       context->source);
+	fprintf(out, "%s     |%s ", GRAY, RESET_COLOR);
 	for (size_t i = 0; i < context->startColumn - 1; i++) {
-		printf(" ");
+		fprintf(out, " ");
 	}
 
 	// Print carets for error length
-	printf("%s", RED_COLOR);
+	fprintf(out, "%s", RED_COLOR);
 	for (size_t i = 0; i < (context->length > 0 ? context->length : 1); i++) {
-		printf("^");
+		fprintf(out, "^");
 	}
-	printf("%s\n", RESET_COLOR);
+	fprintf(out, "%s\n", RESET_COLOR);
+}
+
+static void exitFatal(ErrorCode code) {
+    printf("%serror:%s could not compile due to fatal error\n", RED, RESET);
+    exit(code);
 }
 
 void reportError(ErrorCode code, ErrorContext *context, const char *extraContext) {
@@ -62,17 +76,24 @@ void reportError(ErrorCode code, ErrorContext *context, const char *extraContext
     // Determine colors and text based on error level
     switch (info->level) {
         case WARNING:
-            warningCount++;
+            if (capture) capture->warnings++;
+            else warningCount++;
             levelColor = YELLOW;
             levelText = "warning";
             break;
         case ERROR:
-            errorCount++;
+            if (capture) capture->errors++;
+            else errorCount++;
             levelColor = RED;
             levelText = "error";
             break;
         case FATAL:
-            fatalCount++;
+            // Other threads may still be checking, the buffer's owner ends the process
+            if (capture) {
+                if (capture->fatal == ERROR_OK) capture->fatal = code;
+            } else {
+                fatalCount++;
+            }
             levelColor = RED ;
             levelText = "error";
             break;
@@ -82,49 +103,46 @@ void reportError(ErrorCode code, ErrorContext *context, const char *extraContext
         return;
     }
 
+    FILE *out = diagnosticStream();
     const char *RESET_COLOR = RESET ;
     const char *BLUE_COLOR = BLUE;
 
     // Print main error line example: error[E1002]: mismatched types
-    printf("%s%s %s[E%04d]:%s %s%s",
+    fprintf(out, "%s%s %s[E%04d]:%s %s%s",
            levelColor, levelText, RED,
            code,
            RESET_COLOR,
            YELLOW, info->message);
 
     if (extraContext) {
-        printf(" (%s)", extraContext);
+        fprintf(out, " (%s)", extraContext);
     }
-    printf("\n");
+    fprintf(out, "\n");
     if (context && context->file) {
-        printf("%s  --> %s:%zu:%zu%s\n",
+        fprintf(out, "%s  --> %s:%zu:%zu%s\n",
                YELLOW, context->file, context->line, context->column, RESET_COLOR);
-        printf("%s   |%s\n", GRAY, RESET_COLOR);
+        fprintf(out, "%s   |%s\n", GRAY, RESET_COLOR);
         printSourceSnippet(context);
-        printf("%s   |%s\n", GRAY, RESET_COLOR);
+        fprintf(out, "%s   |%s\n", GRAY, RESET_COLOR);
     }
 
     if (info->help) {
-        printf("%s   = help:%s %s\n", BLUE_COLOR, GRAY, info->help);
+        fprintf(out, "%s   = help:%s %s\n", BLUE_COLOR, GRAY, info->help);
     }
 
     if (info->note) {
-        printf("%s   = note:%s %s\n", BLUE_COLOR, GRAY, info->note);
+        fprintf(out, "%s   = note:%s %s\n", BLUE_COLOR, GRAY, info->note);
     }
 
     if (info->suggestion) {
-        printf("%s   = suggestion:%s %s\n", BLUE_COLOR, GRAY, info->suggestion);
+        fprintf(out, "%s   = suggestion:%s %s\n", BLUE_COLOR, GRAY, info->suggestion);
     }
 
-    printf("\n");
+    fprintf(out, "\n");
 
-    if (info->level == FATAL) {
-        printf("%serror:%s could not compile due to fatal error\n",
-               levelColor, RESET_COLOR);
-        exit(code);
-    }
+    if (info->level == FATAL && !capture) exitFatal(code);
 
-    printf("%s", RESET_COLOR);
+    fprintf(out, "%s", RESET_COLOR);
 }
 
 void printErrorSummary(void) {
@@ -178,3 +196,62 @@ int getErrorCount(void) { return errorCount; }
 int getWarningCount(void) { return warningCount; }
 int getFatalCount(void) { return fatalCount; }
 void setSilentMode(int silent) { silentMode = silent; }
+
+int beginDiagnostics(DiagnosticBuffer *buffer) {
+	buffer->text = NULL;
+	buffer->length = 0;
+	buffer->printed = 0;
+	buffer->errors = 0;
+	buffer->warnings = 0;
+	buffer->fatal = ERROR_OK;
+	buffer->stream = open_memstream(&buffer->text, &buffer->length);
+	if (!buffer->stream) return 0;
+	buffer->outer = capture;
+	capture = buffer;
+	return 1;
+}
+
+void endDiagnostics(void) {
+	if (!capture) return;
+	fclose(capture->stream);
+	capture->stream = NULL;
+	capture = capture->outer;
+}
+
+/* How much the calling thread's buffer holds, 0 when it prints straight away */
+size_t markDiagnostics(void) {
+	if (!capture) return 0;
+	fflush(capture->stream);
+	return capture->length;
+}
+
+/* Prints what the buffer holds up to a mark taken while it was capturing */
+void printDiagnostics(DiagnosticBuffer *buffer, size_t mark) {
+	if (!buffer->text || mark <= buffer->printed) return;
+	fwrite(buffer->text + buffer->printed, 1, mark - buffer->printed, diagnosticStream());
+	buffer->printed = mark;
+}
+
+void flushDiagnostics(DiagnosticBuffer *buffer) {
+	printDiagnostics(buffer, buffer->length);
+	free(buffer->text);
+	buffer->text = NULL;
+	buffer->length = 0;
+	buffer->printed = 0;
+	if (capture) {
+		capture->errors += buffer->errors;
+		capture->warnings += buffer->warnings;
+		if (capture->fatal == ERROR_OK) capture->fatal = buffer->fatal;
+	} else {
+		errorCount += buffer->errors;
+		warningCount += buffer->warnings;
+	}
+	buffer->errors = 0;
+	buffer->warnings = 0;
+	ErrorCode fatal = buffer->fatal;
+	buffer->fatal = ERROR_OK;
+	if (fatal != ERROR_OK && !capture) {
+		fatalCount++;
+		exitFatal(fatal);
+	}
+}
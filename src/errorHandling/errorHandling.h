@@ -20,6 +20,7 @@
 #define WHITE   "\033[37m"
 #define GRAY    "\033[90m"
 #include <stddef.h>
+#include <stdio.h>
 
 // this is only for /semantic
 #define REPORT_ERROR(code, node, ctx, msg) \
@@ -73,6 +74,7 @@ typedef enum {
 	ERROR_SYMBOL_NOT_VARIABLE = 2007,
 	ERROR_UNDEFINED_TYPE = 2010,
 	ERROR_UNDEFINED_STRUCT = 2011,
+	ERROR_EXPORTED_CONST_NOT_CONSTANT = 2012,
 
 	// 3000s: Syntax errors
 	ERROR_INVALID_FLOAT_MULTIPLE_DECIMALS = 3001,
@@ -193,7 +195,8 @@ typedef struct ErrorContext {
 	const char* file;
 	size_t line;
 	size_t column;
-	char* source;
+	const char* source;     // the offending line, not NUL terminated
+	size_t sourceLength;
 	size_t length;
 	size_t startColumn;
 } ErrorContext;
@@ -207,6 +210,32 @@ typedef struct {
 	const char* suggestion;
 } ErrorInfo;
 
+/**
+ * @brief Diagnostics held back by one thread until they can be printed in order.
+ *
+ * Between beginDiagnostics() and endDiagnostics() the calling thread's
+ * reports are written to the buffer and counted there instead of the global
+ * counters. flushDiagnostics() later prints them and adds the counts.
+ *
+ * A fatal error is held back too. The reporting thread returns instead of
+ * exiting, and flushDiagnostics() ends the process once the error is printed.
+ * Buffers flushed in order therefore print everything that came before it.
+ *
+ * markDiagnostics() tells how far the buffer has got, and printDiagnostics()
+ * prints it up to such a mark, so several buffers can be printed interleaved.
+ * A buffer begun while another is capturing prints and counts into that one.
+ */
+typedef struct DiagnosticBuffer {
+	FILE *stream;       // open while capturing
+	char *text;
+	size_t length;
+	size_t printed;     // text already printed by printDiagnostics()
+	int errors;
+	int warnings;
+	ErrorCode fatal;    // first fatal error reported, ERROR_OK if none
+	struct DiagnosticBuffer *outer;  // capturing when this one began
+} DiagnosticBuffer;
+
 extern const ErrorInfo errorDatabase[];
 extern const size_t errorDatabaseCount;
 
@@ -222,5 +251,10 @@ int getFatalCount(void);
 void resetErrorCount(void);
 void repError(ErrorCode code, const char *extraContext);
 void setSilentMode(int silent);
+int beginDiagnostics(DiagnosticBuffer *buffer);
+void endDiagnostics(void);
+size_t markDiagnostics(void);
+void printDiagnostics(DiagnosticBuffer *buffer, size_t mark);
+void flushDiagnostics(DiagnosticBuffer *buffer);
 
 #endif
\ No newline at end of file
@@ -586,7 +586,7 @@ const ErrorInfo errorDatabase[] = {
         ERROR_EXPECTED_FN_AFTER_EXPORT,
         ERROR,
         "expected 'fn' after 'export'",
-        "only functions can be exported",
+        "only functions, structs and constants can be exported",
         "invalid export target",
         "write as `export fn name() -> type { ... }`"
     },
@@ -752,6 +752,14 @@ const ErrorInfo errorDatabase[] = {
         "unknown struct name",
         "define the struct before using it or check for typos"
     },
+    {
+        ERROR_EXPORTED_CONST_NOT_CONSTANT,
+        ERROR,
+        "exported const is not a compile-time constant",
+        "importers use the value of an exported const, so it must be known while compiling",
+        "value only known at run time",
+        "initialize it from literals, other consts and calls to functions that only compute a result"
+    },
     {
         ERROR_INVALID_LOOP_CONDITION,
         ERROR,
@@ -1,168 +1,343 @@
 #include "lexer.h"
-#include <ctype.h>
+#include "memTrack.h"
+#include "sourceManager.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define INITIAL_CAPACITY 256
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-char *extractSourceLineForToken(TokenList *list, Token *token) {
-	if (!list || !list->buffer || !token || !token->start) return NULL;
+#define MIN_CAPACITY 64
+#define BYTES_PER_TOKEN 4   // dense code runs about 5, so most files never regrow
 
-	// Find start of line
-	const char *line_start = token->start;
-	while (line_start > list->buffer && *(line_start - 1) != '\n') {
-		line_start--;
-	}
+_Static_assert(TK_COUNT <= TOKEN_NAMED, "token types must leave the name bit free");
 
-	// Find end of line
-	const char *line_end = token->start;
-	while (*line_end != '\0' && *line_end != '\n') {
-		line_end++;
-	}
+// The chunked scanners may load 16 bytes starting at the terminator
+_Static_assert(SOURCE_PADDING >= 16, "source padding too small for 16-byte loads");
 
-	// Create line string
-	size_t line_length = line_end - line_start;
-	char *line = malloc(line_length + 1);
-	if (line) {
-		strncpy(line, line_start, line_length);
-		line[line_length] = '\0';
-	}
-	return line;
+SourceLocation tokenLocation(TokenList *list, const Token *token) {
+	if (!list || !token) return (SourceLocation){0, 0};
+	return sourceLocation(list->source, token->offset);
+}
+
+const char *tokenSourceLine(TokenList *list, const Token *token, uint32_t *length) {
+	*length = 0;
+	if (!list || !token) return NULL;
+	return sourceLineAt(list->source, token->offset, length);
+}
+
+/**
+ * Byte classes driving the main loop, indexed by unsigned char. Bytes >= 0x80
+ * are class 0 and lex as TK_INVALID, like any other unknown character.
+ */
+#define CC_SPACE   0x01    // ' ', '\t', '\r'
+#define CC_NEWLINE 0x02
+#define CC_DIGIT   0x04
+#define CC_ALPHA   0x08    // letters and '_'
+#define CC_IDENT   (CC_ALPHA | CC_DIGIT)
+
+#define S_ CC_SPACE
+#define N_ CC_NEWLINE
+#define D_ CC_DIGIT
+#define A_ CC_ALPHA
+static const uint8_t charClass[256] = {
+	/* 00 */ 0,  0,  0,  0,  0,  0,  0,  0,  0,  S_, N_, 0,  0,  S_, 0,  0,
+	/* 10 */ 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	/* 20 */ S_, 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	/* 30 */ D_, D_, D_, D_, D_, D_, D_, D_, D_, D_, 0,  0,  0,  0,  0,  0,
+	/* 40 */ 0,  A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_,
+	/* 50 */ A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, 0,  0,  0,  0,  A_,
+	/* 60 */ 0,  A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_,
+	/* 70 */ A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, A_, 0,  0,  0,  0,  0,
+};
+#undef S_
+#undef N_
+#undef D_
+#undef A_
+
+static inline int hasClass(char c, uint8_t cls) {
+	return charClass[(unsigned char)c] & cls;
+}
+
+/**
+ * Keywords: minimal perfect hash over (first two bytes, last byte, length),
+ * one slot per keyword, so a lookup is two multiplies and one memcmp.
+ * Rerun tools/genKeywordHash.py after adding or removing a keyword.
+ */
+#define KEYWORD_MAX_LEN 6
+
+typedef struct Keyword {
+	const char *text;
+	uint8_t length;
+	uint8_t type;
+} Keyword;
+
+/* generated by tools/genKeywordHash.py, do not edit */
+#define KEYWORD_BUCKET_BITS 3
+#define KEYWORD_SLOT_BITS 5
+
+static const uint16_t keywordDisplacement[1 << KEYWORD_BUCKET_BITS] = {
+	356, 59, 12, 16, 2, 95, 0, 2910
+};
+
+static const Keyword keywords[1 << KEYWORD_SLOT_BITS] = {
+	{"str", 3, TK_STR_WRAP},
+	{"u16", 3, TK_U16},
+	{"for", 3, TK_FOR},
+	{"export", 6, TK_EXPORT},
+	{"return", 6, TK_RETURN},
+	{"struct", 6, TK_STRUCT},
+	{"bool", 4, TK_BOOL},
+	{"as", 2, TK_AS},
+	{"float", 5, TK_FLOAT},
+	{"from", 4, TK_FROM},
+	{"u64", 3, TK_U64},
+	{"if", 2, TK_IF},
+	{"i64", 3, TK_I64},
+	{"i8", 2, TK_I8},
+	{"fn", 2, TK_FN},
+	{"let", 3, TK_LET},
+	{"u8", 2, TK_U8},
+	{"import", 6, TK_IMPORT},
+	{"u32", 3, TK_U32},
+	{"false", 5, TK_FALSE},
+	{"rostr", 5, TK_STRING},
+	{"double", 6, TK_DOUBLE},
+	{"i32", 3, TK_I32},
+	{"null", 4, TK_NULL},
+	{"int", 3, TK_I32},
+	{"void", 4, TK_VOID},
+	{"const", 5, TK_CONST},
+	{"true", 4, TK_TRUE},
+	{"else", 4, TK_ELSE},
+	{"i16", 3, TK_I16},
+	{"while", 5, TK_WHILE},
+	{"char", 4, TK_I8},
+};
+/* end of generated keyword hash */
+
+static inline uint32_t keywordKey(const char *s, size_t len) {
+	return (uint32_t)(unsigned char)s[0] | (uint32_t)(unsigned char)s[1] << 8 |
+	       (uint32_t)(unsigned char)s[len - 1] << 16 | (uint32_t)len << 24;
 }
 
 static TokenType lookUpKeyword(const char * s, size_t len) {
-	if (len < 2) return TK_LIT;
+	if (len < 2 || len > KEYWORD_MAX_LEN) return TK_LIT;
 
-	switch (s[0]) {
-		case 'a':
-			if(len == 2 && memcmp(s, "as", 2) == 0) return TK_AS;
-			break;
-		case 'b':
-			if (len == 4 && memcmp(s, "bool", 4) == 0) return TK_BOOL;
-			break;
-		case 'c':
-			if(len == 5 && memcmp(s, "const", 5) == 0) return TK_CONST;
-			if(len == 4 && memcmp(s, "char", 4) == 0) return TK_I8; /* for now */
-			break;
-		case 'd': 
-			if (len == 6 && memcmp(s, "double", 6) == 0) return TK_DOUBLE;
-			break;
-		case 'e':
-			if(len == 4 && memcmp(s, "else", 4) == 0) return TK_ELSE;
-			if(len == 6 && memcmp(s, "export", 6) == 0) return TK_EXPORT;
-			break;
-		case 'f':
-			if (len == 2 && s[1] == 'n') return TK_FN;
-			if(len == 3 && memcmp(s, "for", 3) == 0) return TK_FOR;
-			if(len == 4 && memcmp(s, "from", 4) == 0) return TK_FROM;
-			if (len == 5) {
-				if (memcmp(s, "float", 5) == 0) return TK_FLOAT;
-				if (memcmp(s, "false", 5) == 0) return TK_FALSE;
-			}
-			break;
-		case 'i':
-			if (len == 3 && memcmp(s, "int", 3) == 0) return TK_I32;
-			if(len == 2 && memcmp(s, "i8", 2) == 0) return TK_I8;
-			if(len == 3 && memcmp(s, "i16", 3) == 0) return TK_I16;
-			if(len == 3 && memcmp(s, "i32", 3) == 0) return TK_I32;
-			if(len == 3 && memcmp(s, "i64", 3) == 0) return TK_I64;
-			if (len == 2 && memcmp(s, "if", 2) == 0) return TK_IF;
-			if(len == 6 && memcmp(s, "import", 6) == 0) return TK_IMPORT;
-			break;
-		case 'l':
-			if(len == 3 && memcmp(s, "let", 3) == 0) return TK_LET;
-			break;
-		case 'r':
-			if (len == 6 && memcmp(s, "return", 6) == 0) return TK_RETURN;
-			if (len == 5 && memcmp(s, "rostr", 5) == 0) return TK_STRING;
-			break;
-		case 's':
-			if(len == 3 && memcmp(s, "str", 3) == 0) return TK_STR_WRAP;
-			if (len == 6 && memcmp(s, "struct", 6) == 0) return TK_STRUCT;
-			break;
-		case 't':
-			if (len == 4 && memcmp(s, "true", 4) == 0) return TK_TRUE;
-			break;
-		case 'u':
-			if(len == 2 && memcmp(s, "u8", 2) == 0) return TK_U8;
-			if(len == 3 && memcmp(s, "u16", 3) == 0) return TK_U16;
-			if(len == 3 && memcmp(s, "u32", 3) == 0) return TK_U32;
-			if(len == 3 && memcmp(s, "u64", 3) == 0) return TK_U64;
-			break;
-		case 'v':
-			if (len == 4 && memcmp(s, "void", 4) == 0) return TK_VOID;
-			break;
-		case 'w':
-			if (len == 5 && memcmp(s, "while", 5) == 0) return TK_WHILE;
-			break;
-        case 'n':
-            if (len == 4 && memcmp(s, "null", 4) == 0) return TK_NULL;
-            break;
-        }
+	uint32_t key = keywordKey(s, len);
+	uint32_t bucket = (key * 0x9E3779B1u) >> (32 - KEYWORD_BUCKET_BITS);
+	uint32_t slot = ((key ^ keywordDisplacement[bucket]) * 0x85EBCA6Bu) >> (32 - KEYWORD_SLOT_BITS);
+	const Keyword *kw = &keywords[slot];
+	if (kw->length == len && memcmp(kw->text, s, len) == 0) return (TokenType)kw->type;
 	return TK_LIT;
 }
 
+/**
+ * Operators: each first byte lists the bytes that extend it to a
+ * two-character operator. A zero `single` marks a byte that starts no
+ * operator (0 is TK_STRUCT, a keyword).
+ */
+typedef struct OperatorEntry {
+	uint8_t single;
+	char next[4];
+	uint8_t pair[3];
+} OperatorEntry;
+
+static const OperatorEntry operators[256] = {
+	['+'] = {TK_PLUS, "=+", {TK_PLUS_ASSIGN, TK_INCR}},
+	['-'] = {TK_MINUS, "=->", {TK_MINUS_ASSIGN, TK_DECR, TK_ARROW}},
+	['*'] = {TK_STAR, "=", {TK_STAR_ASSIGN}},
+	['/'] = {TK_SLASH, "=", {TK_SLASH_ASSIGN}},
+	['='] = {TK_ASSIGN, "=", {TK_EQ}},
+	['!'] = {TK_NOT, "=", {TK_NOT_EQ}},
+	['<'] = {TK_LESS, "<=", {TK_LSHIFT, TK_LESS_EQ}},
+	['>'] = {TK_GREATER, ">=", {TK_RSHIFT, TK_GREATER_EQ}},
+	['&'] = {TK_AMPERSAND, "&=", {TK_AND, TK_AND_ASSIGN}},
+	['|'] = {TK_BIT_OR, "|=", {TK_OR, TK_OR_ASSIGN}},
+	['^'] = {TK_BIT_XOR, "=", {TK_XOR_ASSIGN}},
+	['~'] = {TK_BIT_NOT, "", {0}},
+	['%'] = {TK_MOD, "", {0}},
+	[';'] = {TK_SEMI, "", {0}},
+	['{'] = {TK_LBRACE, "", {0}},
+	['}'] = {TK_RBRACE, "", {0}},
+	['('] = {TK_LPAREN, "", {0}},
+	[')'] = {TK_RPAREN, "", {0}},
+	[','] = {TK_COMMA, "", {0}},
+	['?'] = {TK_QUESTION, "", {0}},
+	[':'] = {TK_COLON, "", {0}},
+	['.'] = {TK_DOT, "", {0}},
+	['['] = {TK_LBRACKET, "", {0}},
+	[']'] = {TK_RBRACKET, "", {0}},
+};
+
+/* Three-character operators: a two-character one followed by '=' */
+static const uint8_t tripleOperators[][2] = {
+	{TK_LSHIFT, TK_LSHIFT_ASSIGN},
+	{TK_RSHIFT, TK_RSHIFT_ASSIGN},
+};
+
+/* Resizes every token array to capacity, the list is left unchanged on failure */
+static int resizeTokens(TokenList *list, size_t capacity) {
+	uint8_t *types = trackedRealloc(MEM_LEXER, list->types, capacity);
+	if (types) list->types = types;
+	uint32_t *offsets = trackedRealloc(MEM_LEXER, list->offsets, capacity * sizeof(uint32_t));
+	if (offsets) list->offsets = offsets;
+	uint32_t *values = trackedRealloc(MEM_LEXER, list->values, capacity * sizeof(uint32_t));
+	if (values) list->values = values;
+	if (!types || !offsets || !values) return 0;
+	list->capacity = capacity;
+	return 1;
+}
+
 static void addToken(Lexer *lx, TokenType type, const char * start, size_t len) {
-	if (lx->list->count >= lx->list->capacity) {
-		lx->list->capacity *= 2;
-		lx->list->tokens = realloc(lx->list->tokens, lx->list->capacity * sizeof(Token));
+	TokenList *list = lx->list;
+	if (list->count >= list->capacity &&
+	    (lx->outOfMemory || !resizeTokens(list, list->capacity * 2))) {
+		lx->outOfMemory = 1;
+		return;
+	}
+	size_t i = list->count++;
+	list->types[i] = (uint8_t)type;
+	list->offsets[i] = (uint32_t)(start - lx->src);
+	list->values[i] = (uint32_t)len;
+}
+
+/**
+ * Scanners for the long runs: blanks, comments, identifiers and string
+ * bodies. Each returns the first byte that ends the run and always stops at
+ * the NUL terminator, so with SOURCE_PADDING behind it a 16-byte load starting
+ * anywhere up to the terminator stays inside the allocation.
+ */
+#ifdef __SSE2__
+
+static inline unsigned bytesEqual(__m128i chunk, char c) {
+	return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)));
+}
+
+static inline __m128i loadChunk(const char *p) {
+	return _mm_loadu_si128((const __m128i *)p);
+}
+
+static const char *skipBlanks(const char *p) {
+	for (;; p += 16) {
+		__m128i chunk = loadChunk(p);
+		unsigned blank = bytesEqual(chunk, '\n') | bytesEqual(chunk, ' ') |
+		                 bytesEqual(chunk, '\t') | bytesEqual(chunk, '\r');
+		unsigned stop = ~blank & 0xFFFFu;
+		if (stop) return p + __builtin_ctz(stop);
+	}
+}
+
+static const char *findLineEnd(const char *p) {
+	for (;; p += 16) {
+		__m128i chunk = loadChunk(p);
+		unsigned stop = bytesEqual(chunk, '\n') | bytesEqual(chunk, '\0');
+		if (stop) return p + __builtin_ctz(stop);
+	}
+}
+
+/* Next '*' or the terminator inside a block comment */
+static const char *findCommentStar(const char *p) {
+	for (;; p += 16) {
+		__m128i chunk = loadChunk(p);
+		unsigned stop = bytesEqual(chunk, '*') | bytesEqual(chunk, '\0');
+		if (stop) return p + __builtin_ctz(stop);
+	}
+}
+
+static const char *findStringStop(const char *p) {
+	for (;; p += 16) {
+		__m128i chunk = loadChunk(p);
+		unsigned stop = bytesEqual(chunk, '"') | bytesEqual(chunk, '\\') |
+		                bytesEqual(chunk, '\0');
+		if (stop) return p + __builtin_ctz(stop);
+	}
+}
+
+static const char *scanIdent(const char *p) {
+	const __m128i before = _mm_set1_epi8('a' - 1), after = _mm_set1_epi8('z' + 1);
+	const __m128i zero = _mm_set1_epi8('0' - 1), nine = _mm_set1_epi8('9' + 1);
+	for (;; p += 16) {
+		__m128i chunk = loadChunk(p);
+		// Folding in 0x20 lowercases letters; bytes >= 0x80 are negative and never match
+		__m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+		__m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, before), _mm_cmplt_epi8(lower, after));
+		__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, zero), _mm_cmplt_epi8(chunk, nine));
+		unsigned ident = (unsigned)_mm_movemask_epi8(_mm_or_si128(alpha, digit)) |
+		                 bytesEqual(chunk, '_');
+		unsigned stop = ~ident & 0xFFFFu;
+		if (stop) return p + __builtin_ctz(stop);
 	}
-	Token *token = &lx->list->tokens[lx->list->count++];
-	token->type = type;
-	token->start = start;
-	token->length = len;
-	token->line = lx->line;
-	token->column = (start - lx->src) - lx->line_start + 1;
 }
 
+#else
+
+static const char *skipBlanks(const char *p) {
+	while (hasClass(*p, CC_SPACE | CC_NEWLINE)) p++;
+	return p;
+}
+
+static const char *findLineEnd(const char *p) {
+	while (*p && *p != '\n') p++;
+	return p;
+}
+
+static const char *findCommentStar(const char *p) {
+	while (*p && *p != '*') p++;
+	return p;
+}
+
+static const char *findStringStop(const char *p) {
+	while (*p && *p != '"' && *p != '\\') p++;
+	return p;
+}
+
+static const char *scanIdent(const char *p) {
+	while (hasClass(*p, CC_IDENT)) p++;
+	return p;
+}
+
+#endif
+
 static void skipWhitespace(Lexer *lx) {
-	while (*lx->cur) {
-		if (*lx->cur == ' ' || *lx->cur == '\t' || *lx->cur == '\r') {
-			lx->cur++;
-		} else if (*lx->cur == '\n') {
-			lx->cur++;
-			lx->line++;
-			lx->line_start = lx->cur - lx->src;
-		} else if (lx->cur[0] == '/' && lx->cur[1] == '/') {
-			// Single-line comment
-			lx->cur += 2;
-			while (*lx->cur && *lx->cur != '\n') lx->cur++;
-		} else if (lx->cur[0] == '/' && lx->cur[1] == '*') {
-			// Multi-line comment
-			lx->cur += 2;
-			while (*lx->cur) {
-				if (lx->cur[0] == '*' && lx->cur[1] == '/') {
-					lx->cur += 2;
+	const char *p = lx->cur;
+	for (;;) {
+		p = skipBlanks(p);
+		if (p[0] == '/' && p[1] == '/') {
+			p = findLineEnd(p + 2);
+		} else if (p[0] == '/' && p[1] == '*') {
+			// An unterminated comment runs to the end of the file
+			for (p = findCommentStar(p + 2); *p; p = findCommentStar(p + 1)) {
+				if (p[1] == '/') {
+					p += 2;
 					break;
 				}
-				if (*lx->cur == '\n') {
-					lx->line++;
-					lx->line_start = lx->cur - lx->src + 1;
-				}
-				lx->cur++;
 			}
 		} else {
 			break;
 		}
 	}
+	lx->cur = p;
 }
 
 static void lexString(Lexer *lx) {
-	const char *start = lx->cur++;
-	while (*lx->cur && *lx->cur != '"') {
-		if (*lx->cur == '\\' && lx->cur[1]) lx->cur += 2;
-		else lx->cur++;
+	const char *start = lx->cur;
+	const char *p = findStringStop(start + 1);
+	while (*p == '\\') {
+		p = findStringStop(p[1] ? p + 2 : p + 1);
 	}
-	if (*lx->cur == '"') lx->cur++;
+	if (*p == '"') p++;
+	lx->cur = p;
 	addToken(lx, TK_STR, start, lx->cur - start);
 }
 
 static void lexNumber(Lexer *lx) {
 	const char *start = lx->cur;
-	while (isdigit(*lx->cur)) lx->cur++;
-	if (*lx->cur == '.' && isdigit(lx->cur[1])) {
+	while (hasClass(*lx->cur, CC_DIGIT)) lx->cur++;
+	if (*lx->cur == '.' && hasClass(lx->cur[1], CC_DIGIT)) {
 		lx->cur++;
-		while (isdigit(*lx->cur)) lx->cur++;
+		while (hasClass(*lx->cur, CC_DIGIT)) lx->cur++;
 		if (*lx->cur == 'f' || *lx->cur == 'F') {
             lx->cur++;
         }
@@ -172,112 +347,62 @@ static void lexNumber(Lexer *lx) {
 
 static void lexIdent(Lexer *lx) {
 	const char *start = lx->cur;
-	while (isalnum(*lx->cur) || *lx->cur == '_') lx->cur++;
+	lx->cur = scanIdent(lx->cur);
 	size_t len = lx->cur - start;
 	TokenType type = lookUpKeyword(start, len);
-	addToken(lx, type, start, lx->cur - start);
+	addToken(lx, type, start, len);
+	if (lx->outOfMemory) return;
+	// Keywords are interned too, some of them double as names (fn double() ...)
+	NameId name = internName(start, len);
+	if (name == NAME_NONE) return;
+	size_t i = lx->list->count - 1;
+	lx->list->types[i] |= TOKEN_NAMED;
+	lx->list->values[i] = name;
 }
 
 static void lexOperator(Lexer *lx) {
-    const char *start = lx->cur;
-    char c = *lx->cur++;
-    char next = *lx->cur;
-
-    // Two-character operators
-    switch (c) {
-        case '+':
-            if (next == '=') { lx->cur++; addToken(lx, TK_PLUS_ASSIGN, start, 2); return; }
-            if (next == '+') { lx->cur++; addToken(lx, TK_INCR, start, 2); return; }
-            addToken(lx, TK_PLUS, start, 1); return;
-        case '-':
-            if (next == '=') { lx->cur++; addToken(lx, TK_MINUS_ASSIGN, start, 2); return; }
-            if (next == '-') { lx->cur++; addToken(lx, TK_DECR, start, 2); return; }
-            if (next == '>') { lx->cur++; addToken(lx, TK_ARROW, start, 2); return; }
-            addToken(lx, TK_MINUS, start, 1); return;
-        case '*':
-            if (next == '=') { lx->cur++; addToken(lx, TK_STAR_ASSIGN, start, 2); return; }
-            addToken(lx, TK_STAR, start, 1); return;
-        case '/':
-            if (next == '=') { lx->cur++; addToken(lx, TK_SLASH_ASSIGN, start, 2); return; }
-            addToken(lx, TK_SLASH, start, 1); return;
-        case '=':
-            if (next == '=') { lx->cur++; addToken(lx, TK_EQ, start, 2); return; }
-            addToken(lx, TK_ASSIGN, start, 1); return;
-        case '!':
-            if (next == '=') { lx->cur++; addToken(lx, TK_NOT_EQ, start, 2); return; }
-            addToken(lx, TK_NOT, start, 1); return;
-        case '<':
-			if (next == '<') {
-				lx->cur++;
-				if(*lx->cur == '=') {lx->cur++; addToken(lx, TK_LSHIFT_ASSIGN, start, 3); return; }
-				addToken(lx, TK_LSHIFT, start, 2); return;
-			}
-            if (next == '=') { lx->cur++; addToken(lx, TK_LESS_EQ, start, 2); return; }
-            addToken(lx, TK_LESS, start, 1); return;
-        case '>':
-			if(next == '>'){
-				lx->cur++;
-				if(*lx->cur == '=') { lx->cur++; addToken(lx, TK_RSHIFT_ASSIGN, start, 3); return; }
-				addToken(lx, TK_RSHIFT, start, 2); return;
+	const char *start = lx->cur;
+	const OperatorEntry *op = &operators[(unsigned char)*lx->cur++];
+	if (!op->single) {
+		addToken(lx, TK_INVALID, start, 1);
+		return;
+	}
+
+	for (int i = 0; op->next[i]; i++) {
+		if (*lx->cur != op->next[i]) continue;
+		TokenType type = (TokenType)op->pair[i];
+		lx->cur++;
+		if (*lx->cur == '=') {
+			for (size_t t = 0; t < sizeof(tripleOperators) / sizeof(tripleOperators[0]); t++) {
+				if (tripleOperators[t][0] == type) {
+					lx->cur++;
+					addToken(lx, (TokenType)tripleOperators[t][1], start, 3);
+					return;
+				}
 			}
-            if (next == '=') { lx->cur++; addToken(lx, TK_GREATER_EQ, start, 2); return; }
-            addToken(lx, TK_GREATER, start, 1); return;
-        case '&':
-            if (next == '&') { lx->cur++; addToken(lx, TK_AND, start, 2); return; }
-			if(next == '=') { lx->cur++; addToken(lx, TK_AND_ASSIGN, start, 2); return; }
-            addToken(lx, TK_AMPERSAND, start, 1); return;
-        case '|':
-            if (next == '|') { lx->cur++; addToken(lx, TK_OR, start, 2); return; }
-			if( next == '=') { lx->cur++; addToken(lx, TK_OR_ASSIGN, start, 2); return;}
-            addToken(lx, TK_BIT_OR, start, 1); return;
-		case '^':
-			if (next == '=') { lx->cur++; addToken(lx, TK_XOR_ASSIGN, start, 2); return; }
-            addToken(lx, TK_BIT_XOR, start, 1); return;
-		case '~':
-            addToken(lx, TK_BIT_NOT, start, 1); return;
-        case '%':
-            addToken(lx, TK_MOD, start, 1); return;
-        case ';':
-            addToken(lx, TK_SEMI, start, 1); return;
-        case '{':
-            addToken(lx, TK_LBRACE, start, 1); return;
-        case '}':
-            addToken(lx, TK_RBRACE, start, 1); return;
-        case '(':
-            addToken(lx, TK_LPAREN, start, 1); return;
-        case ')':
-            addToken(lx, TK_RPAREN, start, 1); return;
-        case ',':
-            addToken(lx, TK_COMMA, start, 1); return;
-        case '?':
-            addToken(lx, TK_QUESTION, start, 1); return;
-        case ':':
-            addToken(lx, TK_COLON, start, 1); return;
-		case '.':
-			addToken(lx, TK_DOT, start, 1); return;
-        case '[':
-            addToken(lx, TK_LBRACKET, start, 1); return;
-        case ']':
-            addToken(lx, TK_RBRACKET, start, 1); return;
-        default:
-            addToken(lx, TK_INVALID, start, 1); return;
-    }
+		}
+		addToken(lx, type, start, 2);
+		return;
+	}
+	addToken(lx, (TokenType)op->single, start, 1);
 }
 
-TokenList* lex(const char *input, const char * filename) {
-	TokenList *list = malloc(sizeof(TokenList));
-	list->capacity = INITIAL_CAPACITY;
-	list->count = 0;
-	list->tokens = malloc(list->capacity * sizeof(Token));
-	list->buffer = strdup(input);  // Keep a copy for token references
-	list->filename = strdup(filename);
+TokenList *lexSource(SourceFile *source) {
+	if (!source) return NULL;
+	TokenList *list = trackedCalloc(MEM_LEXER, 1, sizeof(TokenList));
+	if (!list || !resizeTokens(list, source->length / BYTES_PER_TOKEN + MIN_CAPACITY)) {
+		freeTokens(list);
+		releaseSource(source);
+		return NULL;
+	}
+	// Tokens index straight into the source, its zero tail ends the text
+	list->source = source;
+	list->buffer = source->data;
+	list->filename = trackedStrdup(MEM_LEXER, source->path);
 
 	Lexer lx = {
 		.src = list->buffer,
 		.cur = list->buffer,
-		.line = 1,
-		.col = 1,
-		.line_start = 0,
 		.list = list
 	};
 
@@ -285,25 +410,48 @@ TokenList* lex(const char *input, const char * filename) {
 		skipWhitespace(&lx);
 		if (!*lx.cur) break;
 
-		if (*lx.cur == '"') {
-			lexString(&lx);
-		} else if (isdigit(*lx.cur) || (*lx.cur == '.' && isdigit(lx.cur[1]))) {
-			lexNumber(&lx);
-		} else if (isalpha(*lx.cur) || *lx.cur == '_') {
+		uint8_t cls = charClass[(unsigned char)*lx.cur];
+		if (cls & CC_ALPHA) {
 			lexIdent(&lx);
+		} else if ((cls & CC_DIGIT) || (*lx.cur == '.' && hasClass(lx.cur[1], CC_DIGIT))) {
+			lexNumber(&lx);
+		} else if (*lx.cur == '"') {
+			lexString(&lx);
 		} else {
 			lexOperator(&lx);
 		}
 	}
 
 	addToken(&lx, TK_EOF, lx.cur, 0);
+	if (lx.outOfMemory) {
+		freeTokens(list);
+		return NULL;
+	}
+	// Comment-heavy files overshoot the estimate, give the excess back
+	if (list->count < list->capacity / 2) resizeTokens(list, list->count);
 	return list;
 }
 
+TokenList* lex(const char *input, const char * filename) {
+	return lexSource(sourceFromString(input, strlen(input), filename));
+}
+
+void freeTokenArray(TokenList *list) {
+	if (!list) return;
+	trackedFree(MEM_LEXER, list->types);
+	trackedFree(MEM_LEXER, list->offsets);
+	trackedFree(MEM_LEXER, list->values);
+	list->types = NULL;
+	list->offsets = NULL;
+	list->values = NULL;
+	list->count = 0;
+	list->capacity = 0;
+}
+
 void freeTokens(TokenList *list) {
 	if (!list) return;
-	free(list->tokens);
-	free(list->buffer);
-	free(list->filename);
-	free(list);
+	freeTokenArray(list);
+	releaseSource(list->source);
+	trackedFree(MEM_LEXER, list->filename);
+	trackedFree(MEM_LEXER, list);
 }
\ No newline at end of file
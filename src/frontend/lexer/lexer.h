@@ -4,6 +4,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "interner.h"
+#include "sourceManager.h"
+
 /**
  * @brief Enumeration of all possible token types in the language.
  *
@@ -113,37 +116,72 @@ typedef enum {
 	// Special tokens
 	TK_NULL,
 	TK_EOF,
-	TK_INVALID
+	TK_INVALID,
+
+	TK_COUNT    // number of token types, sizes TokenType-indexed tables
 } TokenType;
 
+// One token unpacked from the list, for code that needs more than its type.
+// Line and column are looked up from offset only when a diagnostic needs them
 typedef struct Token {
     TokenType type;
-    const char *start;
-	uint16_t length;
-    uint16_t line;
-    uint16_t column;
+    NameId name;            // interned text of identifiers and keywords, NAME_NONE otherwise
+    uint32_t offset;        // byte offset into the list's buffer
+    uint32_t length;
 } Token;
 
+// Set in types[] on identifiers and keywords, whose values[] entry is their NameId
+#define TOKEN_NAMED 0x80
+
+// Token fields in parallel arrays, so lookahead on types stays in a few cache lines.
+// A named token's length is its name's, so one array holds either, 9 bytes a token
 typedef struct TokenList {
-	Token *tokens;
+	uint8_t *types;         // TokenType, plus TOKEN_NAMED
+	uint32_t *offsets;
+	uint32_t *values;       // NameId of a named token, the length of any other
 	size_t count;
 	size_t capacity;
-	char * buffer;
+	const char *buffer;     // source->data, token offsets index into it
 	char *filename;
+	SourceFile *source;     // owned, released by freeTokens()
 }TokenList;
 
 typedef struct {
 	const char *src;
 	const char *cur;
-	size_t line;
-	size_t col;
-	size_t line_start;
 	TokenList *list;
+	int outOfMemory;        // a token array could not grow, lexSource() returns NULL
 } Lexer;
 
+static inline TokenType tokenType(const TokenList *list, size_t i) {
+	return (TokenType)(list->types[i] & ~TOKEN_NAMED);
+}
+
+static inline Token tokenAt(const TokenList *list, size_t i) {
+	uint8_t type = list->types[i];
+	uint32_t value = list->values[i];
+	if (type & TOKEN_NAMED) {
+		Token token = {(TokenType)(type & ~TOKEN_NAMED), value, list->offsets[i], nameLength(value)};
+		return token;
+	}
+	Token token = {(TokenType)type, NAME_NONE, list->offsets[i], value};
+	return token;
+}
+
+static inline const char *tokenStart(const TokenList *list, const Token *token) {
+	return list->buffer + token->offset;
+}
+
+// Lexes a padded source in place; the source always passes to lexSource, which releases it on failure too
+TokenList *lexSource(SourceFile *source);
+// Copies input into a padded buffer first, for text that is not a mapped file
 TokenList* lex(const char *input, const char *filename);
 void freeTokens(TokenList *list);
+// Drops the token arrays but keeps buffer, which names in later stages still point into
+void freeTokenArray(TokenList *list);
 const char* tokenName(TokenType type);
-char *extractSourceLineForToken(TokenList *list, Token *token);
+SourceLocation tokenLocation(TokenList *list, const Token *token);
+// Slice of the line holding token, not NUL terminated
+const char *tokenSourceLine(TokenList *list, const Token *token, uint32_t *length);
 
 #endif //LEXER_H
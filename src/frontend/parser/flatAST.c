@@ -0,0 +1,358 @@
+/**
+ * @file flatAST.c
+ * @brief Conversion from the pointer AST to the structure-of-arrays form.
+ *
+ * Both passes walk the tree with an explicit stack, so neither long
+ * statement chains nor deeply nested expressions recurse on the C stack.
+ *
+ * The cache file is a header followed by the starts, lengths, firstChild
+ * and nextSibling arrays and then the kinds, in native byte order: it is
+ * only ever read back by the compiler that wrote it. The header holds a
+ * hash of everything after it, so a damaged file is dropped rather than
+ * read as a smaller tree that still links up.
+ */
+
+#include "flatAST.h"
+#include "arena.h"
+#include "cache.h"
+#include "memTrack.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FLAT_AST_MAGIC 0x414e524fu     // "ORNA"
+#define FLAT_AST_VERSION 3             // 2: integer literals are stored unresolved, 3: payload hash
+#define FLAT_AST_NAMED 0x80            // set on a stored kind when the node has a name
+
+_Static_assert(NODE_TYPE_COUNT <= FLAT_AST_NAMED, "node kinds must leave the name bit free");
+
+typedef struct FlatASTHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t sourceLength;
+    uint32_t count;
+    uint64_t payloadHash;   // hashBytes() of the arrays that follow
+} FlatASTHeader;
+
+typedef struct FlattenFrame {
+    ASTNode next;           // next sibling still to number
+    FlatNode prev;          // last numbered sibling, FLAT_NONE before the first
+    FlatNode parent;
+} FlattenFrame;
+
+static int growStack(void **stack, size_t *capacity, size_t elemSize) {
+    size_t newCap = *capacity ? *capacity * 2 : 64;
+    void *grown = trackedRealloc(MEM_PARSER, *stack, newCap * elemSize);
+    if (!grown) return 0;
+    *stack = grown;
+    *capacity = newCap;
+    return 1;
+}
+
+static int countNodes(ASTNode root, uint32_t *out) {
+    ASTNode *stack = NULL;
+    size_t top = 0, capacity = 0;
+    uint32_t count = 0;
+
+    if (!growStack((void **)&stack, &capacity, sizeof(ASTNode))) return 0;
+    stack[top++] = root;
+    while (top > 0) {
+        ASTNode node = stack[--top];
+        count++;
+        if (top + 2 > capacity && !growStack((void **)&stack, &capacity, sizeof(ASTNode))) {
+            trackedFree(MEM_PARSER, stack);
+            return 0;
+        }
+        if (node != root && node->brothers) stack[top++] = node->brothers;
+        if (node->children) stack[top++] = node->children;
+    }
+    trackedFree(MEM_PARSER, stack);
+    *out = count;
+    return 1;
+}
+
+static FlatNode addFlatNode(FlatAST *ast, ASTNode node) {
+    FlatNode id = ast->count++;
+    ast->kinds[id] = (uint8_t)node->nodeType;
+    ast->starts[id] = node->start ? (uint32_t)(node->start - ast->buffer) : 0;
+    ast->lengths[id] = node->start ? node->length : 0;
+    ast->names[id] = node->name;
+    ast->firstChild[id] = FLAT_NONE;
+    ast->nextSibling[id] = FLAT_NONE;
+    return id;
+}
+
+FlatAST *flattenAST(const ASTContext *ctx) {
+    if (!ctx || !ctx->root) return NULL;
+
+    uint32_t nodeCount;
+    if (!countNodes(ctx->root, &nodeCount)) return NULL;
+    size_t slots = (size_t)nodeCount + 1;
+
+    FlatAST *ast = trackedCalloc(MEM_PARSER, 1, sizeof(FlatAST));
+    if (!ast) return NULL;
+    ast->buffer = ctx->buffer;
+    ast->source = ctx->source;
+    ast->kinds = trackedMalloc(MEM_PARSER, slots * sizeof(uint8_t));
+    ast->starts = trackedMalloc(MEM_PARSER, slots * sizeof(uint32_t));
+    ast->lengths = trackedMalloc(MEM_PARSER, slots * sizeof(uint32_t));
+    ast->names = trackedMalloc(MEM_PARSER, slots * sizeof(NameId));
+    ast->firstChild = trackedMalloc(MEM_PARSER, slots * sizeof(FlatNode));
+    ast->nextSibling = trackedMalloc(MEM_PARSER, slots * sizeof(FlatNode));
+    if (!ast->kinds || !ast->starts || !ast->lengths || !ast->names || !ast->firstChild ||
+        !ast->nextSibling) {
+        freeFlatAST(ast);
+        return NULL;
+    }
+
+    // Id 0 is the null node, its links point back at itself
+    ast->kinds[0] = 0;
+    ast->starts[0] = 0;
+    ast->lengths[0] = 0;
+    ast->names[0] = NAME_NONE;
+    ast->firstChild[0] = ast->nextSibling[0] = FLAT_NONE;
+    ast->count = 1;
+
+    FlattenFrame *stack = NULL;
+    size_t top = 0, capacity = 0;
+    FlatNode root = addFlatNode(ast, ctx->root);
+    if (ctx->root->children) {
+        if (!growStack((void **)&stack, &capacity, sizeof(FlattenFrame))) {
+            freeFlatAST(ast);
+            return NULL;
+        }
+        stack[top++] = (FlattenFrame){ctx->root->children, FLAT_NONE, root};
+    }
+
+    // Preorder: a node is numbered before its children, children before later siblings
+    while (top > 0) {
+        FlattenFrame *frame = &stack[top - 1];
+        ASTNode node = frame->next;
+        if (!node) {
+            top--;
+            continue;
+        }
+        frame->next = node->brothers;
+
+        FlatNode id = addFlatNode(ast, node);
+        if (frame->prev) {
+            ast->nextSibling[frame->prev] = id;
+        } else {
+            ast->firstChild[frame->parent] = id;
+        }
+        frame->prev = id;
+
+        if (node->children) {
+            if (top == capacity &&
+                !growStack((void **)&stack, &capacity, sizeof(FlattenFrame))) {
+                trackedFree(MEM_PARSER, stack);
+                freeFlatAST(ast);
+                return NULL;
+            }
+            stack[top++] = (FlattenFrame){node->children, FLAT_NONE, id};
+        }
+    }
+    trackedFree(MEM_PARSER, stack);
+    return ast;
+}
+
+void freeFlatAST(FlatAST *ast) {
+    if (!ast) return;
+    trackedFree(MEM_PARSER, ast->kinds);
+    trackedFree(MEM_PARSER, ast->starts);
+    trackedFree(MEM_PARSER, ast->lengths);
+    trackedFree(MEM_PARSER, ast->names);
+    trackedFree(MEM_PARSER, ast->firstChild);
+    trackedFree(MEM_PARSER, ast->nextSibling);
+    trackedFree(MEM_PARSER, ast);
+}
+
+static void printFlatTree(const FlatAST *ast, FlatNode n, const char *prefix, int isLast) {
+    printf("%s%s%s", prefix, isLast ? "┗ " : "┣ ", getNodeTypeName(flatKind(ast, n)));
+    if (flatLength(ast, n) > 0) {
+        printf(": %.*s", (int)flatLength(ast, n), flatStart(ast, n));
+    }
+    printf("\n");
+
+    char newPrefix[256];
+    snprintf(newPrefix, sizeof(newPrefix), "%s%s", prefix, isLast ? "    " : "┃   ");
+
+    for (FlatNode child = flatFirstChild(ast, n); child; child = flatNextSibling(ast, child)) {
+        printFlatTree(ast, child, newPrefix, flatNextSibling(ast, child) == FLAT_NONE);
+    }
+}
+
+void printFlatAST(const FlatAST *ast) {
+    if (!ast || ast->count <= FLAT_ROOT || flatKind(ast, FLAT_ROOT) != PROGRAM) {
+        printf("Empty or invalid AST.\n");
+        return;
+    }
+    printf("AST:\n");
+    for (FlatNode child = flatFirstChild(ast, FLAT_ROOT); child;
+         child = flatNextSibling(ast, child)) {
+        printFlatTree(ast, child, "", flatNextSibling(ast, child) == FLAT_NONE);
+    }
+}
+
+int saveFlatAST(const FlatAST *ast, uint64_t sourceHash, const char *path) {
+    if (!ast || !ast->source || ast->count <= FLAT_ROOT) return 0;
+
+    uint8_t *kinds = trackedMalloc(MEM_PARSER, ast->count);
+    if (!kinds) return 0;
+    for (uint32_t n = 0; n < ast->count; n++) {
+        if (ast->kinds[n] == DEFERRED_BODY) {
+            trackedFree(MEM_PARSER, kinds);
+            return 0;
+        }
+        kinds[n] = ast->kinds[n] | (ast->names[n] != NAME_NONE ? FLAT_AST_NAMED : 0);
+    }
+
+    // Written beside the entry and renamed over it, a reader never maps half a file.
+    // open() rather than mkstemp() so the umask applies like any other cache file.
+    char tmpPath[PATH_MAX];
+    int fd = -1;
+    if (snprintf(tmpPath, sizeof(tmpPath), "%s.%ld.tmp", path, (long)getpid()) < (int)sizeof(tmpPath)) {
+        fd = open(tmpPath, O_WRONLY | O_CREAT | O_EXCL, 0666);
+        if (fd < 0 && errno == EEXIST) {
+            // Left behind by a dead process that had our pid
+            remove(tmpPath);
+            fd = open(tmpPath, O_WRONLY | O_CREAT | O_EXCL, 0666);
+        }
+    }
+    FILE *f = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!f) {
+        if (fd >= 0) {
+            close(fd);
+            remove(tmpPath);
+        }
+        trackedFree(MEM_PARSER, kinds);
+        return 0;
+    }
+
+    size_t n = ast->count;
+    uint64_t payloadHash = hashBytes(ast->starts, n * sizeof(uint32_t), HASH_SEED);
+    payloadHash = hashBytes(ast->lengths, n * sizeof(uint32_t), payloadHash);
+    payloadHash = hashBytes(ast->firstChild, n * sizeof(FlatNode), payloadHash);
+    payloadHash = hashBytes(ast->nextSibling, n * sizeof(FlatNode), payloadHash);
+    payloadHash = hashBytes(kinds, n, payloadHash);
+    FlatASTHeader header = {
+        .magic = FLAT_AST_MAGIC,
+        .version = FLAT_AST_VERSION,
+        .sourceHash = sourceHash,
+        .sourceLength = (uint32_t)ast->source->length,
+        .count = ast->count,
+        .payloadHash = payloadHash
+    };
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(ast->starts, sizeof(uint32_t), n, f) == n &&
+             fwrite(ast->lengths, sizeof(uint32_t), n, f) == n &&
+             fwrite(ast->firstChild, sizeof(FlatNode), n, f) == n &&
+             fwrite(ast->nextSibling, sizeof(FlatNode), n, f) == n &&
+             fwrite(kinds, 1, n, f) == n;
+    ok = fclose(f) == 0 && ok;
+    trackedFree(MEM_PARSER, kinds);
+    ok = ok && rename(tmpPath, path) == 0;
+    if (!ok) remove(tmpPath);
+    return ok;
+}
+
+static ASTContext *rebuildTree(const FlatASTHeader *header, SourceFile *source) {
+    uint32_t count = header->count;
+    const uint32_t *starts = (const uint32_t *)(header + 1);
+    const uint32_t *lengths = starts + count;
+    const FlatNode *firstChild = lengths + count;
+    const FlatNode *nextSibling = firstChild + count;
+    const uint8_t *kinds = (const uint8_t *)(nextSibling + count);
+
+    ASTContext *ctx = trackedMalloc(MEM_PARSER, sizeof(ASTContext));
+    if (!ctx) return NULL;
+    size_t bytes = (size_t)count * sizeof(struct ASTNode);
+    // One chunk holds the whole tree, node n sits at nodes[n]
+    ctx->arena = createArena(MEM_PARSER, bytes);
+    if (!ctx->arena) {
+        trackedFree(MEM_PARSER, ctx);
+        return NULL;
+    }
+    ASTNode nodes = arenaAlloc(ctx->arena, bytes);
+    if (!nodes) {
+        freeASTContext(ctx);
+        return NULL;
+    }
+
+    for (FlatNode n = FLAT_ROOT; n < count; n++) {
+        NodeTypes kind = (NodeTypes)(kinds[n] & ~FLAT_AST_NAMED);
+        // Links only point forward in preorder, which also rules out cycles
+        int valid = kind < NODE_TYPE_COUNT && kind != DEFERRED_BODY &&
+                    (!firstChild[n] || (firstChild[n] > n && firstChild[n] < count)) &&
+                    (!nextSibling[n] || (nextSibling[n] > n && nextSibling[n] < count)) &&
+                    (uint64_t)starts[n] + lengths[n] <= source->length &&
+                    (lengths[n] || !(kinds[n] & FLAT_AST_NAMED));
+        if (!valid) {
+            freeASTContext(ctx);
+            return NULL;
+        }
+
+        ASTNode node = &nodes[n];
+        node->start = lengths[n] ? source->data + starts[n] : NULL;
+        node->length = lengths[n];
+        node->nodeType = kind;
+        node->info = 0;
+        node->name = NAME_NONE;
+        if (kinds[n] & FLAT_AST_NAMED) {
+            node->name = internName(node->start, node->length);
+            if (node->name == NAME_NONE) {
+                freeASTContext(ctx);
+                return NULL;
+            }
+        }
+        node->children = firstChild[n] ? &nodes[firstChild[n]] : NULL;
+        node->brothers = nextSibling[n] ? &nodes[nextSibling[n]] : NULL;
+    }
+    if (nodes[FLAT_ROOT].nodeType != PROGRAM || nodes[FLAT_ROOT].brothers) {
+        freeASTContext(ctx);
+        return NULL;
+    }
+
+    ctx->buffer = source->data;
+    ctx->filename = source->path;
+    ctx->source = source;
+    ctx->tokens = NULL;
+    ctx->root = &nodes[FLAT_ROOT];
+    return ctx;
+}
+
+ASTContext *loadFlatAST(const char *path, uint64_t sourceHash, SourceFile *source) {
+    if (!source) return NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FlatASTHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const FlatASTHeader *header = map;
+    size_t perNode = 4 * sizeof(uint32_t) + 1;
+    ASTContext *ctx = NULL;
+    if (header->magic == FLAT_AST_MAGIC && header->version == FLAT_AST_VERSION &&
+        header->sourceHash == sourceHash && header->sourceLength == source->length &&
+        header->count > FLAT_ROOT &&
+        size == sizeof(FlatASTHeader) + (size_t)header->count * perNode &&
+        hashBytes(header + 1, size - sizeof(FlatASTHeader), HASH_SEED) == header->payloadHash) {
+        ctx = rebuildTree(header, source);
+    }
+    munmap(map, size);
+    return ctx;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file flatAST.h
+ * @brief Structure-of-arrays form of the AST, addressed by 32-bit node ids.
+ *
+ * Each node field lives in its own contiguous array and children are linked
+ * through firstChild/nextSibling ids instead of pointers, 21 bytes per node
+ * against 40 for struct ASTNode. Nodes are numbered in preorder, so a
+ * walk over the tree touches the arrays front to back.
+ *
+ * Id 0 is reserved as "no node", the PROGRAM root is always FLAT_ROOT.
+ * Passes should go through the accessors below so the layout can change.
+ *
+ * The same arrays are what the build cache stores for a module's parsed
+ * tree, see saveFlatAST() and loadFlatAST().
+ */
+
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <stdint.h>
+
+#include "parser.h"
+
+typedef uint32_t FlatNode;
+
+#define FLAT_NONE ((FlatNode)0)
+#define FLAT_ROOT ((FlatNode)1)
+
+typedef struct FlatAST {
+    uint8_t *kinds;         // NodeTypes
+    uint32_t *starts;       // byte offset into buffer
+    uint32_t *lengths;
+    NameId *names;          // interned identifier, NAME_NONE for other nodes
+    FlatNode *firstChild;
+    FlatNode *nextSibling;
+    uint32_t count;         // including the reserved id 0
+    const char *buffer;
+    SourceFile *source;     // line table for flatLocation(), owned by the token list
+} FlatAST;
+
+/**
+ * @brief Flatten a parsed tree, NULL on allocation failure or empty tree
+ */
+FlatAST *flattenAST(const ASTContext *ctx);
+
+void freeFlatAST(FlatAST *ast);
+
+/**
+ * @brief Same output as printAST() on the tree it was flattened from
+ */
+void printFlatAST(const FlatAST *ast);
+
+/**
+ * @brief Store the tree for a later build, keyed by the hash of its source.
+ *
+ * Names are process-local ids, the file only records which nodes have one.
+ * Trees still holding a DEFERRED_BODY are refused. The file is written
+ * under a temporary name and renamed into place. Returns 1 on success.
+ */
+int saveFlatAST(const FlatAST *ast, uint64_t sourceHash, const char *path);
+
+/**
+ * @brief Rebuild the pointer tree saved for this source, NULL on any mismatch.
+ *
+ * The file is mapped and checked against sourceHash, the source length and
+ * the hash of its arrays, then every node is allocated in one block of a fresh arena with names
+ * interned again from the text. The context has no token list and source
+ * stays owned by the caller.
+ */
+ASTContext *loadFlatAST(const char *path, uint64_t sourceHash, SourceFile *source);
+
+static inline NodeTypes flatKind(const FlatAST *ast, FlatNode n) {
+    return (NodeTypes)ast->kinds[n];
+}
+
+static inline FlatNode flatFirstChild(const FlatAST *ast, FlatNode n) {
+    return ast->firstChild[n];
+}
+
+static inline FlatNode flatNextSibling(const FlatAST *ast, FlatNode n) {
+    return ast->nextSibling[n];
+}
+
+/** @brief Source text of the node's token, NULL for nodes without one */
+static inline const char *flatStart(const FlatAST *ast, FlatNode n) {
+    return ast->lengths[n] ? ast->buffer + ast->starts[n] : NULL;
+}
+
+static inline uint32_t flatLength(const FlatAST *ast, FlatNode n) {
+    return ast->lengths[n];
+}
+
+static inline NameId flatName(const FlatAST *ast, FlatNode n) {
+    return ast->names[n];
+}
+
+/** @brief Line and column of the node's token, {0, 0} for nodes without one */
+static inline SourceLocation flatLocation(const FlatAST *ast, FlatNode n) {
+    if (!ast->lengths[n]) return (SourceLocation){0, 0};
+    return sourceLocation(ast->source, ast->starts[n]);
+}
+
+#endif // FLAT_AST_H
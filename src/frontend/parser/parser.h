@@ -137,6 +137,7 @@ typedef enum {
     ARGUMENT_LIST,
     RETURN_STATEMENT,
     RETURN_TYPE,
+    DEFERRED_BODY,      // function body spanning '{' to '}', parsed by functionBody()
 
     // Structs
     STRUCT_LIT,
@@ -145,14 +146,16 @@ typedef enum {
     STRUCT_FIELD,
     STRUCT_FIELD_LIT,
     MEMBER_ACCESS,
+    NODE_TYPE_COUNT
 } NodeTypes;
 
+// Line and column come from start through the source's line table when needed
 typedef struct ASTNode {
-    uint16_t length;
-    uint16_t line;
-    uint16_t column;
     const char* start;
+    uint32_t length;
     NodeTypes nodeType;
+    NameId name;                // interned start/length for identifier tokens
+    uint32_t info;              // type checker annotation slot, 0 until checked
     struct ASTNode* children;
     struct ASTNode* brothers;
 } *ASTNode;
@@ -160,18 +163,35 @@ typedef struct ASTNode {
 typedef struct ASTContext {
     const char* buffer;
     const char* filename;
+    SourceFile* source;     // owned by the token list
+    TokenList* tokens;      // parsed from, deferred bodies need it until they are expanded
     ASTNode root;
+    struct Arena* arena;    // owns every node of the tree
 } ASTContext;
 
 // public api
 
 ASTContext* ASTGenerator(TokenList* tokenList);
 
+/**
+ * @brief Like ASTGenerator, but function bodies are only brace-matched.
+ *
+ * Each body is left as a DEFERRED_BODY node and parsed by functionBody() the
+ * first time it is needed, so the token list must outlive those calls.
+ */
+ASTContext* ASTGeneratorDeferred(TokenList* tokenList);
+
+/**
+ * @brief Body of a function definition, parsed now if it was deferred.
+ *
+ * The deferred node is overwritten with the parsed block. NULL if the body
+ * has a syntax error.
+ */
+ASTNode functionBody(ASTContext* ctx, ASTNode function);
+
 void printAST(ASTNode node, int depth);
 void printASTTree(ASTNode node, char* prefix, int isLast);
 
-void freeAST(ASTNode node);
-
 void freeASTContext(ASTContext* context);
 
 const char* getNodeTypeName(NodeTypes nodeType);
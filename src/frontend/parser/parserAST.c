@@ -13,6 +13,7 @@
  */
 
 #include "parserInternal.h"
+#include "memTrack.h"
 
 #include <ctype.h>
 #include <stdlib.h>
@@ -84,6 +85,7 @@ static const NodeTypeMap nodeTypeMapping[] = {
     {ARGUMENT_LIST,          "ARGUMENT_LIST"},
     {RETURN_STATEMENT,       "RETURN_STATEMENT"},
     {RETURN_TYPE,            "RETURN_TYPE"},
+    {DEFERRED_BODY,          "DEFERRED_BODY"},
     {STRUCT_DEFINITION,      "STRUCT_DEFINITION"},
     {STRUCT_FIELD_LIST,      "STRUCT_FIELD_LIST"},
     {STRUCT_FIELD,           "STRUCT_FIELD"},
@@ -136,7 +138,7 @@ const char* getNodeTypeName(NodeTypes nodeType){
 
 char *extractText(const char *start, size_t length){
     if (!start || length == 0) return NULL;
-    char *str = malloc(length + 1);
+    char *str = trackedMalloc(MEM_PARSER, length + 1);
     if (!str) return NULL;
     memcpy(str, start, length);
     str[length] = '\0';
@@ -161,10 +163,10 @@ static int containsFChar(const char *val, size_t i, int hasDot, size_t len) {
  * @brief Classifies a token as a specific literal type (int, float, string, bool, variable, etc.)
  */
 NodeTypes detectLitType(const Token *tok, TokenList *list, size_t *pos) {
-    if (!tok || !tok->start || tok->length == 0) return null_NODE;
+    if (!tok || tok->length == 0) return null_NODE;
 
     size_t len       = tok->length;
-    const char *val  = tok->start;
+    const char *val  = tokenStart(list, tok);
 
     /* String literal */
     if (len >= 2 && val[0] == '"' && val[len - 1] == '"')
@@ -209,7 +211,7 @@ NodeTypes detectLitType(const Token *tok, TokenList *list, size_t *pos) {
             if (!isalnum((unsigned char)val[i]) && val[i] != '_') {
                 reportError(ERROR_INVALID_EXPRESSION,
                             createErrorContextFromParser(list, pos),
-                            extractText(tok->start, tok->length));
+                            extractText(val, len));
                 return null_NODE;
             }
         }
@@ -218,7 +220,7 @@ NodeTypes detectLitType(const Token *tok, TokenList *list, size_t *pos) {
 
     reportError(ERROR_INVALID_EXPRESSION,
                 createErrorContextFromParser(list, pos),
-                extractText(tok->start, tok->length));
+                extractText(val, len));
     return null_NODE;
 }
 
@@ -226,27 +228,32 @@ NodeTypes detectLitType(const Token *tok, TokenList *list, size_t *pos) {
  * Node construction
  */
 
+static _Thread_local Arena *nodeArena = NULL;
+
+void setNodeArena(Arena *arena) {
+    nodeArena = arena;
+}
+
 ASTNode createNode(const Token *token, NodeTypes type, TokenList *list, size_t *pos) {
-    ASTNode node = malloc(sizeof(struct ASTNode));
+    ASTNode node = nodeArena ? arenaAlloc(nodeArena, sizeof(struct ASTNode)) : NULL;
     if (!node) {
         reportError(ERROR_MEMORY_ALLOCATION_FAILED, createErrorContextFromParser(list, pos),
-                    token ? extractText(token->start, token->length) : "");
+                    token && list ? extractText(tokenStart(list, token), token->length) : "");
         return NULL;
     }
 
-    if (token) {
-        node->start = token->start;
+    if (token && list) {
+        node->start = tokenStart(list, token);
         node->length = token->length;
-        node->line = token->line;
-        node->column = token->column;
+        node->name = token->name;
     } else {
         node->start = NULL;
         node->length = 0;
-        node->line = 0;
-        node->column = 0;
+        node->name = NAME_NONE;
     }
 
     node->nodeType = type;
+    node->info = 0;
     node->children = NULL;
     node->brothers = NULL;
     return node;
@@ -4,10 +4,11 @@
  *
  * Responsibilities:
  *   - ASTGenerator(): builds the root PROGRAM node and drives statement parsing
+ *   - ASTGeneratorDeferred(): same, leaving function bodies for functionBody()
  *   - Statement dispatch table (statementHandlers[])
  *   - Error context creation from parser state
  *   - AST pretty-printing (printAST / printASTTree)
- *   - AST memory management (freeAST / freeASTContext)
+ *   - AST memory management (node arena / freeASTContext)
  *
  * This file owns the "main loop" of the parser but delegates all grammar-
  * specific work to the expression, statement, declaration, and function
@@ -15,22 +16,24 @@
  */
 
 #include "parserInternal.h"
+#include "memTrack.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-const StatementHandler statementHandlers[] = {
-    {TK_IMPORT,  parseImport},
-    {TK_EXPORT,  parseExportFunction},
-    {TK_FN,      parseFunction},
-    {TK_RETURN,  parseReturnStatement},
-    {TK_WHILE,   parseLoop},
-    {TK_LBRACE,  parseBlock},
-    {TK_STRUCT,  parseStruct},
-    {TK_IF,      parseIf},
-    {TK_FOR,     parseForLoop},
-    {TK_NULL,    NULL}
+const ParseFunc statementHandlers[TK_COUNT] = {
+    [TK_IMPORT]  = parseImport,
+    [TK_EXPORT]  = parseExportFunction,
+    [TK_FN]      = parseFunction,
+    [TK_RETURN]  = parseReturnStatement,
+    [TK_WHILE]   = parseLoop,
+    [TK_LBRACE]  = parseBlock,
+    [TK_STRUCT]  = parseStruct,
+    [TK_IF]      = parseIf,
+    [TK_FOR]     = parseForLoop,
+    [TK_CONST]   = parseDeclaration,
+    [TK_LET]     = parseDeclaration,
 };
 
 /**
@@ -38,34 +41,48 @@ const StatementHandler statementHandlers[] = {
  */
 ErrorContext* createErrorContextFromParser(TokenList* list, size_t* pos){
     static ErrorContext ctx;
-    static char* lastSourceLine = NULL;
 
     if(!list || *pos >= list->count) return NULL;
 
-    size_t tempPos = list->tokens[*pos].type != TK_SEMI ? *pos-1 : *pos;
-    Token* token = &list->tokens[tempPos];
+    size_t tempPos = tokenType(list, *pos) != TK_SEMI ? *pos-1 : *pos;
+    Token token = tokenAt(list, tempPos);
 
-    if(lastSourceLine){
-        free(lastSourceLine);
-        lastSourceLine = NULL;
-    }
-
-    lastSourceLine= extractSourceLineForToken(list, token);
+    SourceLocation loc = tokenLocation(list, &token);
+    uint32_t lineLength;
 
     ctx.file = list->filename ? list->filename : "source";
-    ctx.line = token->line;
-    ctx.column = token->column;
-    ctx.source = lastSourceLine;
-    ctx.startColumn = token->column;
-    ctx.length = token->length;
+    ctx.line = loc.line;
+    ctx.column = loc.column;
+    ctx.source = tokenSourceLine(list, &token, &lineLength);
+    ctx.sourceLength = lineLength;
+    ctx.startColumn = loc.column;
+    ctx.length = token.length;
 
     return &ctx;
 }
 
+// About one node per token, sized so typical modules fit in the first chunk
+#define NODE_ARENA_MIN_CHUNK (64 * 1024)
+#define NODE_ARENA_MAX_CHUNK (4 * 1024 * 1024)
+
 static ASTContext* buildASTContextFromTokenList(TokenList* list){
-    ASTContext* ctx = malloc(sizeof(struct ASTContext));
+    ASTContext* ctx = trackedMalloc(MEM_PARSER, sizeof(struct ASTContext));
+    if(!ctx) return NULL;
+
+    size_t chunkSize = list->count * sizeof(struct ASTNode);
+    if(chunkSize < NODE_ARENA_MIN_CHUNK) chunkSize = NODE_ARENA_MIN_CHUNK;
+    if(chunkSize > NODE_ARENA_MAX_CHUNK) chunkSize = NODE_ARENA_MAX_CHUNK;
+
     ctx->buffer = list->buffer;
+    ctx->source = list->source;
+    ctx->tokens = list;
     ctx->filename = list->filename;
+    ctx->root = NULL;
+    ctx->arena = createArena(MEM_PARSER, chunkSize);
+    if(!ctx->arena){
+        trackedFree(MEM_PARSER, ctx);
+        return NULL;
+    }
     return ctx;
 }
 
@@ -73,24 +90,29 @@ static ASTContext* buildASTContextFromTokenList(TokenList* list){
  * PUBLIC
  */
 
-/**
- * @brief Parses a list of tokens into an AST.
- */
-ASTContext* ASTGenerator(TokenList* tokenList){
+static ASTContext* generateAST(TokenList* tokenList, int deferBodies){
     if(!tokenList || tokenList->count == 0) return NULL;
 
     ASTContext* astContext = buildASTContextFromTokenList(tokenList);
-    ASTNode programNode;
-    
+    if(!astContext) return NULL;
+    setNodeArena(astContext->arena);
+    setDeferFunctionBodies(deferBodies);
+
     size_t pos = 0;
-    CREATE_NODE_OR_FAIL(programNode, NULL, PROGRAM, tokenList, &pos);
+    ASTNode programNode = createNode(NULL, PROGRAM, tokenList, &pos);
+    if(!programNode){
+        setNodeArena(NULL);
+        setDeferFunctionBodies(0);
+        freeASTContext(astContext);
+        return NULL;
+    }
     astContext->root = programNode;
 
     ASTNode lastStatement = NULL;
     size_t lastPos = (size_t)-1;
 
     while(pos < tokenList->count){
-        if(tokenList->tokens[pos].type == TK_EOF) break;
+        if(tokenType(tokenList, pos) == TK_EOF) break;
         if(pos == lastPos){
             reportError(ERROR_PARSER_STUCK, createErrorContextFromParser(tokenList, &pos), "Parser is stuck at token");
             pos++;
@@ -111,9 +133,22 @@ ASTContext* ASTGenerator(TokenList* tokenList){
         }
     }
 
+    setNodeArena(NULL);
+    setDeferFunctionBodies(0);
     return astContext;
 }
 
+/**
+ * @brief Parses a list of tokens into an AST.
+ */
+ASTContext* ASTGenerator(TokenList* tokenList){
+    return generateAST(tokenList, 0);
+}
+
+ASTContext* ASTGeneratorDeferred(TokenList* tokenList){
+    return generateAST(tokenList, 1);
+}
+
 /**
  * PRINTING AST
  */
@@ -128,7 +163,7 @@ void printASTTree(ASTNode node, char *prefix, int isLast) {
         char *str = extractText(node->start, node->length);
         if (str) {
             printf(": %s", str);
-            free(str);
+            trackedFree(MEM_PARSER, str);
         }
     }
     printf("\n");
@@ -163,16 +198,9 @@ void printAST(ASTNode node, int depth) {
  */
 
 
-void freeAST(ASTNode node) {
-    if (node == NULL) return;
-    freeAST(node->children);
-    freeAST(node->brothers);
-    free(node);
-}
-
 void freeASTContext(ASTContext *ctx) {
     if (ctx) {
-        if (ctx->root) freeAST(ctx->root);
-        free(ctx);
+        freeArena(ctx->arena);
+        trackedFree(MEM_PARSER, ctx);
     }
 }
\ No newline at end of file
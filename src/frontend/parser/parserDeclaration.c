@@ -4,7 +4,7 @@
  *
  * Responsibilities:
  *   - parseDeclaration(): const/let variable declarations with optional init
- *   - parseArrayDec(): typed array declarations (e.g., int[5])
+ *   - parseArrayDec(): typed array declarations (e.g., int[5], int[N * 2])
  *
  * Declarations sit between statements and expressions in complexity.
  * They rely on parserType.c for type parsing and parserExpression.c for
@@ -30,21 +30,9 @@ ASTNode parseArrayDec(TokenList* list, size_t* pos, Token* varName){
     /* expect size */
     EXPECT_AND_ADVANCE(list, pos, TK_LBRACKET, ERROR_EXPECTED_OPENING_BRACKET, "Expected '[' after type in array declaration");
 
-    Token* sizeToken = &list->tokens[*pos];
-    NodeTypes sizeType = detectLitType(sizeToken, list, pos);
-    if(!isIntTypeNode(sizeType) && sizeType != VARIABLE){
-        reportError(ERROR_INVALID_EXPRESSION, createErrorContextFromParser(list, pos), "Array size must be an integer literal or variable");
-        freeAST(typeNode);
-        return NULL;
-    }
-    
-    ASTNode sizeNode = createValNode(sizeToken, list, pos);
-    if(!sizeNode){
-        freeAST(typeNode);
-        return NULL;
-    }
-
-    ADVANCE_TOKEN(list, pos);
+    // Any expression, the type checker requires it to be a compile-time constant
+    ASTNode sizeNode;
+    PARSE_OR_FAIL(sizeNode, parseExpression(list, pos, PREC_NONE));
 
     EXPECT_AND_ADVANCE(list, pos, TK_RBRACKET, ERROR_EXPECTED_CLOSING_BRACKET, "Expected ']' after array size");
 
@@ -68,12 +56,12 @@ ASTNode parseArrayDec(TokenList* list, size_t* pos, Token* varName){
 ASTNode parseDeclaration(TokenList* list, size_t* pos){
     if(*pos >= list->count) return NULL;
 
-    int isConst = list->tokens[*pos].type == TK_CONST;
-    Token* mutToken = &list->tokens[*pos];
+    int isConst = tokenType(list, *pos) == TK_CONST;
+    Token mutToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
-    Token* varName = &list->tokens[*pos];
-    if(detectLitType(varName, list, pos) != VARIABLE){
+    Token varName = tokenAt(list, *pos);
+    if(detectLitType(&varName, list, pos) != VARIABLE){
         reportError(ERROR_EXPECTED_IDENTIFIER, createErrorContextFromParser(list, pos), "Expected identifier after const/let");
         return NULL;
     }
@@ -85,14 +73,14 @@ ASTNode parseDeclaration(TokenList* list, size_t* pos){
     int isArray = 0;
     size_t savedPos = *pos;
 
-    while(*pos < list->count && list->tokens[*pos].type == TK_STAR){
+    while(*pos < list->count && tokenType(list, *pos) == TK_STAR){
         ADVANCE_TOKEN(list, pos);
     }
 
-    Token* lookAheadToken = &list->tokens[*pos];
-    if((*pos < list->count && isTypeToken(lookAheadToken->type)) || detectLitType(lookAheadToken, list, pos) == VARIABLE){
+    Token lookAheadToken = tokenAt(list, *pos);
+    if((*pos < list->count && isTypeToken(lookAheadToken.type)) || detectLitType(&lookAheadToken, list, pos) == VARIABLE){
         ADVANCE_TOKEN(list, pos);
-        if(*pos < list->count && list->tokens[*pos].type == TK_LBRACKET){
+        if(*pos < list->count && tokenType(list, *pos) == TK_LBRACKET){
             isArray = 1;
         }
     }
@@ -101,28 +89,22 @@ ASTNode parseDeclaration(TokenList* list, size_t* pos){
 
     /* mut wrapper */
     ASTNode mutWrapNode;
-    CREATE_NODE_OR_FAIL(mutWrapNode, mutToken, isConst ? CONST_DEC : LET_DEC, list, pos);
+    CREATE_NODE_OR_FAIL(mutWrapNode, &mutToken, isConst ? CONST_DEC : LET_DEC, list, pos);
     ASTNode varDefNode;
 
     if(isArray){
-        varDefNode = parseArrayDec(list, pos, varName);
-        if(!varDefNode){
-            freeAST(mutWrapNode);
-            return NULL;
-        }
+        varDefNode = parseArrayDec(list, pos, &varName);
+        if(!varDefNode) return NULL;
     } else {
         ASTNode typeNode = parseType(list, pos);
-        if(!typeNode){
-            freeAST(mutWrapNode);
-            return NULL;
-        }
+        if(!typeNode) return NULL;
 
         ASTNode baseType = typeNode;
         while(baseType && baseType->nodeType == POINTER){
             baseType = baseType->children;
         }
 
-        CREATE_NODE_OR_FAIL(varDefNode, varName, VAR_DEFINITION, list, pos);
+        CREATE_NODE_OR_FAIL(varDefNode, &varName, VAR_DEFINITION, list, pos);
         ASTNode typeRefWrapNode;
         // NULL token means error wont be able to report location of the error
         CREATE_NODE_OR_FAIL(typeRefWrapNode, NULL, TYPE_REF, list, pos);
@@ -133,12 +115,12 @@ ASTNode parseDeclaration(TokenList* list, size_t* pos){
 
     /* Optional initializer */
 
-    if(*pos < list->count && list->tokens[*pos].type == TK_ASSIGN){
+    if(*pos < list->count && tokenType(list, *pos) == TK_ASSIGN){
         ADVANCE_TOKEN(list, pos);
-        int isRef = *pos < list->count && list->tokens[*pos].type == TK_AMPERSAND;
-        Token* refToken = NULL;
+        int isRef = *pos < list->count && tokenType(list, *pos) == TK_AMPERSAND;
+        Token refToken = {0};
         if(isRef){
-            refToken = &list->tokens[*pos];
+            refToken = tokenAt(list, *pos);
             ADVANCE_TOKEN(list, pos);
         }
 
@@ -167,13 +149,12 @@ ASTNode parseDeclaration(TokenList* list, size_t* pos){
 
         if(isRef){
             ASTNode memNode;
-            CREATE_NODE_OR_FAIL(memNode, refToken, MEMADDRS, list, pos);
+            CREATE_NODE_OR_FAIL(memNode, &refToken, MEMADDRS, list, pos);
             memNode->children = valueWrap->children;
             valueWrap->children = memNode;
         }
     } else if(isConst){
         reportError(ERROR_CONST_MUST_BE_INITIALIZED, createErrorContextFromParser(list, pos), "Const declarations must have an initializer");
-        freeAST(mutWrapNode);
         return NULL;
     }
 
@@ -32,21 +32,21 @@ static ASTNode parseCastExpression(TokenList* list, size_t* pos, ASTNode node);
  */
 ASTNode parsePrimaryExp(TokenList* list, size_t* pos){
     if(*pos >= list->count) return NULL;
-    Token* token = &list->tokens[*pos];
+    Token token = tokenAt(list, *pos);
 
     /**
      * Pointer dereference or address-of as prefixes
      */
-    if(token->type == TK_STAR || token->type == TK_AMPERSAND){
-        Token* opToken = token;
-        uint8_t isPointer = token->type == TK_STAR;
+    if(token.type == TK_STAR || token.type == TK_AMPERSAND){
+        Token opToken = token;
+        uint8_t isPointer = token.type == TK_STAR;
         ADVANCE_TOKEN(list, pos);
 
         ASTNode operand = parsePrimaryExp(list, pos);
         if(!operand) return NULL;
 
         ASTNode memWrap;
-        CREATE_NODE_OR_FAIL(memWrap, opToken, isPointer ? POINTER : MEMADDRS, list, pos);
+        CREATE_NODE_OR_FAIL(memWrap, &opToken, isPointer ? POINTER : MEMADDRS, list, pos);
         memWrap->children = operand;
         return memWrap;
     }
@@ -54,23 +54,23 @@ ASTNode parsePrimaryExp(TokenList* list, size_t* pos){
     /**
      * Arrays literals
      */
-    if(token->type == TK_LBRACKET){
+    if(token.type == TK_LBRACKET){
         return parseArrLit(list, pos);
     }
 
     /**
      * Struct literal { field: value, ...}
      */
-    if(token->type == TK_LBRACE){
+    if(token.type == TK_LBRACE){
         return parseStructLit(list, pos);
     }
 
     /**
      * Null literal
      */
-    if(token->type == TK_NULL){
+    if(token.type == TK_NULL){
         ASTNode nullNode;
-        CREATE_NODE_OR_FAIL(nullNode, token, NULL_LIT, list, pos);
+        CREATE_NODE_OR_FAIL(nullNode, &token, NULL_LIT, list, pos);
         ADVANCE_TOKEN(list, pos);
         return nullNode;
     }
@@ -78,7 +78,7 @@ ASTNode parsePrimaryExp(TokenList* list, size_t* pos){
     /**
      * Parenthesized expression
      */
-    if(token->type == TK_LPAREN){
+    if(token.type == TK_LPAREN){
         ADVANCE_TOKEN(list, pos);
         ASTNode expr = parseExpression(list, pos, PREC_NONE);
         if(!expr) return NULL;
@@ -89,38 +89,36 @@ ASTNode parsePrimaryExp(TokenList* list, size_t* pos){
     /**
      * Function call
      */
-    if(detectLitType(token, list, pos) == VARIABLE && (*pos + 1 < list->count) && list->tokens[*pos + 1].type == TK_LPAREN){
-        Token* fnNameToken = token;
+    if(detectLitType(&token, list, pos) == VARIABLE && (*pos + 1 < list->count) && tokenType(list, *pos + 1) == TK_LPAREN){
+        Token fnNameToken = token;
         ADVANCE_TOKEN(list, pos); // consume function name
-        ASTNode funcCall = parseFunctionCall(list, pos, fnNameToken);
+        ASTNode funcCall = parseFunctionCall(list, pos, &fnNameToken);
         return funcCall;
     }
 
     // Fallback to lit or variable
-    ASTNode node = createValNode(token, list, pos);
+    ASTNode node = createValNode(&token, list, pos);
     if(!node) return NULL;
     ADVANCE_TOKEN(list, pos);
 
     while(*pos < list->count){
-        if(list->tokens[*pos].type == TK_DOT){
+        if(tokenType(list, *pos) == TK_DOT){
             ADVANCE_TOKEN(list, pos);
-            if(detectLitType(&list->tokens[*pos], list, pos) != VARIABLE){
+            Token memberToken = tokenAt(list, *pos);
+            if(detectLitType(&memberToken, list, pos) != VARIABLE){
                 reportError(ERROR_EXPECTED_MEMBER_NAME, createErrorContextFromParser(list, pos), "Expected member name after '.'");
-                freeAST(node);
                 return NULL;
             }
-
-            Token* memberToken = &list->tokens[*pos];
             ADVANCE_TOKEN(list, pos);
 
             ASTNode memberAccess, memberNode;
-            CREATE_NODE_OR_FAIL(memberAccess, memberToken, MEMBER_ACCESS, list, pos);
-            CREATE_NODE_OR_FAIL(memberNode, memberToken, VARIABLE, list, pos);
+            CREATE_NODE_OR_FAIL(memberAccess, &memberToken, MEMBER_ACCESS, list, pos);
+            CREATE_NODE_OR_FAIL(memberNode, &memberToken, VARIABLE, list, pos);
 
             memberAccess->children = node;
             node->brothers = memberNode;
             node = memberAccess;
-        } else if(list->tokens[*pos].type == TK_LBRACKET){
+        } else if(tokenType(list, *pos) == TK_LBRACKET){
             node = parseArrayAccess(list, pos, node);
             if(!node) return NULL;
         }else{
@@ -136,21 +134,21 @@ ASTNode parsePrimaryExp(TokenList* list, size_t* pos){
 
 ASTNode parseUnary(TokenList *list, size_t *pos) {
     if (*pos >= list->count) return NULL;
-    Token *token = &list->tokens[*pos];
+    Token token = tokenAt(list, *pos);
 
     /* Prefix operators */
-    if (token->type == TK_MINUS || token->type == TK_NOT || token->type == TK_INCR ||
-        token->type == TK_DECR || token->type == TK_PLUS || token->type == TK_BIT_NOT) {
-        Token *opToken = token;
+    if (token.type == TK_MINUS || token.type == TK_NOT || token.type == TK_INCR ||
+        token.type == TK_DECR || token.type == TK_PLUS || token.type == TK_BIT_NOT) {
+        Token opToken = token;
         ADVANCE_TOKEN(list, pos);
 
         ASTNode operand, opNode;
         PARSE_OR_FAIL(operand, parseUnary(list, pos));
 
-        NodeTypes opType = getUnaryOpType(opToken->type);
+        NodeTypes opType = getUnaryOpType(opToken.type);
         if (opType == null_NODE) return NULL;
 
-        CREATE_NODE_OR_FAIL(opNode, opToken, opType, list, pos);
+        CREATE_NODE_OR_FAIL(opNode, &opToken, opType, list, pos);
         opNode->children = operand;
         return opNode;
     }
@@ -158,12 +156,12 @@ ASTNode parseUnary(TokenList *list, size_t *pos) {
 
     ASTNode node = parsePrimaryExp(list, pos);
 
-    if(*pos < list->count && (list->tokens[*pos].type == TK_INCR || list->tokens[*pos].type == TK_DECR)){
-        Token* opToken = &list->tokens[*pos];
+    if(*pos < list->count && (tokenType(list, *pos) == TK_INCR || tokenType(list, *pos) == TK_DECR)){
+        Token opToken = tokenAt(list, *pos);
         ADVANCE_TOKEN(list, pos);
         ASTNode opNode;
-        NodeTypes opType = opToken->type == TK_INCR ? POST_INCREMENT : POST_DECREMENT;
-        CREATE_NODE_OR_FAIL(opNode, opToken, opType, list, pos);
+        NodeTypes opType = opToken.type == TK_INCR ? POST_INCREMENT : POST_DECREMENT;
+        CREATE_NODE_OR_FAIL(opNode, &opToken, opType, list, pos);
         opNode->children = node;
         return opNode;
     }
@@ -177,15 +175,15 @@ ASTNode parseUnary(TokenList *list, size_t *pos) {
 
 static ASTNode parseCastExpression(TokenList* list, size_t* pos, ASTNode node){
     if(*pos >= list->count || !node) return NULL;
-    Token* asToken = &list->tokens[*pos];
+    Token asToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
-    Token* currentToken = &list->tokens[*pos];
-    if(isTypeToken(currentToken->type)){
+    Token currentToken = tokenAt(list, *pos);
+    if(isTypeToken(currentToken.type)){
         ASTNode refTypeNode, castNode;
-        CREATE_NODE_OR_FAIL(refTypeNode, currentToken, getTypeNodeFromToken(currentToken->type), list, pos);
+        CREATE_NODE_OR_FAIL(refTypeNode, &currentToken, getTypeNodeFromToken(currentToken.type), list, pos);
         ADVANCE_TOKEN(list, pos);
-        CREATE_NODE_OR_FAIL(castNode, asToken, CAST_EXPRESSION, list, pos);
+        CREATE_NODE_OR_FAIL(castNode, &asToken, CAST_EXPRESSION, list, pos);
         castNode->children = node;
         node->brothers = refTypeNode;
         return castNode;
@@ -203,10 +201,10 @@ ASTNode parseExpression(TokenList* list, size_t* pos, Precedence minPrecedence){
     ASTNode left = parseUnary(list, pos);
     if(!left) return NULL;
     while(*pos < list->count){
-        Token* currentToken = &list->tokens[*pos];
+        Token currentToken = tokenAt(list, *pos);
 
         /* Ternaries */
-        if(currentToken->type == TK_QUESTION && PREC_TERNARY >= minPrecedence){
+        if(currentToken.type == TK_QUESTION && PREC_TERNARY >= minPrecedence){
             ASTNode conditionNode = parseTernary(list, pos);
             if(!conditionNode) return NULL;
             left->brothers = conditionNode->children;
@@ -217,23 +215,23 @@ ASTNode parseExpression(TokenList* list, size_t* pos, Precedence minPrecedence){
         }
 
         /* Casts */
-        if(currentToken->type == TK_AS && PREC_CAST >= minPrecedence){
+        if(currentToken.type == TK_AS && PREC_CAST >= minPrecedence){
             left = parseCastExpression(list, pos, left);
             if(!left) return NULL;
             continue;
         }
 
         /* Binary operator */
-        const OperatorInfo* opInfo = getOperatorInfo(currentToken->type);
+        const OperatorInfo* opInfo = getOperatorInfo(currentToken.type);
         if(!opInfo || opInfo->precedence < minPrecedence) break;
 
         Precedence nextMinPrecedence = opInfo->isRightAssociative ? 0 : opInfo->precedence + 1;
-        Token* opToken = currentToken;
+        Token opToken = currentToken;
         ADVANCE_TOKEN(list, pos);
         ASTNode rigth = parseExpression(list, pos, nextMinPrecedence);
         if(!rigth) return NULL;
 
-        ASTNode opNode = createNode(opToken, opInfo->nodeType, list, pos);
+        ASTNode opNode = createNode(&opToken, opInfo->nodeType, list, pos);
         opNode->children = left;
         left->brothers = rigth;
         left = opNode;
@@ -248,7 +246,7 @@ ASTNode parseExpression(TokenList* list, size_t* pos, Precedence minPrecedence){
 
 ASTNode parseTernary(TokenList* list, size_t* pos){
     EXPECT_TOKEN(list, pos, TK_QUESTION, ERROR_EXPECTED_QUESTION_MARK, "Expected '?' for ternary operator");
-    Token* questionToken = &list->tokens[*pos];
+    Token questionToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
     ASTNode trueBranch = parseExpression(list, pos, PREC_NONE);
@@ -257,22 +255,21 @@ ASTNode parseTernary(TokenList* list, size_t* pos){
         return NULL;
     }
 
-    if(list->tokens[*pos].type != TK_COLON){
+    if(tokenType(list, *pos) != TK_COLON){
         reportError(ERROR_EXPECTED_COLON, createErrorContextFromParser(list, pos), "Missing false branch in ternary operator");
-        freeAST(trueBranch);
         return NULL;
     }
-    Token* colonToken = &list->tokens[*pos];
+    Token colonToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
     ASTNode falseBranch = parseExpression(list, pos, PREC_NONE);
 
     ASTNode conditionalNode, trueBranchWrap, falseBranchWrap;
-    CREATE_NODE_OR_FAIL(conditionalNode, questionToken, TERNARY_CONDITIONAL, list, pos);
+    CREATE_NODE_OR_FAIL(conditionalNode, &questionToken, TERNARY_CONDITIONAL, list, pos);
     /** 
      * todo: both questionToken and coloToken doesnt point to the actual branches an they should to get better error repoting
      */
-    CREATE_NODE_OR_FAIL(trueBranchWrap, questionToken, TERNARY_IF_EXPR, list, pos); 
-    CREATE_NODE_OR_FAIL(falseBranchWrap, colonToken, TERNARY_ELSE_EXPR, list, pos);
+    CREATE_NODE_OR_FAIL(trueBranchWrap, &questionToken, TERNARY_IF_EXPR, list, pos); 
+    CREATE_NODE_OR_FAIL(falseBranchWrap, &colonToken, TERNARY_ELSE_EXPR, list, pos);
 
     trueBranchWrap->children = trueBranch;
     /** 
@@ -304,25 +301,22 @@ ASTNode parseBlockExpression(TokenList* list, size_t* pos){
 ASTNode parseArrLit(TokenList* list, size_t* pos){
     if(*pos >= list->count) return NULL;
 
-    Token* startToken = &list->tokens[*pos];
+    Token startToken = tokenAt(list, *pos);
     EXPECT_AND_ADVANCE(list, pos, TK_LBRACKET, ERROR_EXPECTED_OPENING_BRACKET, "Expected '[' to start array literal");
 
     ASTNode arrayLitNode;
-    CREATE_NODE_OR_FAIL(arrayLitNode, startToken, ARRAY_LIT, list, pos);
+    CREATE_NODE_OR_FAIL(arrayLitNode, &startToken, ARRAY_LIT, list, pos);
 
     /* Empty array */
-    if(*pos < list->count && list->tokens[*pos].type == TK_RBRACKET){
+    if(*pos < list->count && tokenType(list, *pos) == TK_RBRACKET){
         ADVANCE_TOKEN(list, pos);
         return arrayLitNode;
     }
 
     ASTNode lastElement = NULL;
-    while(*pos < list->count && list->tokens[*pos].type != TK_RBRACKET){
+    while(*pos < list->count && tokenType(list, *pos) != TK_RBRACKET){
         ASTNode element = parseExpression(list, pos, PREC_NONE);
-        if(!element){
-            freeAST(arrayLitNode);
-            return NULL;
-        }
+        if(!element) return NULL;
 
         if(!arrayLitNode->children){
             arrayLitNode->children = element;
@@ -332,11 +326,10 @@ ASTNode parseArrLit(TokenList* list, size_t* pos){
             lastElement = element;
         }
 
-        if(*pos < list->count && list->tokens[*pos].type == TK_COMMA){
+        if(*pos < list->count && tokenType(list, *pos) == TK_COMMA){
             ADVANCE_TOKEN(list, pos);
-        } else if(*pos < list->count && list->tokens[*pos].type != TK_RBRACKET) {
+        } else if(*pos < list->count && tokenType(list, *pos) != TK_RBRACKET) {
             reportError(ERROR_EXPECTED_COMMA, createErrorContextFromParser(list, pos), "Expected ',' between array literal elements");
-            freeAST(arrayLitNode);
             return NULL;
         }
     }
@@ -353,20 +346,20 @@ ASTNode parseArrLit(TokenList* list, size_t* pos){
 ASTNode parseStructLit(TokenList* list, size_t* pos){
     if(*pos >= list->count) return NULL;
 
-    Token* startToken = &list->tokens[*pos];
+    Token startToken = tokenAt(list, *pos);
     EXPECT_AND_ADVANCE(list, pos, TK_LBRACE, ERROR_EXPECTED_OPENING_BRACE, "Expected '{' to start struct literal");
 
     ASTNode structLitNode;
-    CREATE_NODE_OR_FAIL(structLitNode, startToken, STRUCT_LIT, list, pos);
+    CREATE_NODE_OR_FAIL(structLitNode, &startToken, STRUCT_LIT, list, pos);
 
     /* Empty struct literal */
-    if(*pos < list->count && list->tokens[*pos].type == TK_RBRACE){
+    if(*pos < list->count && tokenType(list, *pos) == TK_RBRACE){
         ADVANCE_TOKEN(list, pos);
         return structLitNode;
     }
 
     ASTNode lastField = NULL;
-    while(*pos < list->count && list->tokens[*pos].type != TK_RBRACE){
+    while(*pos < list->count && tokenType(list, *pos) != TK_RBRACE){
         ASTNode fieldNode;
         PARSE_OR_FAIL(fieldNode, parseStructFieldLit(list, pos));
 
@@ -378,7 +371,7 @@ ASTNode parseStructLit(TokenList* list, size_t* pos){
         lastField = fieldNode;
 
         /* Optional comma between fields */
-        if(*pos < list->count && list->tokens[*pos].type == TK_COMMA){
+        if(*pos < list->count && tokenType(list, *pos) == TK_COMMA){
             ADVANCE_TOKEN(list, pos);
         }
     }
@@ -397,10 +390,7 @@ ASTNode parseArrayAccess(TokenList* list, size_t* pos, ASTNode array){
     EXPECT_AND_ADVANCE(list, pos, TK_LBRACKET, ERROR_EXPECTED_OPENING_BRACKET, "Expected '['.");
 
     ASTNode indexExpr = parseExpression(list, pos, PREC_NONE);
-    if (!indexExpr) {
-        freeAST(array);
-        return NULL;
-    }
+    if (!indexExpr) return NULL;
 
     EXPECT_AND_ADVANCE(list, pos, TK_RBRACKET, ERROR_EXPECTED_CLOSING_BRACKET,"Expected ']' after array index");
 
@@ -8,6 +8,7 @@
  *   - parseCommaSeparatedLists(): generic ( elem, elem, ... ) parser
  *   - parseParameter() / parseArg(): individual parameter and argument
  *   - parseReturnType(): -> type
+ *   - functionBody(): parses a body that ASTGeneratorDeferred() skipped
  *   - parseStruct(): struct definition with field list
  *   - parseStructField(): single field in a struct definition
  *   - parseStructFieldLit(): single field in a struct literal
@@ -28,20 +29,19 @@ ASTNode parseCommaSeparatedLists(TokenList* list, size_t* pos, NodeTypes listTyp
     CREATE_NODE_OR_FAIL(listNode, NULL, listType, list, pos);
 
     ASTNode last = NULL;
-    while(*pos < list->count && list->tokens[*pos].type != TK_RPAREN){
+    while(*pos < list->count && tokenType(list, *pos) != TK_RPAREN){
         ASTNode elem;
-        PARSE_OR_CLEANUP(elem, parseElement(list, pos), listNode);
+        PARSE_OR_FAIL(elem, parseElement(list, pos));
 
         if(!listNode->children) listNode->children = elem;
         else last->brothers = elem;
 
         last = elem;
 
-        if(*pos < list->count && list->tokens[*pos].type == TK_COMMA){
+        if(*pos < list->count && tokenType(list, *pos) == TK_COMMA){
             ADVANCE_TOKEN(list, pos);
-        } else if(list->tokens[*pos].type != TK_RPAREN){
+        } else if(tokenType(list, *pos) != TK_RPAREN){
             reportError(ERROR_EXPECTED_COMMA_OR_PAREN, createErrorContextFromParser(list, pos), "Expected ',' or ')'");
-            freeAST(listNode);
             return NULL;
         }
     }
@@ -52,15 +52,15 @@ ASTNode parseCommaSeparatedLists(TokenList* list, size_t* pos, NodeTypes listTyp
 
 ASTNode parseParameter(TokenList* list, size_t* pos){
     if(*pos >= list->count) return NULL;
-    Token* token = &list->tokens[*pos];
+    Token token = tokenAt(list, *pos);
 
-    if(detectLitType(token, list, pos) != VARIABLE){
+    if(detectLitType(&token, list, pos) != VARIABLE){
         reportError(ERROR_EXPECTED_PARAMETER_NAME, createErrorContextFromParser(list, pos), "Expected parameter name");
         return NULL;
     }
 
     ASTNode paramNode;
-    CREATE_NODE_OR_FAIL(paramNode, token, PARAMETER, list, pos);
+    CREATE_NODE_OR_FAIL(paramNode, &token, PARAMETER, list, pos);
     ADVANCE_TOKEN(list, pos);
 
     EXPECT_AND_ADVANCE(list, pos, TK_COLON, ERROR_EXPECTED_COLON, "Expected ':' after parameter name");
@@ -106,7 +106,7 @@ ASTNode parseFunctionCall(TokenList* list, size_t* pos, Token* token){
     ASTNode callNode, argList;
     CREATE_NODE_OR_FAIL(callNode, token, FUNCTION_CALL, list, pos);
 
-    PARSE_OR_CLEANUP(argList, parseCommaSeparatedLists(list, pos, ARGUMENT_LIST, parseArg), callNode);
+    PARSE_OR_FAIL(argList, parseCommaSeparatedLists(list, pos, ARGUMENT_LIST, parseArg));
 
     callNode->children = argList;
     return callNode;
@@ -116,23 +116,97 @@ ASTNode parseFunctionCall(TokenList* list, size_t* pos, Token* token){
  * Function definition
  */
 
+static _Thread_local int deferFunctionBodies = 0;
+
+void setDeferFunctionBodies(int defer) {
+    deferFunctionBodies = defer;
+}
+
+/*
+ * Index of the '}' closing the brace at *pos, or 0 when the list ends first
+ * so the caller can parse the body now and report the error where it is.
+ */
+static size_t matchingBrace(TokenList* list, size_t pos){
+    size_t depth = 0;
+    for(; pos < list->count; pos++){
+        TokenType type = tokenType(list, pos);
+        if(type == TK_LBRACE){
+            depth++;
+        }else if(type == TK_RBRACE){
+            if(--depth == 0) return pos;
+        }else if(type == TK_EOF){
+            break;
+        }
+    }
+    return 0;
+}
+
+/*
+ * The body node only covers the braces: its start and length span the
+ * source from '{' to '}', which is all functionBody() needs to come back.
+ */
+static ASTNode deferBody(TokenList* list, size_t* pos){
+    size_t close = matchingBrace(list, *pos);
+    if(!close) return parseBlock(list, pos);
+
+    Token open = tokenAt(list, *pos);
+    ASTNode body;
+    CREATE_NODE_OR_FAIL(body, &open, DEFERRED_BODY, list, pos);
+    body->length = list->offsets[close] + tokenAt(list, close).length - open.offset;
+    *pos = close + 1;
+    return body;
+}
+
+// Token offsets only grow, so the '{' is found by bisection
+static size_t tokenIndexAt(TokenList* list, uint32_t offset){
+    size_t lo = 0, hi = list->count;
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if(list->offsets[mid] < offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+ASTNode functionBody(ASTContext* ctx, ASTNode function){
+    if(!function || function->nodeType != FUNCTION_DEFINITION || !function->children) return NULL;
+    ASTNode returnType = function->children->brothers;
+    ASTNode body = returnType ? returnType->brothers : NULL;
+    if(!body || body->nodeType != DEFERRED_BODY) return body;
+    if(!ctx || !ctx->tokens) return NULL;
+
+    TokenList* list = ctx->tokens;
+    size_t pos = tokenIndexAt(list, (uint32_t)(body->start - list->buffer));
+    setNodeArena(ctx->arena);
+    ASTNode parsed = parseBlock(list, &pos);
+    setNodeArena(NULL);
+    if(!parsed) return NULL;
+
+    // Replace in place so the links to the node stay valid
+    parsed->brothers = body->brothers;
+    *body = *parsed;
+    return body;
+}
+
 ASTNode parseFunction(TokenList* list, size_t* pos){
     EXPECT_TOKEN(list, pos, TK_FN, ERROR_EXPECTED_FN, "Expected 'fn' keyword");
     ADVANCE_TOKEN(list, pos);
 
-    if(*pos >= list->count || detectLitType(&list->tokens[*pos], list, pos) != VARIABLE){
+    // The list always ends in TK_EOF, so the 'fn' just consumed has a successor
+    Token nameToken = tokenAt(list, *pos);
+    if(detectLitType(&nameToken, list, pos) != VARIABLE){
         reportError(ERROR_EXPECTED_FUNCTION_NAME, createErrorContextFromParser(list, pos), "Expected function name");
         return NULL;
     }
     ASTNode functionNode;
-    CREATE_NODE_OR_FAIL(functionNode, &list->tokens[*pos], FUNCTION_DEFINITION, list, pos);
+    CREATE_NODE_OR_FAIL(functionNode, &nameToken, FUNCTION_DEFINITION, list, pos);
 
     ADVANCE_TOKEN(list, pos);
     ASTNode paramList, returnType, body;
-    PARSE_OR_CLEANUP(paramList, parseCommaSeparatedLists(list, pos, PARAMETER_LIST, parseParameter), functionNode);
-    PARSE_OR_CLEANUP(returnType, parseReturnType(list, pos), functionNode, paramList);
+    PARSE_OR_FAIL(paramList, parseCommaSeparatedLists(list, pos, PARAMETER_LIST, parseParameter));
+    PARSE_OR_FAIL(returnType, parseReturnType(list, pos));
     EXPECT_TOKEN(list, pos, TK_LBRACE, ERROR_EXPECTED_OPENING_BRACE, "Expected '{' to start function body");
-    PARSE_OR_CLEANUP(body, parseBlock(list, pos), functionNode, paramList, returnType);
+    PARSE_OR_FAIL(body, deferFunctionBodies ? deferBody(list, pos) : parseBlock(list, pos));
 
     functionNode->children = paramList;
     paramList->brothers = returnType;
@@ -146,14 +220,14 @@ ASTNode parseFunction(TokenList* list, size_t* pos){
  */
 
 ASTNode parseStructField(TokenList* list, size_t* pos){
-    Token* name = &list->tokens[*pos];
-    if(detectLitType(name, list, pos) != VARIABLE){
+    Token name = tokenAt(list, *pos);
+    if(detectLitType(&name, list, pos) != VARIABLE){
         reportError(ERROR_EXPECTED_FIELD_NAME, createErrorContextFromParser(list, pos), "Expected field name");
         return NULL;
     }
 
     ASTNode fieldNode;
-    CREATE_NODE_OR_FAIL(fieldNode, name, STRUCT_FIELD, list, pos);
+    CREATE_NODE_OR_FAIL(fieldNode, &name, STRUCT_FIELD, list, pos);
     ADVANCE_TOKEN(list, pos);
     EXPECT_AND_ADVANCE(list, pos, TK_COLON, ERROR_EXPECTED_COLON, "Expected ':' after field name");
 
@@ -170,14 +244,14 @@ ASTNode parseStructField(TokenList* list, size_t* pos){
 }
 
 ASTNode parseStructFieldLit(TokenList *list, size_t *pos) {
-    Token *name = &list->tokens[*pos];
-    if (detectLitType(name, list, pos) != VARIABLE) {
+    Token name = tokenAt(list, *pos);
+    if (detectLitType(&name, list, pos) != VARIABLE) {
         reportError(ERROR_EXPECTED_FIELD_NAME, createErrorContextFromParser(list, pos), "Expected field name in struct literal");
         return NULL;
     }
 
     ASTNode fieldNode;
-    CREATE_NODE_OR_FAIL(fieldNode, name, STRUCT_FIELD_LIT, list, pos);
+    CREATE_NODE_OR_FAIL(fieldNode, &name, STRUCT_FIELD_LIT, list, pos);
     ADVANCE_TOKEN(list, pos);
 
     EXPECT_AND_ADVANCE(list, pos, TK_COLON, ERROR_EXPECTED_COLON, "Expected ':' after field name in struct literal");
@@ -193,8 +267,8 @@ ASTNode parseStruct(TokenList *list, size_t *pos) {
     EXPECT_TOKEN(list, pos, TK_STRUCT, ERROR_EXPECTED_STRUCT, "expected struct");
     ADVANCE_TOKEN(list, pos);
 
-    Token *name = &list->tokens[*pos];
-    if (detectLitType(name, list, pos) != VARIABLE) {
+    Token name = tokenAt(list, *pos);
+    if (detectLitType(&name, list, pos) != VARIABLE) {
         reportError(ERROR_EXPECTED_STRUCT_NAME,
                     createErrorContextFromParser(list, pos),
                     "Expected name for struct");
@@ -202,7 +276,7 @@ ASTNode parseStruct(TokenList *list, size_t *pos) {
     }
 
     ASTNode structNode;
-    CREATE_NODE_OR_FAIL(structNode, name, STRUCT_DEFINITION, list, pos);
+    CREATE_NODE_OR_FAIL(structNode, &name, STRUCT_DEFINITION, list, pos);
     ADVANCE_TOKEN(list, pos);
 
     EXPECT_AND_ADVANCE(list, pos, TK_LBRACE, ERROR_EXPECTED_OPENING_BRACE, "Expected '{'");
@@ -211,9 +285,9 @@ ASTNode parseStruct(TokenList *list, size_t *pos) {
     CREATE_NODE_OR_FAIL(fieldList, NULL, STRUCT_FIELD_LIST, list, pos);
 
     ASTNode last = NULL;
-    while (list->tokens[*pos].type != TK_RBRACE) {
+    while (tokenType(list, *pos) != TK_RBRACE) {
         ASTNode field;
-        PARSE_OR_CLEANUP(field, parseStructField(list, pos), structNode, fieldList);
+        PARSE_OR_FAIL(field, parseStructField(list, pos));
 
         if (!fieldList->children)
             fieldList->children = field;
@@ -222,13 +296,13 @@ ASTNode parseStruct(TokenList *list, size_t *pos) {
         last = field;
 
         /* Semicolons between fields are optional */
-        if (*pos < list->count && list->tokens[*pos].type == TK_SEMI) {
+        if (*pos < list->count && tokenType(list, *pos) == TK_SEMI) {
             ADVANCE_TOKEN(list, pos);
         }
     }
 
     EXPECT_AND_ADVANCE(list, pos, TK_RBRACE, ERROR_EXPECTED_CLOSING_BRACE, "Expected '}' to close struct");
-    if (list->tokens[*pos].type == TK_SEMI) {
+    if (tokenType(list, *pos) == TK_SEMI) {
         ADVANCE_TOKEN(list, pos);
     }
 
@@ -6,7 +6,7 @@
  * by code outside the parser module.  It contains:
  *   - Convenience macros for token handling and error-checked node creation
  *   - Operator precedence and associativity tables (Pratt parser)
- *   - Statement dispatch table type
+ *   - Statement and binary operator dispatch tables, indexed by TokenType
  *   - All internal function prototypes
  */
 
@@ -16,6 +16,7 @@
 #include "parser.h"
 #include "errorHandling.h"
 #include "lexer.h"
+#include "arena.h"
 
 // macros
 
@@ -25,7 +26,7 @@
 #define EXPECT_TOKEN(list, pos, expectedType, errCode, errMsg) \
     do { \
         if (*(pos) >= (list)->count || \
-            (list)->tokens[*(pos)].type != (expectedType)) { \
+            tokenType(list, *(pos)) != (expectedType)) { \
             reportError(errCode, \
                         createErrorContextFromParser(list, pos), \
                         errMsg ? errMsg : "Unexpected token"); \
@@ -45,19 +46,6 @@
         if (!var) return NULL; \
     } while(0)
 
-#define PARSE_OR_CLEANUP(var, parseExpr, ...) \
-    do { \
-        var = (parseExpr); \
-        if (!var) { \
-            ASTNode _cleanup_nodes[] = {__VA_ARGS__}; \
-            size_t _count = sizeof(_cleanup_nodes)/sizeof(_cleanup_nodes[0]); \
-            for (size_t _i = 0; _i < _count; _i++) { \
-                if (_cleanup_nodes[_i]) freeAST(_cleanup_nodes[_i]); \
-            } \
-            return NULL; \
-        } \
-    } while(0)
-
 #define PARSE_OR_FAIL(var, parseExpr) \
     do { \
         var = (parseExpr); \
@@ -93,13 +81,8 @@ typedef struct {
 
 typedef ASTNode (*ParseFunc)(TokenList *list, size_t *pos);
 
-typedef struct {
-    TokenType token;
-    ParseFunc handler;
-} StatementHandler;
-
-// on parserCore.c
-extern const StatementHandler statementHandlers[];
+// on parserCore.c, indexed by the statement's first token, NULL for expression statements
+extern const ParseFunc statementHandlers[TK_COUNT];
 
 ErrorContext *createErrorContextFromParser(TokenList* list, size_t* pos);
 
@@ -107,6 +90,11 @@ ErrorContext *createErrorContextFromParser(TokenList* list, size_t* pos);
  * Node construction
  */
 
+/*
+ * Nodes come from the arena of the ASTGenerator call running on this thread,
+ * partial trees left behind by a failed parse are reclaimed with it.
+ */
+void setNodeArena(Arena* arena);
 ASTNode createNode(const Token* token, NodeTypes type, TokenList* list, size_t* pos);
 ASTNode createValNode(const Token* currentToken, TokenList* list, size_t* pos);
 NodeTypes detectLitType(const Token* tok, TokenList* list, size_t* pos);
@@ -126,7 +114,13 @@ int isIntTypeNode(NodeTypes nodeType);
  * Operators
  */
 
-const OperatorInfo* getOperatorInfo(TokenType type);
+// on parserHelpers.c
+extern const OperatorInfo binaryOperators[TK_COUNT];
+
+static inline const OperatorInfo *getOperatorInfo(TokenType type) {
+    const OperatorInfo *info = &binaryOperators[type];
+    return info->precedence != PREC_NONE ? info : NULL;
+}
 const char *getTokenTypeName(TokenType type);
 const char *getCurrentTokenName(TokenList* list, size_t* pos);
 
@@ -169,6 +163,8 @@ ASTNode parseArrayDec(TokenList *list, size_t *pos, Token *varName);
  * Functions & Structs
  */
 
+// While set on this thread, parseFunction() brace-matches bodies instead of parsing them
+void setDeferFunctionBodies(int defer);
 ASTNode parseFunction(TokenList *list, size_t *pos);
 ASTNode parseFunctionCall(TokenList *list, size_t *pos, Token *tok);
 ASTNode parseParameter(TokenList *list, size_t *pos);
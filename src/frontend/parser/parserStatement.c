@@ -37,29 +37,23 @@ ASTNode parseExpressionStatement(TokenList* list, size_t* pos){
 ASTNode parseStatement(TokenList* list, size_t* pos){
     if(*pos >= list->count) return NULL;
 
-    Token* currentToken = &list->tokens[*pos];
+    TokenType type = tokenType(list, *pos);
 
-    if(currentToken->type == TK_EOF){
+    if(type == TK_EOF){
         ADVANCE_TOKEN(list, pos);
         return NULL;
     }
 
     /* skip semicolons */
-    if(currentToken->type == TK_SEMI){
+    if(type == TK_SEMI){
         ADVANCE_TOKEN(list, pos);
         return NULL;
     }
 
-    /* Toble driven statements on parseCore.c */
-    for(int i = 0; statementHandlers[i].token != TK_NULL; ++i){
-        if(currentToken->type == statementHandlers[i].token){
-            return statementHandlers[i].handler(list, pos);
-        }
-    }
-
-    /* cosnt | let declarations */
-    if(currentToken->type == TK_CONST || currentToken->type == TK_LET){
-        return parseDeclaration(list, pos);
+    /* Table driven statements on parseCore.c, const | let declarations included */
+    ParseFunc handler = statementHandlers[type];
+    if(handler){
+        return handler(list, pos);
     }
 
     return parseExpressionStatement(list, pos);
@@ -73,11 +67,12 @@ ASTNode parseBlock(TokenList* list, size_t* pos){
     EXPECT_TOKEN(list, pos, TK_LBRACE, ERROR_EXPECTED_OPENING_BRACE, "Expected '{' to start block");
     ADVANCE_TOKEN(list, pos);
 
+    Token braceToken = tokenAt(list, *pos - 1);
     ASTNode blockNode;
-    CREATE_NODE_OR_FAIL(blockNode, &list->tokens[*pos - 1], BLOCK_STATEMENT, list, pos);
+    CREATE_NODE_OR_FAIL(blockNode, &braceToken, BLOCK_STATEMENT, list, pos);
 
     ASTNode lastChild = NULL;
-    while(*pos < list->count && list->tokens[*pos].type != TK_RBRACE){
+    while(*pos < list->count && tokenType(list, *pos) != TK_RBRACE){
         ASTNode statement = parseStatement(list, pos);
         if(statement){
             if(!blockNode->children){
@@ -99,7 +94,7 @@ ASTNode parseBlock(TokenList* list, size_t* pos){
  */
 
 ASTNode parseIf(TokenList* list, size_t* pos){
-    Token* ifToken = &list->tokens[*pos];
+    Token ifToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
     ASTNode conditionalNode, condition, trueBranchWrap, trueBranch, falseBranch = NULL, falseBranchWrap;
@@ -108,16 +103,16 @@ ASTNode parseIf(TokenList* list, size_t* pos){
     EXPECT_TOKEN(list, pos, TK_LBRACE, ERROR_EXPECTED_OPENING_BRACE, "Expected '{' to start 'if' block");
     trueBranch = parseBlock(list, pos);
 
-    if(list->tokens[*pos].type == TK_ELSE){
+    if(tokenType(list, *pos) == TK_ELSE){
         ADVANCE_TOKEN(list, pos);
-        if(list->tokens[*pos].type == TK_IF){
+        if(tokenType(list, *pos) == TK_IF){
             falseBranch = parseIf(list, pos);
         } else {
-            PARSE_OR_CLEANUP(falseBranch, parseBlock(list, pos), condition, trueBranch);
+            PARSE_OR_FAIL(falseBranch, parseBlock(list, pos));
         }
     }
 
-    CREATE_NODE_OR_FAIL(conditionalNode, ifToken, IF_CONDITIONAL, list, pos);
+    CREATE_NODE_OR_FAIL(conditionalNode, &ifToken, IF_CONDITIONAL, list, pos);
     // NULL token means error wont be able to report location of the error
     CREATE_NODE_OR_FAIL(trueBranchWrap, NULL, IF_TRUE_BRANCH, list, pos);
 
@@ -141,14 +136,14 @@ ASTNode parseIf(TokenList* list, size_t* pos){
 
 ASTNode parseLoop(TokenList* list, size_t* pos){
     if(*pos >= list->count) return NULL;
-    Token* loopToken = &list->tokens[*pos];
+    Token loopToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
     ASTNode condition, loopBody, loopNode;
     PARSE_OR_FAIL(condition, parseExpression(list, pos, PREC_NONE));
     EXPECT_TOKEN(list, pos, TK_LBRACE, ERROR_EXPECTED_OPENING_BRACE, "Expected '{' to start loop body");
     PARSE_OR_FAIL(loopBody, parseBlock(list, pos));
-    CREATE_NODE_OR_FAIL(loopNode, loopToken, LOOP_STATEMENT, list, pos);
+    CREATE_NODE_OR_FAIL(loopNode, &loopToken, LOOP_STATEMENT, list, pos);
 
     loopNode->children = condition;
     condition->brothers = loopBody;
@@ -157,7 +152,7 @@ ASTNode parseLoop(TokenList* list, size_t* pos){
 
 ASTNode parseForLoop(TokenList* list, size_t* pos){
     if (*pos >= list->count) return NULL;
-    Token *forToken = &list->tokens[*pos];
+    Token forToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
     ASTNode init = NULL, condition = NULL, increment = NULL;
@@ -182,7 +177,7 @@ ASTNode parseForLoop(TokenList* list, size_t* pos){
         lastChild->brothers = increment;
     }
 
-    CREATE_NODE_OR_FAIL(loopNode,  forToken, LOOP_STATEMENT,  list, pos);
+    CREATE_NODE_OR_FAIL(loopNode,  &forToken, LOOP_STATEMENT,  list, pos);
     loopNode->children  = condition;
     condition->brothers = loopBody;
 
@@ -199,13 +194,13 @@ ASTNode parseForLoop(TokenList* list, size_t* pos){
 
 ASTNode parseReturnStatement(TokenList* list, size_t* pos){
     EXPECT_TOKEN(list, pos, TK_RETURN, ERROR_EXPECTED_RETURN, "Expected 'return' keyword");
-    Token *returnToken = &list->tokens[*pos];
+    Token returnToken = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
     ASTNode returnNode;
-    CREATE_NODE_OR_FAIL(returnNode, returnToken, RETURN_STATEMENT, list, pos);
+    CREATE_NODE_OR_FAIL(returnNode, &returnToken, RETURN_STATEMENT, list, pos);
 
-    if (*pos < list->count && list->tokens[*pos].type != TK_SEMI) {
+    if (*pos < list->count && tokenType(list, *pos) != TK_SEMI) {
         returnNode->children = parseExpression(list, pos, PREC_NONE);
     }
 
@@ -222,10 +217,10 @@ ASTNode parseImport(TokenList *list, size_t *pos) {
     ADVANCE_TOKEN(list, pos);
 
     EXPECT_TOKEN(list, pos, TK_STR,ERROR_EXPECTED_MODULE_PATH, "Expected module path string after 'import'");
-    Token *pathTok = &list->tokens[*pos];
+    Token pathTok = tokenAt(list, *pos);
 
     ASTNode importNode;
-    CREATE_NODE_OR_FAIL(importNode, pathTok, IMPORTDEC, list, pos);
+    CREATE_NODE_OR_FAIL(importNode, &pathTok, IMPORTDEC, list, pos);
     ADVANCE_TOKEN(list, pos);
 
     EXPECT_AND_ADVANCE(list, pos, TK_SEMI, ERROR_EXPECTED_SEMICOLON, "Expected ';' after import");
@@ -234,24 +229,27 @@ ASTNode parseImport(TokenList *list, size_t *pos) {
 
 ASTNode parseExportFunction(TokenList *list, size_t *pos) {
     EXPECT_TOKEN(list, pos, TK_EXPORT, ERROR_EXPECTED_EXPORT, "Expected 'export'");
-    Token *exportTok = &list->tokens[*pos];
+    Token exportTok = tokenAt(list, *pos);
     ADVANCE_TOKEN(list, pos);
 
     ASTNode childNode;
 
-    if (list->tokens[*pos].type == TK_FN) {
+    if (tokenType(list, *pos) == TK_FN) {
         PARSE_OR_FAIL(childNode, parseFunction(list, pos));
     }
-    else if (list->tokens[*pos].type == TK_STRUCT) {
+    else if (tokenType(list, *pos) == TK_STRUCT) {
         PARSE_OR_FAIL(childNode, parseStruct(list, pos));
     }
+    else if (tokenType(list, *pos) == TK_CONST) {
+        PARSE_OR_FAIL(childNode, parseDeclaration(list, pos));
+    }
     else {
-        reportError(ERROR_EXPECTED_FN_AFTER_EXPORT, createErrorContextFromParser(list, pos), "Expected 'fn' or 'struct' after 'export'");
+        reportError(ERROR_EXPECTED_FN_AFTER_EXPORT, createErrorContextFromParser(list, pos), "Expected 'fn', 'struct' or 'const' after 'export'");
         return NULL;
     }
 
     ASTNode exportNode;
-    CREATE_NODE_OR_FAIL(exportNode, exportTok, EXPORTDEC, list, pos);
+    CREATE_NODE_OR_FAIL(exportNode, &exportTok, EXPORTDEC, list, pos);
     exportNode->children = childNode;
     return exportNode;
 }
\ No newline at end of file
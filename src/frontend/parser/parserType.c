@@ -98,11 +98,11 @@ ASTNode parseType(TokenList* list, size_t* pos){
     int isReference = 0;
 
     while(*pos < list->count){
-        Token* token = &list->tokens[*pos];
-        if (token->type == TK_STAR) {
+        Token token = tokenAt(list, *pos);
+        if (token.type == TK_STAR) {
             pointerCount++;
             ADVANCE_TOKEN(list, pos);
-        } else if (token->type == TK_AMPERSAND && !isReference) {
+        } else if (token.type == TK_AMPERSAND && !isReference) {
             isReference = 1;
             ADVANCE_TOKEN(list, pos);
         } else {
@@ -110,19 +110,19 @@ ASTNode parseType(TokenList* list, size_t* pos){
         }
     }
 
-    Token* typeToken = &list->tokens[*pos];
+    Token typeToken = tokenAt(list, *pos);
     ASTNode typeNode;
 
-    if(typeToken->type == TK_STR_WRAP){
+    if(typeToken.type == TK_STR_WRAP){
         pointerCount++;
-        CREATE_NODE_OR_FAIL(typeNode, typeToken, REF_I8, list, pos);
+        CREATE_NODE_OR_FAIL(typeNode, &typeToken, REF_I8, list, pos);
         ADVANCE_TOKEN(list, pos);
-    } else if(isTypeToken(typeToken->type)){
-        NodeTypes baseType = getTypeNodeFromToken(typeToken->type);
-        CREATE_NODE_OR_FAIL(typeNode, typeToken, baseType, list, pos);
+    } else if(isTypeToken(typeToken.type)){
+        NodeTypes baseType = getTypeNodeFromToken(typeToken.type);
+        CREATE_NODE_OR_FAIL(typeNode, &typeToken, baseType, list, pos);
         ADVANCE_TOKEN(list, pos);
-    } else if(detectLitType(typeToken, list, pos) == VARIABLE){
-        CREATE_NODE_OR_FAIL(typeNode, typeToken, REF_CUSTOM, list, pos);
+    } else if(detectLitType(&typeToken, list, pos) == VARIABLE){
+        CREATE_NODE_OR_FAIL(typeNode, &typeToken, REF_CUSTOM, list, pos);
         ADVANCE_TOKEN(list, pos);
     } else {
         reportError(ERROR_EXPECTED_TYPE, createErrorContextFromParser(list, pos), "Expected valid type");
@@ -132,7 +132,7 @@ ASTNode parseType(TokenList* list, size_t* pos){
     /* Wrap in POINTER nodes */
     for(int i = 0; i < pointerCount; ++i){
         ASTNode pointerNode;
-        CREATE_NODE_OR_FAIL(pointerNode, typeToken, POINTER, list, pos);
+        CREATE_NODE_OR_FAIL(pointerNode, &typeToken, POINTER, list, pos);
         pointerNode->children = typeNode;
         typeNode = pointerNode;
     }
@@ -140,7 +140,7 @@ ASTNode parseType(TokenList* list, size_t* pos){
     /* Wrap in MEMADDRS node if its a reference */
     if(isReference){
         ASTNode refNode;
-        CREATE_NODE_OR_FAIL(refNode, typeToken, MEMADDRS, list, pos);
+        CREATE_NODE_OR_FAIL(refNode, &typeToken, MEMADDRS, list, pos);
         refNode->children = typeNode;
         typeNode = refNode;
     }
@@ -13,7 +13,7 @@
 #include "parser.h"
 #include "errorHandling.h"
 
-#define SYMBOL_TABLE_BUCKETS 32
+#define SYMBOL_TABLE_INLINE_BUCKETS 8
 #define SYMBOL_TABLE_LOAD_FACTOR 0.75
 
 struct TypeCheckContext;
@@ -28,6 +28,11 @@ typedef struct StructType *StructType;
 struct Symbol;
 typedef struct Symbol *Symbol;
 
+struct ScopeStack;
+typedef struct ScopeStack *ScopeStack;
+
+struct ThreadPool;
+
 typedef enum {
     TYPE_I8,
     TYPE_I16,
@@ -78,9 +83,25 @@ typedef struct {
     StructType structType;
 } ResolvedType;
 
+/**
+ * @brief A value known at compile time.
+ *
+ * Integers are held sign or zero extended from the width of their type,
+ * bools as 0 or 1, floats already rounded to float. TYPE_UNKNOWN means the
+ * value is not a constant.
+ */
+typedef struct ConstValue {
+    DataType type;
+    union {
+        int64_t intVal;
+        double floatVal;
+    };
+} ConstValue;
+
 typedef struct StructField {
     const char *nameStart;
     size_t nameLength;
+    NameId name;
     DataType type;
     StructType structType;
     int isPointer;
@@ -100,6 +121,7 @@ typedef struct StructType {
 typedef struct FunctionParameter {
     const char *nameStart;
     size_t nameLength;
+    NameId name;
     DataType type;
     int isPointer;
     int pointerLevel;
@@ -112,6 +134,7 @@ typedef struct FunctionParameter {
 typedef struct Symbol {
     const char *nameStart;
     uint16_t nameLength;
+    NameId name;            // hash key, symbols match when their ids do
     SymbolType symbolType;
     DataType type;
     StructType structType;
@@ -122,88 +145,165 @@ typedef struct Symbol {
             int paramCount;
             int returnsPointer;
             int returnPointerLevel;
-            SymbolTable functionScope;
             DataType returnBaseType;
+            SymbolTable functionScope;
+            ASTNode definition;     // FUNCTION_DEFINITION in this module, NULL if imported or built in
         };
         struct {
             int isInitialized;
             int isConst;
             int isArray;
             int staticSize;
-            int constVal;
-            int hasConstVal;
+            ConstValue constValue;  // type TYPE_UNKNOWN unless a const with a compile-time value
+            int isExported;         // exported const, every read is folded so it has no storage
             int hasConstMemRef;
             int isPointer;
             int pointerLvl;
             DataType baseType;
         };
     };
-    int line;
-    int column;
+    const char *declaredAt;     // declaring token in the module source, NULL if imported or built in
     int scope;
     struct Symbol *next;
+    struct Symbol *shadowed;    // outer binding of the same name while the scope is on a ScopeStack
 } *Symbol;
 
 /**
  * @brief Symbol table structure for managing symbols within a scope.
+ *
+ * Most block scopes hold a handful of names, so buckets start inline and
+ * move to the arena only when the table grows past them.
+ *
+ * A module's global table also reads through its prelude: frozen tables of
+ * the built-ins and of each imported interface, built once and shared by
+ * every module that sees them. They count as part of the table itself.
  */
 typedef struct SymbolTable {
-    Symbol *symbols;
+    Symbol *symbols;            // inlineBuckets until the first rehash
     int bucketCount;
+    struct Arena *arena;        // the module's semantic arena, shared by every table
     struct SymbolTable *parent;
-    struct SymbolTable *child;
-    struct SymbolTable *brother;
     int scope;
     int symbolCount;
+    ScopeStack stack;           // the stack this table is on, NULL when it is not active
+    struct SymbolTable **prelude; // frozen tables read after this one, first match wins
+    int preludeCount;
+    int preludeCapacity;
+    Symbol inlineBuckets[SYMBOL_TABLE_INLINE_BUCKETS];
 } *SymbolTable;
 
-typedef struct BlockScopeNode {
-    SymbolTable scope;
-    struct BlockScopeNode *next;
-} *BlockScopeNode;
+/**
+ * @brief The active scopes flattened into one table.
+ *
+ * Holds the current SymbolTable and every parent of it. Each name maps to
+ * its innermost visible symbol, which links to the ones it shadows, so a
+ * lookup from the top scope is a single probe however deep the nesting.
+ * Scopes are pushed and popped by setCurrentScope().
+ *
+ * A stack may stand on a base table it only reads: names missing from the
+ * bindings are looked up there, so several stacks can share the module's
+ * globals without writing to them.
+ */
+typedef struct ScopeStack {
+    NameId *names;              // open addressing, NAME_NONE marks a free slot
+    Symbol *bindings;           // innermost symbol for names[i], NULL once its scopes are gone
+    uint32_t capacity;          // power of two
+    uint32_t used;
+    SymbolTable top;
+    SymbolTable base;           // bottom of the stack, never pushed, NULL if none
+    const char *visibleBefore;  // base symbols declared after this are hidden, NULL shows all
+    SymbolTable preluded;       // pushed table whose prelude answers the names nothing binds
+} *ScopeStack;
+
+/**
+ * @brief What the type checker resolved for one AST node.
+ *
+ * A node's info field indexes the context's table of these, 0 meaning it
+ * was never annotated. Expressions get their type, identifiers, calls and
+ * declarations the symbol they bind to, so IR generation reads the results
+ * instead of inferring types and resolving names a second time.
+ */
+typedef struct NodeInfo {
+    DataType type;              // TYPE_UNKNOWN unless the node is an expression
+    int pointerLevel;
+    StructType structType;
+    Symbol symbol;
+} NodeInfo;
 
 /**
  * @brief Type checking context for managing symbol tables and scope.
+ *
+ * Symbols, tables, parameters and struct types of a module are all carved
+ * from arena and released together with it.
+ *
+ * With a pool, typeCheckAST() checks the bodies of top-level functions on
+ * it once every global declaration is known (see semanticCore.c).
  */
 typedef struct TypeCheckContext {
+    struct Arena *arena;
     SymbolTable current;
     SymbolTable global;
     Symbol currentFunction;
-    const char *sourceFile;
+    SourceFile *source;         // for line and column of diagnostics, may be NULL
+    ASTContext *ast;            // expands deferred function bodies, NULL if none were deferred
+    ScopeStack scopes;          // current and its parents, for one-probe lookups
     const char *filename;
-    BlockScopeNode blockScopesHead;
-    BlockScopeNode blockScopesTail;
+    NodeInfo *annotations;      // indexed by ASTNode.info, slot 0 unused
+    uint32_t annotationCount;
+    uint32_t annotationCapacity;
+    ASTNode *annotatedNodes;    // node of each slot, kept only while checking bodies apart
+    struct ThreadPool *pool;    // checks function bodies in parallel, NULL checks them in turn
 } *TypeCheckContext;
 
 /* Entry point */
 
-TypeCheckContext typeCheckAST(ASTNode ast, const char *sourceCode,
+TypeCheckContext typeCheckAST(ASTNode ast, SourceFile *source,
                               const char *filename, TypeCheckContext ref);
-TypeCheckContext createTypeCheckContext(const char *sourceCode, const char *filename);
+TypeCheckContext createTypeCheckContext(SourceFile *source, const char *filename);
 void freeTypeCheckContext(TypeCheckContext context);
 
 /* Symbol table */
 
-SymbolTable createSymbolTable(SymbolTable parent);
-void freeSymbolTable(SymbolTable symbolTable);
-void freeSymbol(Symbol symbol);
+SymbolTable createSymbolTable(struct Arena *arena, SymbolTable parent);
 
-Symbol addSymbol(SymbolTable table, const char *nameStart, size_t nameLength, DataType type, int line, int column);
+Symbol addSymbol(SymbolTable table, NameId name, DataType type, const char *declaredAt);
 Symbol addSymbolFromNode(SymbolTable table, ASTNode node, DataType type);
 
 Symbol addFunctionSymbolFromNode(SymbolTable symbolTable, ASTNode node, DataType returnType, FunctionParameter parameters, int paramCount);
-Symbol addFunctionSymbolFromString(SymbolTable symbolTable, const char *name, DataType returnType, FunctionParameter parameters, int paramCount, int line, int column);
+Symbol addFunctionSymbolFromString(SymbolTable symbolTable, const char *name, DataType returnType, FunctionParameter parameters, int paramCount, const char *declaredAt);
 
-Symbol lookupSymbol(SymbolTable symbolTable, const char *name, size_t len);
-Symbol lookupSymbolCurrentOnly(SymbolTable table, const char *nameStart, size_t nameLength);
+Symbol lookupSymbol(SymbolTable symbolTable, NameId name);
+Symbol lookupSymbolCurrentOnly(SymbolTable table, NameId name);
 
-FunctionParameter createParameter(const char *nameStart, size_t nameLen, DataType type);
-void freeParamList(FunctionParameter paramList);
+/**
+ * @brief Read frozen under table, after table's own symbols and its earlier prelude tables
+ *
+ * Nothing is copied and frozen is never written to, it must outlive table.
+ */
+int addPreludeTable(SymbolTable table, SymbolTable frozen);
+
+FunctionParameter createParameter(struct Arena *arena, const char *nameStart, size_t nameLen, DataType type);
 
 /* Symbol resolution */
 
 DataType getDataTypeFromNode(NodeTypes nodeType);
 
+/* Node annotations, filled in by typeCheckAST */
+
+const NodeInfo *nodeInfo(TypeCheckContext context, ASTNode node);
+Symbol nodeSymbol(TypeCheckContext context, ASTNode node);
+DataType nodeDataType(TypeCheckContext context, ASTNode node);
+
+/* Constant evaluation */
+
+/**
+ * @brief Value of a type checked expression, type TYPE_UNKNOWN if it is not constant
+ *
+ * Calls to functions of the module are run only outside function bodies.
+ */
+ConstValue evaluateConstant(TypeCheckContext context, ASTNode node, DataType expectedType);
+ConstValue convertConstant(ConstValue value, DataType type);
+
 /* Type system */
 
 CompatResult areCompatible(DataType target, DataType source);
@@ -218,12 +318,21 @@ NodeTypes symbolTypeToNodeType(DataType type);
 
 /* Scope management */
 
-void enqueueBlockScope(TypeCheckContext context, SymbolTable scope);
-SymbolTable dequeueBlockScope(TypeCheckContext context);
+ScopeStack createScopeStack(void);
+void freeScopeStack(ScopeStack stack);
+
+/**
+ * @brief Make table the current scope, syncing the scope stack to its chain.
+ *
+ * Scopes that are not ancestors of table are popped and the missing ones
+ * pushed, so the type checker can move between scopes freely.
+ */
+void setCurrentScope(TypeCheckContext context, SymbolTable table);
 
 /* Built ins */
 
-void initBuiltIns(SymbolTable globalTable);
+/** @brief Frozen table of the built-in functions, built on first use and kept for the process */
+SymbolTable builtInSymbols(void);
 BuiltInId resolveOverload(const char *nameStart, size_t nameLength, DataType arg[], int argCount);
 int isBuiltinFunction(const char *nameStart, size_t nameLength);
 
@@ -237,7 +346,7 @@ int typeCheckChildren(ASTNode node, TypeCheckContext context, DataType expectedT
 int validateFunctionDef(ASTNode node, TypeCheckContext context);
 int validateFunctionCall(ASTNode node, TypeCheckContext context);
 int validateReturnStatement(ASTNode node, TypeCheckContext context);
-FunctionParameter extractParameters(ASTNode paramListNode);
+FunctionParameter extractParameters(struct Arena *arena, ASTNode paramListNode);
 DataType getReturnTypeFromNode(ASTNode returnTypeNode, int *outPointerLevel);
 int validateBuiltinFunctionCall(ASTNode node, TypeCheckContext context);
 int validateUserDefinedFunctionCall(ASTNode node, TypeCheckContext context);
@@ -5,7 +5,7 @@
  * Responsibilities:
  *   - Static built-in function table (defined ONLY here)
  *   - Built-in parameter initialization
- *   - Populating the initial global symbol table with built-ins
+ *   - The shared, frozen symbol table of built-ins every global scope reads through
  *   - Overload resolution for built-in functions
  *   - Built-in function name checking
  *
@@ -13,6 +13,12 @@
  */
 
 #include "semanticInternal.h"
+#include "memTrack.h"
+#include "arena.h"
+
+#include <pthread.h>
+
+#define BUILTIN_ARENA_CHUNK 1024
 
 static BuiltInFunction builtInFunctions[] = {
     {
@@ -32,7 +38,7 @@ static int builtInsInit = 0;
 static void initBuiltInsParams(void) {
     if (builtInsInit) return;
 
-    builtInFunctions[0].paramTypes = malloc(sizeof(DataType) * 7);
+    builtInFunctions[0].paramTypes = trackedMalloc(MEM_SEMANTIC, sizeof(DataType) * 7);
     builtInFunctions[0].paramTypes[0] = TYPE_I64;
     builtInFunctions[0].paramTypes[1] = TYPE_I64;
     builtInFunctions[0].paramTypes[2] = TYPE_I64;
@@ -41,30 +47,27 @@ static void initBuiltInsParams(void) {
     builtInFunctions[0].paramTypes[5] = TYPE_I64;
     builtInFunctions[0].paramTypes[6] = TYPE_I64;
 
-    builtInFunctions[0].paramNames = malloc(sizeof(char *) * 7);
-    builtInFunctions[0].paramNames[0] = strdup("a");
-    builtInFunctions[0].paramNames[1] = strdup("b");
-    builtInFunctions[0].paramNames[2] = strdup("c");
-    builtInFunctions[0].paramNames[3] = strdup("d");
-    builtInFunctions[0].paramNames[4] = strdup("e");
-    builtInFunctions[0].paramNames[5] = strdup("f");
-    builtInFunctions[0].paramNames[6] = strdup("g");
+    builtInFunctions[0].paramNames = trackedMalloc(MEM_SEMANTIC, sizeof(char *) * 7);
+    builtInFunctions[0].paramNames[0] = trackedStrdup(MEM_SEMANTIC, "a");
+    builtInFunctions[0].paramNames[1] = trackedStrdup(MEM_SEMANTIC, "b");
+    builtInFunctions[0].paramNames[2] = trackedStrdup(MEM_SEMANTIC, "c");
+    builtInFunctions[0].paramNames[3] = trackedStrdup(MEM_SEMANTIC, "d");
+    builtInFunctions[0].paramNames[4] = trackedStrdup(MEM_SEMANTIC, "e");
+    builtInFunctions[0].paramNames[5] = trackedStrdup(MEM_SEMANTIC, "f");
+    builtInFunctions[0].paramNames[6] = trackedStrdup(MEM_SEMANTIC, "g");
 
     builtInsInit = 1;
 }
 
-static FunctionParameter createParameterList(char **names, DataType *types, int count) {
+static FunctionParameter createParameterList(Arena *arena, char **names, DataType *types, int count) {
     if (count == 0) return NULL;
 
     FunctionParameter first = NULL;
     FunctionParameter last = NULL;
 
     for (int i = 0; i < count; i++) {
-        FunctionParameter param = createParameter(names[i], strlen(names[i]), types[i]);
-        if (param == NULL) {
-            freeParamList(first);
-            return NULL;
-        }
+        FunctionParameter param = createParameter(arena, names[i], strlen(names[i]), types[i]);
+        if (param == NULL) return NULL;
 
         if (first == NULL) {
             first = param;
@@ -79,28 +82,44 @@ static FunctionParameter createParameterList(char **names, DataType *types, int
 
 /* Public */
 
-void initBuiltIns(SymbolTable globTable) {
-    if (globTable == NULL) return;
+static SymbolTable builtInTable = NULL;
+static pthread_once_t builtInTableOnce = PTHREAD_ONCE_INIT;
 
+/* Never freed, like the parameter arrays it is built from */
+static void buildBuiltInTable(void) {
     initBuiltInsParams();
 
+    Arena *arena = createArena(MEM_SEMANTIC, BUILTIN_ARENA_CHUNK);
+    SymbolTable table = arena ? createSymbolTable(arena, NULL) : NULL;
+    if (table == NULL) {
+        freeArena(arena);
+        return;
+    }
+
     for (int i = 0; i < builtInFnCount; i++) {
         BuiltInFunction *builtin = &builtInFunctions[i];
 
         FunctionParameter params = createParameterList(
+            arena,
             builtin->paramNames,
             builtin->paramTypes,
             builtin->paramCount
         );
         addFunctionSymbolFromString(
-            globTable,
+            table,
             builtin->name,
             builtin->returnType,
             params,
             builtin->paramCount,
-            0, 0
+            NULL
         );
     }
+    builtInTable = table;
+}
+
+SymbolTable builtInSymbols(void) {
+    pthread_once(&builtInTableOnce, buildBuiltInTable);
+    return builtInTable;
 }
 
 BuiltInId resolveOverload(const char *nameStart, size_t nameLength, DataType arg[], int argCount) {
@@ -18,6 +18,8 @@
  */
 
 #include "semanticInternal.h"
+#include "memTrack.h"
+#include "arena.h"
 
 #include <assert.h>
 
@@ -74,23 +76,12 @@ int validateArrayAccessNode(ASTNode arrayAccess, TypeCheckContext context) {
     }
     
     if (arraySym->isArray) {
-        int hasConstIndex = 0;
-        int indexValue = 0;
-
-        if (indexNode->nodeType == LITERAL) {
-            hasConstIndex = 1;
-            indexValue = parseInt(indexNode->start, indexNode->length);
-        } else if (indexNode->nodeType == VARIABLE) {
-            Symbol idxSym = lookupSymbol(context->current, indexNode->start, indexNode->length);
-            if (idxSym && idxSym->isConst && idxSym->hasConstVal) {
-                hasConstIndex = 1;
-                indexValue = idxSym->constVal;
-            }
-        }
+        ConstValue index = evaluateConstant(context, indexNode, TYPE_I32);
+        int64_t indexValue = isUnsignedInt(index.type) && index.intVal < 0 ? INT64_MAX : index.intVal;
 
-        if (hasConstIndex && (indexValue < 0 || indexValue >= arraySym->staticSize)) {
+        if (index.type != TYPE_UNKNOWN && (indexValue < 0 || indexValue >= arraySym->staticSize)) {
             char msg[100];
-            snprintf(msg, sizeof(msg), "Array index %d out of bounds [0, %d)", indexValue, arraySym->staticSize);
+            snprintf(msg, sizeof(msg), "Array index %lld out of bounds [0, %d)", (long long)indexValue, arraySym->staticSize);
             REPORT_ERROR(ERROR_INVALID_EXPRESSION, indexNode, context, msg);
             return 0;
         }
@@ -135,7 +126,7 @@ int validateArrayLiteralInit(ASTNode arrLitNode, DataType expectedType, int expe
 }
 
 int validateArrayCopyInit(ASTNode sourceVarNode, Symbol targetSym, TypeCheckContext context) {
-    Symbol sourceSym = lookupSymbol(context->current, sourceVarNode->start, sourceVarNode->length);
+    Symbol sourceSym = resolveSymbol(context, sourceVarNode);
 
     if (!sourceSym) {
         reportErrorWithText(ERROR_UNDEFINED_VARIABLE, sourceVarNode, context, "Undefined variable");
@@ -183,6 +174,14 @@ int validateAddressOf(ASTNode addrNode, TypeCheckContext context) {
         return 0;
     }
 
+    // Imported and exported consts are only their value, nothing is stored to point at
+    Symbol sym = addrNode->nodeType == VARIABLE ? resolveSymbol(context, addrNode) : NULL;
+    if (sym && sym->symbolType == SYMBOL_VARIABLE && sym->isConst &&
+        (!sym->declaredAt || sym->isExported)) {
+        REPORT_ERROR(ERROR_CANNOT_TAKE_ADDRESS_OF_LITERAL, addrNode, context, "Cannot take address of exported const");
+        return 0;
+    }
+
     return 1;
 }
 
@@ -190,14 +189,14 @@ void updateConstMemRef(Symbol targetSymbol, ASTNode sourceNode, TypeCheckContext
     if (!targetSymbol) return;
 
     if (sourceNode->nodeType == VARIABLE) {
-        Symbol sourceSym = lookupSymbol(context->current, sourceNode->start, sourceNode->length);
+        Symbol sourceSym = resolveSymbol(context, sourceNode);
         if (sourceSym) {
             targetSymbol->hasConstMemRef = sourceSym->isConst || sourceSym->hasConstMemRef;
         }
     } else if (sourceNode->nodeType == ARRAY_ACCESS) {
         ASTNode baseNode = sourceNode->children;
         if (baseNode && baseNode->nodeType == VARIABLE) {
-            Symbol baseSym = lookupSymbol(context->current, baseNode->start, baseNode->length);
+            Symbol baseSym = resolveSymbol(context, baseNode);
             if (baseSym && baseSym->isConst) {
                 targetSymbol->hasConstMemRef = 1;
             }
@@ -279,7 +278,7 @@ static size_t alignTo(size_t offset, size_t alignment) {
 
 StructType createStructType(ASTNode node, TypeCheckContext context) {
     if (!node || node->nodeType != STRUCT_DEFINITION) return NULL;
-    StructType structType = malloc(sizeof(struct StructType));
+    StructType structType = arenaAlloc(context->arena, sizeof(struct StructType));
     if (!structType) {
         repError(ERROR_MEMORY_ALLOCATION_FAILED, "failed to create struct type");
         return NULL;
@@ -290,7 +289,7 @@ StructType createStructType(ASTNode node, TypeCheckContext context) {
     structType->fieldCount = 0;
     structType->size = 0;
 
-    Symbol selfSym = lookupSymbolCurrentOnly(context->current, node->start, node->length);
+    Symbol selfSym = lookupSymbolCurrentOnly(context->current, node->name);
     if(selfSym){
         selfSym->structType = structType;
     }
@@ -303,32 +302,25 @@ StructType createStructType(ASTNode node, TypeCheckContext context) {
         while (field) {
             /* todo: bring struct field validation logic to his own function */
             if (field->nodeType == STRUCT_FIELD && field->children) {
-                StructField structField = malloc(sizeof(struct StructField));
-                if (!structField) {
-                    free(structType);
-                    free(structField);
-                    return NULL;
-                }
+                StructField structField = arenaAlloc(context->arena, sizeof(struct StructField));
+                if (!structField) return NULL;
                 int pointerLevel = 0;
                 ASTNode baseTypeNode = getBaseTypeFromPointerChain(field->children->children, &pointerLevel);
                 DataType type = getDataTypeFromNode(baseTypeNode->nodeType);
                 structField->nameStart = field->start;
                 structField->nameLength = field->length;
+                structField->name = field->name;
                 structField->type = type;
                 if (type == TYPE_STRUCT) {
-                    Symbol structSymbol = lookupSymbol(context->current, field->children->children->start, field->children->children->length);
+                    Symbol structSymbol = resolveSymbol(context, field->children->children);
                     if (!structSymbol || structSymbol->symbolType != SYMBOL_TYPE) {
                         REPORT_ERROR(ERROR_UNDEFINED_SYMBOL, field->children, context, "Undefined struct type in field declaration");
-                        free(structField);
-                        free(structType);
                         return NULL;
                     }
                     structField->structType = structSymbol->structType;
 
                     if(pointerLevel == 0 && structSymbol->structType == structType){
                         REPORT_ERROR(ERROR_INVALID_EXPRESSION, field->children, context, "Struct cannot contain itself directly");
-                        free(structField);
-                        free(structType);
                         return NULL;
                     }
                 }
@@ -348,10 +340,8 @@ StructType createStructType(ASTNode node, TypeCheckContext context) {
 
                 StructField check = structType->fields;
                 while (check) {
-                    if (check->nameLength == structField->nameLength &&
-                        memcmp(check->nameStart, structField->nameStart, check->nameLength) == 0) {
+                    if (check->name == structField->name) {
                         REPORT_ERROR(ERROR_VARIABLE_REDECLARED, node, context, "duplicate field on struct");
-                        free(structField);
                         return NULL;
                     }
                     check = check->next;
@@ -381,16 +371,17 @@ StructType createStructType(ASTNode node, TypeCheckContext context) {
 int validateStructDef(ASTNode node, TypeCheckContext context) {
     if (!node || node->nodeType != STRUCT_DEFINITION) return 0;
 
-    Symbol exists = lookupSymbolCurrentOnly(context->current, node->start, node->length);
+    Symbol exists = lookupSymbolCurrentOnly(context->current, node->name);
     if (exists) {
         char *tempText = extractText(node->start, node->length);
         REPORT_ERROR(ERROR_VARIABLE_REDECLARED, node, context, tempText);
-        free(tempText);
+        trackedFree(MEM_SEMANTIC, tempText);
         return 0;
     }
 
     Symbol structSymbol = addSymbolFromNode(context->current, node, TYPE_STRUCT);
     if(!structSymbol) return 0;
+    annotateSymbol(context, node, structSymbol);
 
     structSymbol->symbolType = SYMBOL_TYPE;
     structSymbol->structType = NULL;
@@ -414,17 +405,17 @@ int validateStructVarDec(ASTNode node, TypeCheckContext context) {
         return 0;
     }
 
-    Symbol structSymbol = lookupSymbol(context->current, typeRef->start, typeRef->length);
+    Symbol structSymbol = resolveSymbol(context, typeRef);
     if (!structSymbol) {
         REPORT_ERROR(ERROR_UNDEFINED_VARIABLE, node, context, "Undefined struct type");
         return 0;
     }
 
-    Symbol exists = lookupSymbolCurrentOnly(context->current, node->start, node->length);
+    Symbol exists = lookupSymbolCurrentOnly(context->current, node->name);
     if (exists) {
         char *tempText = extractText(node->start, node->length);
         REPORT_ERROR(ERROR_VARIABLE_REDECLARED, node, context, tempText);
-        free(tempText);
+        trackedFree(MEM_SEMANTIC, tempText);
         return 0;
     }
 
@@ -433,6 +424,7 @@ int validateStructVarDec(ASTNode node, TypeCheckContext context) {
         repError(ERROR_SYMBOL_TABLE_CREATION_FAILED, "Failed to add struct vairable to symbol table");
         return 0;
     }
+    annotateSymbol(context, node, symbol);
 
     symbol->structType = structSymbol->structType;
     if (typeRef->brothers) {
@@ -452,7 +444,7 @@ int validateScalarInitialization(Symbol newSymbol, ASTNode node, DataType varTyp
         node->children->brothers->children;
 
     if (initExpr && initExpr->nodeType == VARIABLE) {
-        Symbol initSymbol = lookupSymbol(context->current, initExpr->start, initExpr->length);
+        Symbol initSymbol = resolveSymbol(context, initExpr);
 
         if (initSymbol) {
             if (initSymbol->isArray) {
@@ -495,7 +487,7 @@ int validateScalarInitialization(Symbol newSymbol, ASTNode node, DataType varTyp
 
     /* Pointer level validation */
     if (newSymbol->isPointer && initExpr->nodeType == VARIABLE) {
-        Symbol initSym = lookupSymbol(context->current, initExpr->start, initExpr->length);
+        Symbol initSym = resolveSymbol(context, initExpr);
         if (initSym && !validatePointerLevels(newSymbol, initSym, node, context, isMemRef)) {
             return 0;
         }
@@ -504,10 +496,8 @@ int validateScalarInitialization(Symbol newSymbol, ASTNode node, DataType varTyp
     newSymbol->isInitialized = 1;
 
     /* Track constant values for compile-time evaluation */
-    if (isConst && node->children->brothers->children->nodeType == LITERAL) {
-        newSymbol->hasConstVal = 1;
-        newSymbol->constVal = parseInt(node->children->brothers->children->start,
-                                    node->children->brothers->children->length);
+    if (isConst && !newSymbol->isPointer) {
+        newSymbol->constValue = convertConstant(evaluateConstant(context, initExpr, varType), varType);
     }
 
     return 1;
@@ -541,7 +531,7 @@ int validateVariableDeclaration(ASTNode node, TypeCheckContext context, int isCo
         repError(ERROR_INTERNAL_PARSER_ERROR, "Unknown variable type in declaration");
         return 0;
     } else if (varType == TYPE_STRUCT) {
-        structSymbol = lookupSymbol(context->current, typeref->start, typeref->length);
+        structSymbol = resolveSymbol(context, typeref);
         if (structSymbol == NULL || structSymbol->symbolType != SYMBOL_TYPE) {
             REPORT_ERROR(ERROR_UNDEFINED_SYMBOL, typeref, context,
                         "Undefined struct type in variable declaration");
@@ -550,7 +540,7 @@ int validateVariableDeclaration(ASTNode node, TypeCheckContext context, int isCo
     }
 
     /* Check for redeclaration */
-    Symbol existing = lookupSymbolCurrentOnly(context->current, node->start, node->length);
+    Symbol existing = lookupSymbolCurrentOnly(context->current, node->name);
     if (existing != NULL) {
         reportErrorWithText(ERROR_VARIABLE_REDECLARED, node, context, "Variable redeclared");
         return 0;
@@ -562,6 +552,7 @@ int validateVariableDeclaration(ASTNode node, TypeCheckContext context, int isCo
         repError(ERROR_SYMBOL_TABLE_CREATION_FAILED, "Failed to add symbol");
         return 0;
     }
+    annotateSymbol(context, node, newSymbol);
 
     if (varType == TYPE_STRUCT && structSymbol) {
         newSymbol->structType = structSymbol->structType;
@@ -580,25 +571,28 @@ int validateVariableDeclaration(ASTNode node, TypeCheckContext context, int isCo
     /* Handle array-specific validation */
     if (isArr) {
         ASTNode sizeNode = node->children->brothers;
-        if (!sizeNode || (sizeNode->nodeType != LITERAL && sizeNode->nodeType != VARIABLE)) {
+        if (!sizeNode) {
             REPORT_ERROR(ERROR_ARRAY_SIZE_INVALID_SPEC, node, context,
                         "invalid static size for array");
             return 0;
         }
 
-        int arraySize;
-        if (sizeNode->nodeType == LITERAL) {
-            arraySize = parseInt(sizeNode->start, sizeNode->length);
-        } else {
-            Symbol sizeSym = lookupSymbol(context->current, sizeNode->start, sizeNode->length);
-            if (isConst && (!sizeSym || !sizeSym->isConst || !sizeSym->hasConstVal)) {
-                REPORT_ERROR(ERROR_ARRAY_SIZE_NOT_CONSTANT, sizeNode, context,
-                            "Array size must be compile-time constant");
-                return 0;
-            }
-            arraySize = sizeSym->constVal;
+        DataType sizeType = getExpressionType(sizeNode, context, TYPE_I32);
+        if (sizeType == TYPE_UNKNOWN) return 0;
+        if (!isIntegerType(sizeType)) {
+            REPORT_ERROR(ERROR_ARRAY_SIZE_NOT_INTEGER, sizeNode, context,
+                        "Array size must be an integer");
+            return 0;
         }
 
+        ConstValue size = evaluateConstant(context, sizeNode, sizeType);
+        if (size.type == TYPE_UNKNOWN) {
+            REPORT_ERROR(ERROR_ARRAY_SIZE_NOT_CONSTANT, sizeNode, context,
+                        "Array size must be compile-time constant");
+            return 0;
+        }
+
+        int arraySize = size.intVal > INT32_MAX || size.intVal < 0 ? 0 : (int)size.intVal;
         if (arraySize <= 0) {
             REPORT_ERROR(ERROR_ARRAY_SIZE_NOT_POSITIVE, sizeNode, context,
                         "Array size must be positive");
@@ -672,7 +666,7 @@ int validateAssignment(ASTNode node, TypeCheckContext context) {
 
         /* Case 1: *ptr where ptr is a variable */
         if (derefTarget->nodeType == VARIABLE) {
-            Symbol ptrSym = lookupSymbol(context->current, derefTarget->start, derefTarget->length);
+            Symbol ptrSym = resolveSymbol(context, derefTarget);
             if (checkConstViolation(ptrSym, node, context, isPointerDeref)) {
                 return 0;
             }
@@ -682,7 +676,7 @@ int validateAssignment(ASTNode node, TypeCheckContext context) {
             ASTNode arrayNode = derefTarget->children;
             if (arrayNode && arrayNode->nodeType == VARIABLE) {
                 Symbol arraySym =
-                    lookupSymbol(context->current, arrayNode->start, arrayNode->length);
+                    resolveSymbol(context, arrayNode);
                 if (arraySym && arraySym->isConst) {
                     REPORT_ERROR(ERROR_CONSTANT_REASSIGNMENT, node, context, "Cannot modify through const array element");
                     return 0;
@@ -725,7 +719,7 @@ int validateAssignment(ASTNode node, TypeCheckContext context) {
 
         /* Check for array assignment issues */
         if (right->nodeType == VARIABLE) {
-            Symbol rightSym = lookupSymbol(context->current, right->start, right->length);
+            Symbol rightSym = resolveSymbol(context, right);
             if (rightSym) {
                 /* Scalar = Array (error) */
                 if (!sym->isArray && rightSym->isArray) {
@@ -753,7 +747,7 @@ int validateAssignment(ASTNode node, TypeCheckContext context) {
 
         /* Additional const checking for array access */
         ASTNode baseNode = left->children;
-        Symbol arraySym = lookupSymbol(context->current, baseNode->start, baseNode->length);
+        Symbol arraySym = resolveSymbol(context, baseNode);
         if (arraySym) {
             if (arraySym->isConst) {
                 reportErrorWithText(ERROR_CONSTANT_REASSIGNMENT, node, context, "Cannot modify const array");
@@ -790,7 +784,7 @@ int validateAssignment(ASTNode node, TypeCheckContext context) {
 
     /* Handle address-of with const tracking */
     if (left->nodeType == VARIABLE && right->nodeType == MEMADDRS) {
-        Symbol leftSym = lookupSymbol(context->current, left->start, left->length);
+        Symbol leftSym = resolveSymbol(context, left);
         if (leftSym) {
             updateConstMemRef(leftSym, right->children, context);
         }
@@ -798,13 +792,14 @@ int validateAssignment(ASTNode node, TypeCheckContext context) {
 
     /* Mark variable as initialized and handle pointer level validation */
     if (left->nodeType == VARIABLE) {
-        Symbol symbol = lookupSymbol(context->current, left->start, left->length);
+        Symbol symbol = resolveSymbol(context, left);
         if (symbol && node->nodeType == ASSIGNMENT) {
-            symbol->isInitialized = 1;
+            // Globals are shared by every body being checked, only write a change
+            if (!symbol->isInitialized) symbol->isInitialized = 1;
 
             /* Pointer level validation */
             if (symbol->isPointer && right->nodeType == VARIABLE) {
-                Symbol rightSym = lookupSymbol(context->current, right->start, right->length);
+                Symbol rightSym = resolveSymbol(context, right);
                 if (rightSym && rightSym->isPointer) {
                     if (symbol->pointerLvl != rightSym->pointerLvl) {
                         char msg[100];
@@ -829,18 +824,18 @@ int validateVariableUsage(ASTNode node, TypeCheckContext context) {
         return 0;
     };
 
-    Symbol symbol = lookupSymbol(context->current, node->start, node->length);
+    Symbol symbol = resolveSymbol(context, node);
     if (symbol == NULL) {
         char *tempText = extractText(node->start, node->length);
         REPORT_ERROR(ERROR_UNDEFINED_VARIABLE, node, context, tempText);
-        free(tempText);
+        trackedFree(MEM_SEMANTIC, tempText);
         return 0;
     }
 
     if (!symbol->isInitialized) {
         char *tempText = extractText(node->start, node->length);
         REPORT_ERROR(ERROR_VARIABLE_NOT_INITIALIZED, node, context, tempText);
-        free(tempText);
+        trackedFree(MEM_SEMANTIC, tempText);
         return 0;
     }
 
@@ -851,7 +846,7 @@ int validateVariableUsage(ASTNode node, TypeCheckContext context) {
  * Functions
  */
 
-FunctionParameter extractParameters(ASTNode paramListNode) {
+FunctionParameter extractParameters(Arena *arena, ASTNode paramListNode) {
     if (paramListNode == NULL || paramListNode->nodeType != PARAMETER_LIST) return NULL;
 
     FunctionParameter firstParam = NULL;
@@ -871,7 +866,7 @@ FunctionParameter extractParameters(ASTNode paramListNode) {
             DataType paramType = getDataTypeFromNode(baseTypeNode->nodeType);
 
             if (paramType == TYPE_STRUCT) {
-                Symbol structSym = lookupSymbol(NULL, baseTypeNode->start, baseTypeNode->length);
+                Symbol structSym = lookupSymbol(NULL, baseTypeNode->name);
                 if (structSym && structSym->symbolType == SYMBOL_TYPE) {
                     paramType = TYPE_STRUCT;
                 } else {
@@ -880,11 +875,8 @@ FunctionParameter extractParameters(ASTNode paramListNode) {
                 }
             }
 
-            FunctionParameter param = createParameter(paramNode->start, paramNode->length, paramType);
-            if (param == NULL) {
-                freeParamList(firstParam);
-                return NULL;
-            }
+            FunctionParameter param = createParameter(arena, paramNode->start, paramNode->length, paramType);
+            if (param == NULL) return NULL;
             param->isPointer = (pointerLevel > 0);
             param->pointerLevel = pointerLevel;
             if (pointerLevel > 0) {
@@ -916,22 +908,25 @@ int containsReturnStatement(ASTNode node) {
     return 0;
 }
 
-int validateFunctionDef(ASTNode node, TypeCheckContext context) {
+/*
+ * Registers the function with its parameters and return type in the current
+ * scope. The body is left to validateFunctionBody().
+ */
+Symbol declareFunction(ASTNode node, TypeCheckContext context) {
     if (node == NULL || node->nodeType != FUNCTION_DEFINITION || node->start == NULL || node->children == NULL) {
         repError(ERROR_INTERNAL_PARSER_ERROR, "Invalid function definition node");
-        return 0;
+        return NULL;
     }
 
     ASTNode paramListNode = node->children;
     ASTNode returnTypeNode = paramListNode ? paramListNode->brothers : NULL;
-    ASTNode bodyNode = returnTypeNode ? returnTypeNode->brothers : NULL;
 
     if (paramListNode == NULL || paramListNode->nodeType != PARAMETER_LIST) {
         repError(ERROR_INTERNAL_PARSER_ERROR, "Function missing parameter list");
-        return 0;
+        return NULL;
     }
 
-    FunctionParameter parameters = extractParameters(paramListNode);
+    FunctionParameter parameters = extractParameters(context->arena, paramListNode);
     int returnPointerLevel = 0;
     DataType returnType = getReturnTypeFromNode(returnTypeNode, &returnPointerLevel);
 
@@ -946,12 +941,13 @@ int validateFunctionDef(ASTNode node, TypeCheckContext context) {
     if (funcSymbol == NULL) {
         char *tempText = extractText(node->start, node->length);
         REPORT_ERROR(ERROR_VARIABLE_REDECLARED, node, context, tempText);
-        free(tempText);
-        freeParamList(parameters);
-        return 0;
+        trackedFree(MEM_SEMANTIC, tempText);
+        return NULL;
     }
+    annotateSymbol(context, node, funcSymbol);
+    funcSymbol->definition = node;
     if (returnType == TYPE_STRUCT) {
-        funcSymbol->structType = lookupSymbol(context->current, returnTypeNode->children->start, returnTypeNode->children->length)->structType;
+        funcSymbol->structType = resolveSymbol(context, returnTypeNode->children)->structType;
     }
     funcSymbol->returnsPointer = (returnPointerLevel > 0);
     funcSymbol->returnPointerLevel = returnPointerLevel;
@@ -959,30 +955,53 @@ int validateFunctionDef(ASTNode node, TypeCheckContext context) {
         funcSymbol->returnBaseType = returnType;
         funcSymbol->type = TYPE_POINTER;
     }
+    return funcSymbol;
+}
+
+/*
+ * Checks the body of a function declareFunction() registered, in a scope of
+ * its own under the current one. Expands a deferred body first.
+ */
+int validateFunctionBody(ASTNode node, Symbol funcSymbol, TypeCheckContext context) {
+    ASTNode paramListNode = node->children;
+    ASTNode returnTypeNode = paramListNode->brothers;
+    ASTNode bodyNode = returnTypeNode ? returnTypeNode->brothers : NULL;
+
+    if (bodyNode != NULL && bodyNode->nodeType == DEFERRED_BODY) {
+        if (context->ast == NULL) {
+            repError(ERROR_INTERNAL_PARSER_ERROR, "Deferred function body without its token list");
+            return 0;
+        }
+        // Syntax errors in the body are reported while parsing it
+        bodyNode = functionBody(context->ast, node);
+        if (bodyNode == NULL) return 0;
+    }
+
+    DataType returnType = funcSymbol->returnsPointer ? funcSymbol->returnBaseType : funcSymbol->type;
 
     SymbolTable oldScope = context->current;
     Symbol oldFunction = context->currentFunction;
 
-    SymbolTable funcScope = createSymbolTable(oldScope);
+    SymbolTable funcScope = createSymbolTable(context->arena, oldScope);
     if (funcScope == NULL) {
         repError(ERROR_SYMBOL_TABLE_CREATION_FAILED, "Failed to create function scope");
         return 0;
     }
     funcSymbol->functionScope = funcScope;
-    context->current = funcScope;
+    setCurrentScope(context, funcScope);
     context->currentFunction = funcSymbol;
 
     if (context->current == NULL) {
         repError(ERROR_SYMBOL_TABLE_CREATION_FAILED, "Failed to create function scope");
-        context->current = oldScope;
+        setCurrentScope(context, oldScope);
         context->currentFunction = oldFunction;
         return 0;
     }
 
     ASTNode paramNode = paramListNode->children;
-    param = parameters;
+    FunctionParameter param = funcSymbol->parameters;
     while (param != NULL && paramNode != NULL) {
-        Symbol paramSymbol = addSymbol(context->current, param->nameStart, param->nameLength, param->type, node->line, node->column);
+        Symbol paramSymbol = addSymbol(context->current, param->name, param->type, node->start);
         if (paramSymbol != NULL) {
             paramSymbol->isInitialized = 1;
 
@@ -995,7 +1014,7 @@ int validateFunctionDef(ASTNode node, TypeCheckContext context) {
                 paramSymbol->baseType = getDataTypeFromNode(baseType->nodeType);
 
                 if (paramSymbol->baseType == TYPE_STRUCT || paramSymbol->type == TYPE_STRUCT) {
-                    Symbol structTypeSymbol = lookupSymbol(context->current, baseType->start, baseType->length);
+                    Symbol structTypeSymbol = resolveSymbol(context, baseType);
                     if (structTypeSymbol && structTypeSymbol->symbolType == SYMBOL_TYPE) {
                         paramSymbol->structType = structTypeSymbol->structType;
                     }
@@ -1016,12 +1035,18 @@ int validateFunctionDef(ASTNode node, TypeCheckContext context) {
         }
     }
 
-    context->current = oldScope;
+    setCurrentScope(context, oldScope);
     context->currentFunction = oldFunction;
 
     return success;
 }
 
+int validateFunctionDef(ASTNode node, TypeCheckContext context) {
+    Symbol funcSymbol = declareFunction(node, context);
+    if (funcSymbol == NULL) return 0;
+    return validateFunctionBody(node, funcSymbol, context);
+}
+
 int validateFunctionCall(ASTNode node, TypeCheckContext context) {
     if (node == NULL || node->nodeType != FUNCTION_CALL || node->start == NULL) {
         repError(ERROR_INTERNAL_PARSER_ERROR, "Invalid function call node");
@@ -1035,6 +1060,8 @@ int validateFunctionCall(ASTNode node, TypeCheckContext context) {
     }
 
     if (isBuiltinFunction(node->start, node->length)) {
+        // The overloads share one symbol, which IR generation reads the parameters from
+        resolveSymbol(context, node);
         return validateBuiltinFunctionCall(node, context);
     }
 
@@ -1053,7 +1080,7 @@ int validateBuiltinFunctionCall(ASTNode node, TypeCheckContext context) {
 
     DataType *argTypes = NULL;
     if (argCount > 0) {
-        argTypes = malloc(argCount * sizeof(DataType));
+        argTypes = trackedMalloc(MEM_SEMANTIC, argCount * sizeof(DataType));
         if (!argTypes) {
             repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to allocate argument types array");
             return 0;
@@ -1063,7 +1090,7 @@ int validateBuiltinFunctionCall(ASTNode node, TypeCheckContext context) {
         for (int i = 0; i < argCount && arg != NULL; i++) {
             DataType argType = getExpressionType(arg, context, TYPE_I32); // I32 placeholder for testing ?
             if (argType == TYPE_UNKNOWN) {
-                free(argTypes);
+                trackedFree(MEM_SEMANTIC, argTypes);
                 return 0;
             }
             argTypes[i] = argType;
@@ -1079,18 +1106,18 @@ int validateBuiltinFunctionCall(ASTNode node, TypeCheckContext context) {
     }
 
     if (argTypes != NULL) {
-        free(argTypes);
+        trackedFree(MEM_SEMANTIC, argTypes);
     }
 
     return result;
 }
 
 int validateUserDefinedFunctionCall(ASTNode node, TypeCheckContext context) {
-    Symbol funcSymbol = lookupSymbol(context->current, node->start, node->length);
+    Symbol funcSymbol = resolveSymbol(context, node);
     if (funcSymbol == NULL) {
         char *tempText = extractText(node->start, node->length);
         REPORT_ERROR(ERROR_UNDEFINED_FUNCTION, node, context, tempText);
-        free(tempText);
+        trackedFree(MEM_SEMANTIC, tempText);
         return 0;
     }
 
@@ -1128,12 +1155,12 @@ int validateUserDefinedFunctionCall(ASTNode node, TypeCheckContext context) {
         if (compat == COMPAT_ERROR) {
             char *tempText = extractText(param->nameStart, param->nameLength);
             REPORT_ERROR(variableErrorCompatibleHandling(param->type, argType), node, context, tempText);
-            free(tempText);
+            trackedFree(MEM_SEMANTIC, tempText);
             return 0;
         } else if (compat == COMPAT_WARNING) {
             char *tempText = extractText(param->nameStart, param->nameLength);
             REPORT_ERROR(ERROR_TYPE_MISMATCH_DOUBLE_TO_FLOAT, node, context, tempText);
-            free(tempText);
+            trackedFree(MEM_SEMANTIC, tempText);
         }
 
         param = param->next;
@@ -1188,7 +1215,7 @@ int validateReturnStatement(ASTNode node, TypeCheckContext context) {
 
         ASTNode retExpr = node->children;
         if (retExpr->nodeType == VARIABLE) {
-            Symbol retSym = lookupSymbol(context->current, retExpr->start, retExpr->length);
+            Symbol retSym = resolveSymbol(context, retExpr);
             if (retSym && retSym->isPointer) {
                 if (funcSym->returnPointerLevel != retSym->pointerLvl) {
                     char msg[100];
@@ -1219,7 +1246,7 @@ int validateReturnStatement(ASTNode node, TypeCheckContext context) {
         return 0;
     }
 
-    funcSym->returnedVar = lookupSymbol(context->current, node->children->start, node->children->length);
+    funcSym->returnedVar = resolveSymbol(context, node->children);
 
     return 1;
 }
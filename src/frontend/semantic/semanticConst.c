@@ -0,0 +1,420 @@
+/**
+ * @file semanticConst.c
+ * @brief Compile-time evaluation of constant expressions.
+ *
+ * Responsibilities:
+ *   - Folding literals, consts, operators, casts and ternaries to a ConstValue
+ *   - Running calls to functions of the module whose bodies only declare,
+ *     branch and return
+ *
+ * Every value is worked out in the type the type checker gave its
+ * expression, so wrapping and truncation match the generated code. Anything
+ * that is not constant, would trap at run time (division by zero, oversized
+ * shifts) or runs past the call depth or step limits is simply not constant
+ * and is left to run at run time. Nothing here reports errors.
+ *
+ * A call runs the callee's AST, expanding its body if it was deferred. While
+ * bodies are checked in parallel another thread may be working on that body,
+ * so calls are only run from outside function bodies.
+ */
+
+#include "semanticInternal.h"
+
+#define CONST_CALL_DEPTH 32
+#define CONST_STEP_LIMIT 100000
+#define CONST_FRAME_SLOTS 32
+
+typedef struct ConstFrame {
+    NameId names[CONST_FRAME_SLOTS];
+    ConstValue values[CONST_FRAME_SLOTS];
+    int count;
+} ConstFrame;
+
+typedef struct ConstEvaluator {
+    TypeCheckContext context;
+    ConstFrame *frame;      // arguments and locals of the running call, NULL outside calls
+    int depth;
+    int steps;
+} ConstEvaluator;
+
+typedef enum {
+    EXEC_NEXT,
+    EXEC_RETURNED,
+    EXEC_FAILED
+} ExecResult;
+
+static const ConstValue notConstant = {.type = TYPE_UNKNOWN};
+
+static ConstValue evaluate(ConstEvaluator *e, ASTNode node, DataType expectedType);
+
+/**
+ * Values
+ */
+
+static int isConstType(DataType type) {
+    return isNumType(type) || type == TYPE_BOOL;
+}
+
+static int isFloating(DataType type) {
+    return type == TYPE_FLOAT || type == TYPE_DOUBLE;
+}
+
+static ConstValue intValue(DataType type, int64_t value) {
+    ConstValue result = {.type = type};
+    switch (type) {
+        case TYPE_I8:   result.intVal = (int8_t)value; break;
+        case TYPE_I16:  result.intVal = (int16_t)value; break;
+        case TYPE_I32:  result.intVal = (int32_t)value; break;
+        case TYPE_U8:   result.intVal = (uint8_t)value; break;
+        case TYPE_U16:  result.intVal = (uint16_t)value; break;
+        case TYPE_U32:  result.intVal = (uint32_t)value; break;
+        case TYPE_BOOL: result.intVal = value != 0; break;
+        default:        result.intVal = value; break;
+    }
+    return result;
+}
+
+static ConstValue floatValue(DataType type, double value) {
+    ConstValue result = {.type = type};
+    result.floatVal = type == TYPE_FLOAT ? (float)value : value;
+    return result;
+}
+
+static double asDouble(ConstValue value) {
+    if (isFloating(value.type)) return value.floatVal;
+    if (value.type == TYPE_U64) return (double)(uint64_t)value.intVal;
+    return (double)value.intVal;
+}
+
+ConstValue convertConstant(ConstValue value, DataType type) {
+    if (value.type == TYPE_UNKNOWN || !isConstType(type)) return notConstant;
+    if (value.type == type) return value;
+
+    if (isFloating(type)) {
+        return value.type == TYPE_BOOL ? notConstant : floatValue(type, asDouble(value));
+    }
+    if (!isFloating(value.type)) return intValue(type, value.intVal);
+    if (type == TYPE_BOOL) return notConstant;
+
+    // Out of range float to integer conversions are undefined, NaN included
+    double d = value.floatVal;
+    if (!(d >= -9223372036854775808.0 && d < 18446744073709551616.0)) return notConstant;
+    if (d >= 9223372036854775808.0) return intValue(type, (int64_t)(uint64_t)d);
+    return intValue(type, (int64_t)d);
+}
+
+static ConstValue literalValue(ConstEvaluator *e, ASTNode node, DataType expectedType) {
+    if (!node->children) return notConstant;
+
+    DataType type;
+    switch (node->children->nodeType) {
+        case REF_INT_UNRESOLVED:
+            // Checked literals keep the type they resolved to
+            type = nodeDataType(e->context, node);
+            if (!isIntegerType(type)) type = isIntegerType(expectedType) ? expectedType : TYPE_I32;
+            break;
+        case REF_FLOAT:  return floatValue(TYPE_FLOAT, parseFloat(node->start, node->length));
+        case REF_DOUBLE: return floatValue(TYPE_DOUBLE, parseFloat(node->start, node->length));
+        case REF_BOOL:   return intValue(TYPE_BOOL, node->length == 4); // "true" or "false"
+        default:
+            type = getDataTypeFromNode(node->children->nodeType);
+            if (!isIntegerType(type)) return notConstant;
+            break;
+    }
+
+    int negative = node->start[0] == '-';
+    uint64_t magnitude = 0;
+    for (size_t i = negative; i < node->length && node->start[i] >= '0' && node->start[i] <= '9'; i++) {
+        magnitude = magnitude * 10 + (uint64_t)(node->start[i] - '0');
+    }
+    return intValue(type, (int64_t)(negative ? 0 - magnitude : magnitude));
+}
+
+static ConstValue variableValue(ConstEvaluator *e, ASTNode node) {
+    if (e->frame) {
+        for (int i = e->frame->count - 1; i >= 0; i--) {
+            if (e->frame->names[i] == node->name) return e->frame->values[i];
+        }
+    }
+
+    // A callee's body may not be checked yet, and globals are all it sees besides its frame
+    Symbol sym = e->frame ? lookupSymbolCurrentOnly(e->context->global, node->name)
+                          : nodeSymbol(e->context, node);
+    if (!sym || sym->symbolType != SYMBOL_VARIABLE || !sym->isConst) return notConstant;
+    return sym->constValue;
+}
+
+/**
+ * Operators
+ */
+
+static ConstValue unaryValue(ConstEvaluator *e, ASTNode node, DataType expectedType) {
+    ConstValue operand = evaluate(e, node->children, expectedType);
+    if (operand.type == TYPE_UNKNOWN) return notConstant;
+
+    switch (node->nodeType) {
+        case UNARY_PLUS_OP:
+            return isNumType(operand.type) ? operand : notConstant;
+        case UNARY_MINUS_OP:
+            if (isFloating(operand.type)) return floatValue(operand.type, -operand.floatVal);
+            if (!isIntegerType(operand.type)) return notConstant;
+            return intValue(operand.type, (int64_t)(0 - (uint64_t)operand.intVal));
+        case LOGIC_NOT:
+            return operand.type == TYPE_BOOL ? intValue(TYPE_BOOL, !operand.intVal) : notConstant;
+        case BITWISE_NOT:
+            return isIntegerType(operand.type) ? intValue(operand.type, ~operand.intVal) : notConstant;
+        default:
+            return notConstant;
+    }
+}
+
+static ConstValue floatBinary(NodeTypes op, DataType type, double a, double b) {
+    switch (op) {
+        case ADD_OP:           return floatValue(type, a + b);
+        case SUB_OP:           return floatValue(type, a - b);
+        case MUL_OP:           return floatValue(type, a * b);
+        case DIV_OP:           return b == 0 ? notConstant : floatValue(type, a / b);
+        case EQUAL_OP:         return intValue(TYPE_BOOL, a == b);
+        case NOT_EQUAL_OP:     return intValue(TYPE_BOOL, a != b);
+        case LESS_THAN_OP:     return intValue(TYPE_BOOL, a < b);
+        case LESS_EQUAL_OP:    return intValue(TYPE_BOOL, a <= b);
+        case GREATER_THAN_OP:  return intValue(TYPE_BOOL, a > b);
+        case GREATER_EQUAL_OP: return intValue(TYPE_BOOL, a >= b);
+        default:               return notConstant;
+    }
+}
+
+static ConstValue intBinary(NodeTypes op, DataType type, int64_t a, int64_t b) {
+    uint64_t ua = (uint64_t)a, ub = (uint64_t)b;
+    int isSigned = isSignedInt(type);
+    int bits = getStackSize(type) * 8;
+
+    switch (op) {
+        case ADD_OP:      return intValue(type, (int64_t)(ua + ub));
+        case SUB_OP:      return intValue(type, (int64_t)(ua - ub));
+        case MUL_OP:      return intValue(type, (int64_t)(ua * ub));
+        case BITWISE_AND: return intValue(type, a & b);
+        case BITWISE_OR:  return intValue(type, a | b);
+        case BITWISE_XOR: return intValue(type, a ^ b);
+
+        case DIV_OP:
+        case MOD_OP: {
+            // Both trap at run time
+            int64_t minimum = bits == 64 ? INT64_MIN : -((int64_t)1 << (bits - 1));
+            if (b == 0 || (isSigned && b == -1 && a == minimum)) return notConstant;
+            if (isSigned) return intValue(type, op == DIV_OP ? a / b : a % b);
+            return intValue(type, (int64_t)(op == DIV_OP ? ua / ub : ua % ub));
+        }
+
+        case BITWISE_LSHIFT:
+        case BITWISE_RSHIFT:
+            if (ub >= (uint64_t)bits) return notConstant;
+            if (op == BITWISE_LSHIFT) return intValue(type, (int64_t)(ua << ub));
+            return intValue(type, isSigned ? a >> b : (int64_t)(ua >> ub));
+
+        case EQUAL_OP:         return intValue(TYPE_BOOL, a == b);
+        case NOT_EQUAL_OP:     return intValue(TYPE_BOOL, a != b);
+        case LESS_THAN_OP:     return intValue(TYPE_BOOL, isSigned ? a < b : ua < ub);
+        case LESS_EQUAL_OP:    return intValue(TYPE_BOOL, isSigned ? a <= b : ua <= ub);
+        case GREATER_THAN_OP:  return intValue(TYPE_BOOL, isSigned ? a > b : ua > ub);
+        case GREATER_EQUAL_OP: return intValue(TYPE_BOOL, isSigned ? a >= b : ua >= ub);
+        default:               return notConstant;
+    }
+}
+
+static ConstValue binaryValue(ConstEvaluator *e, ASTNode node, DataType expectedType) {
+    if (!node->children || !node->children->brothers) return notConstant;
+    ConstValue left = evaluate(e, node->children, expectedType);
+    ConstValue right = evaluate(e, node->children->brothers, expectedType);
+    if (left.type == TYPE_UNKNOWN || right.type == TYPE_UNKNOWN) return notConstant;
+
+    NodeTypes op = node->nodeType;
+    if (left.type == TYPE_BOOL || right.type == TYPE_BOOL) {
+        if (left.type != right.type) return notConstant;
+        switch (op) {
+            case LOGIC_AND:    return intValue(TYPE_BOOL, left.intVal && right.intVal);
+            case LOGIC_OR:     return intValue(TYPE_BOOL, left.intVal || right.intVal);
+            case EQUAL_OP:     return intValue(TYPE_BOOL, left.intVal == right.intVal);
+            case NOT_EQUAL_OP: return intValue(TYPE_BOOL, left.intVal != right.intVal);
+            default:           return notConstant;
+        }
+    }
+
+    // Both sides meet in the wider type, the left one on a tie, as the type checker has it
+    DataType type;
+    if (isIntegerType(left.type) && isIntegerType(right.type)) {
+        type = getIntegerRank(left.type) >= getIntegerRank(right.type) ? left.type : right.type;
+        return intBinary(op, type, convertConstant(left, type).intVal, convertConstant(right, type).intVal);
+    }
+    type = getOperationResultType(left.type, right.type, MUL_OP);
+    if (!isFloating(type)) return notConstant;
+    return floatBinary(op, type, convertConstant(left, type).floatVal, convertConstant(right, type).floatVal);
+}
+
+/**
+ * Calls
+ */
+
+static int bindValue(ConstFrame *frame, NameId name, ConstValue value) {
+    if (value.type == TYPE_UNKNOWN || frame->count == CONST_FRAME_SLOTS) return 0;
+    frame->names[frame->count] = name;
+    frame->values[frame->count] = value;
+    frame->count++;
+    return 1;
+}
+
+static ExecResult execStatement(ConstEvaluator *e, ASTNode stmt, DataType returnType, ConstValue *result) {
+    switch (stmt->nodeType) {
+        case BLOCK_STATEMENT: {
+            int mark = e->frame->count;
+            ExecResult status = EXEC_NEXT;
+            for (ASTNode child = stmt->children; child && status == EXEC_NEXT; child = child->brothers) {
+                status = execStatement(e, child, returnType, result);
+            }
+            e->frame->count = mark;
+            return status;
+        }
+
+        case LET_DEC:
+        case CONST_DEC: {
+            ASTNode varDef = stmt->children;
+            if (!varDef || varDef->nodeType != VAR_DEFINITION) return EXEC_FAILED;
+            ASTNode typeRef = varDef->children;
+            ASTNode init = typeRef ? typeRef->brothers : NULL;
+            if (!init || !typeRef->children) return EXEC_FAILED;
+
+            DataType type = getDataTypeFromNode(typeRef->children->nodeType);
+            ConstValue value = convertConstant(evaluate(e, init->children, type), type);
+            return bindValue(e->frame, varDef->name, value) ? EXEC_NEXT : EXEC_FAILED;
+        }
+
+        case RETURN_STATEMENT:
+            if (!stmt->children) return EXEC_FAILED;
+            *result = convertConstant(evaluate(e, stmt->children, returnType), returnType);
+            return result->type == TYPE_UNKNOWN ? EXEC_FAILED : EXEC_RETURNED;
+
+        case IF_CONDITIONAL: {
+            ConstValue cond = evaluate(e, stmt->children, TYPE_BOOL);
+            if (cond.type != TYPE_BOOL) return EXEC_FAILED;
+            ASTNode trueBranch = stmt->children->brothers;
+            if (!trueBranch) return EXEC_FAILED;
+            ASTNode branch = cond.intVal ? trueBranch : trueBranch->brothers;
+            if (!branch || !branch->children) return EXEC_NEXT;
+            return execStatement(e, branch->children, returnType, result);
+        }
+
+        default:
+            return EXEC_FAILED;
+    }
+}
+
+static ConstValue callValue(ConstEvaluator *e, ASTNode node) {
+    if (e->context->currentFunction || e->depth == CONST_CALL_DEPTH) return notConstant;
+
+    Symbol fn = e->frame ? lookupSymbolCurrentOnly(e->context->global, node->name)
+                         : nodeSymbol(e->context, node);
+    if (!fn || fn->symbolType != SYMBOL_FUNCTION || !fn->definition ||
+        fn->returnsPointer || !isConstType(fn->type)) {
+        return notConstant;
+    }
+
+    ConstFrame frame = {.count = 0};
+    ASTNode args = node->children;
+    ASTNode arg = args && args->nodeType == ARGUMENT_LIST ? args->children : NULL;
+    FunctionParameter param = fn->parameters;
+    for (; param && arg; param = param->next, arg = arg->brothers) {
+        if (param->isPointer) return notConstant;
+        ConstValue value = convertConstant(evaluate(e, arg, param->type), param->type);
+        if (!bindValue(&frame, param->name, value)) return notConstant;
+    }
+    if (param || arg) return notConstant;
+
+    ASTNode body = functionBody(e->context->ast, fn->definition);
+    if (!body || body->nodeType != BLOCK_STATEMENT) return notConstant;
+
+    ConstFrame *caller = e->frame;
+    ConstValue result = notConstant;
+    e->frame = &frame;
+    e->depth++;
+    ExecResult status = execStatement(e, body, fn->type, &result);
+    e->depth--;
+    e->frame = caller;
+    return status == EXEC_RETURNED ? result : notConstant;
+}
+
+/**
+ * Expressions
+ */
+
+static ConstValue expressionValue(ConstEvaluator *e, ASTNode node, DataType expectedType) {
+    switch (node->nodeType) {
+        case LITERAL:
+            return literalValue(e, node, expectedType);
+
+        case VARIABLE:
+            return variableValue(e, node);
+
+        case UNARY_PLUS_OP:
+        case UNARY_MINUS_OP:
+        case LOGIC_NOT:
+        case BITWISE_NOT:
+            return unaryValue(e, node, expectedType);
+
+        case ADD_OP:
+        case SUB_OP:
+        case MUL_OP:
+        case DIV_OP:
+        case MOD_OP:
+        case BITWISE_AND:
+        case BITWISE_OR:
+        case BITWISE_XOR:
+        case BITWISE_LSHIFT:
+        case BITWISE_RSHIFT:
+        case EQUAL_OP:
+        case NOT_EQUAL_OP:
+        case LESS_THAN_OP:
+        case LESS_EQUAL_OP:
+        case GREATER_THAN_OP:
+        case GREATER_EQUAL_OP:
+        case LOGIC_AND:
+        case LOGIC_OR:
+            return binaryValue(e, node, expectedType);
+
+        case CAST_EXPRESSION: {
+            if (!node->children || !node->children->brothers) return notConstant;
+            DataType target = getDataTypeFromNode(node->children->brothers->nodeType);
+            return convertConstant(evaluate(e, node->children, target), target);
+        }
+
+        case TERNARY_CONDITIONAL: {
+            ASTNode trueBranch = node->children ? node->children->brothers : NULL;
+            ASTNode falseBranch = trueBranch ? trueBranch->brothers : NULL;
+            if (!falseBranch) return notConstant;
+            ConstValue cond = evaluate(e, node->children, TYPE_BOOL);
+            if (cond.type != TYPE_BOOL) return notConstant;
+            // Only the branch taken has to be constant, the other never runs
+            return evaluate(e, cond.intVal ? trueBranch->children : falseBranch->children, expectedType);
+        }
+
+        case FUNCTION_CALL:
+            return callValue(e, node);
+
+        default:
+            return notConstant;
+    }
+}
+
+static ConstValue evaluate(ConstEvaluator *e, ASTNode node, DataType expectedType) {
+    if (!node || ++e->steps > CONST_STEP_LIMIT) return notConstant;
+    ConstValue value = expressionValue(e, node, expectedType);
+
+    // A checked expression holds the type it was given, ternaries and calls included
+    DataType checked = nodeDataType(e->context, node);
+    return isConstType(checked) ? convertConstant(value, checked) : value;
+}
+
+ConstValue evaluateConstant(TypeCheckContext context, ASTNode node, DataType expectedType) {
+    if (!context) return notConstant;
+    ConstEvaluator evaluator = {.context = context};
+    return evaluate(&evaluator, node, expectedType);
+}
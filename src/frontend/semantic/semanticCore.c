@@ -4,50 +4,74 @@
  *
  * Responsibilities:
  *   - Create / destroy TypeCheckContext
- *   - Register built-ins
+ *   - Layer the shared built-ins under the global table
  *   - Walk the AST via typeCheckNode (main dispatch)
  *   - Delegate to specialised check functions
+ *   - Two-phase module driver: declarations in order, then function bodies,
+ *     with the diagnostics of both printed in source order
  *
  * Equivalent to parserCore.c in the parser.
  */
 
 #include "semanticInternal.h"
+#include "memTrack.h"
+#include "arena.h"
+#include "threadPool.h"
 
-TypeCheckContext createTypeCheckContext(const char *sourceCode, const char *filename) {
-    TypeCheckContext context = malloc(sizeof(struct TypeCheckContext));
+#define SEMANTIC_ARENA_CHUNK (64 * 1024)
+#define BODY_ARENA_CHUNK (16 * 1024)
+#define BODY_TASK_FUNCTIONS 16
+
+TypeCheckContext createTypeCheckContext(SourceFile *source, const char *filename) {
+    TypeCheckContext context = trackedMalloc(MEM_SEMANTIC, sizeof(struct TypeCheckContext));
     if (context == NULL) {
         repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to allocate type check context");
         return NULL;
     };
 
-    context->global = createSymbolTable(NULL);
+    context->arena = createArena(MEM_SEMANTIC, SEMANTIC_ARENA_CHUNK);
+    context->global = context->arena ? createSymbolTable(context->arena, NULL) : NULL;
     if (context->global == NULL) {
-        free(context);
+        freeArena(context->arena);
+        trackedFree(MEM_SEMANTIC, context);
         repError(ERROR_SYMBOL_TABLE_CREATION_FAILED, "Failed to create global symbol table");
         return NULL;
     }
-    context->current = context->global;
+    context->current = NULL;
+    context->scopes = createScopeStack();
+    if (context->scopes == NULL) {
+        freeArena(context->arena);
+        trackedFree(MEM_SEMANTIC, context);
+        repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to allocate scope stack");
+        return NULL;
+    }
+    setCurrentScope(context, context->global);
     context->currentFunction = NULL;
-    context->sourceFile = sourceCode;
+    context->source = source;
+    context->ast = NULL;
     context->filename = filename;
-    context->blockScopesHead = NULL;
-    context->blockScopesTail = NULL;
+    context->annotations = NULL;
+    context->annotationCount = 0;
+    context->annotationCapacity = 0;
+    context->annotatedNodes = NULL;
+    context->pool = NULL;
 
-    initBuiltIns(context->global);
+    if (!addPreludeTable(context->global, builtInSymbols())) {
+        freeTypeCheckContext(context);
+        repError(ERROR_SYMBOL_TABLE_CREATION_FAILED, "Failed to load built-in symbols");
+        return NULL;
+    }
 
     return context;
 }
 
 void freeTypeCheckContext(TypeCheckContext context) {
     if (context == NULL) return;
-    if (context->global != NULL) freeSymbolTable(context->global);
-    BlockScopeNode node = context->blockScopesHead;
-    while (node) {
-        BlockScopeNode next = node->next;
-        free(node);
-        node = next;
-    }
-    free(context);
+    freeScopeStack(context->scopes);
+    // Tables, symbols, parameters and struct types all live here
+    freeArena(context->arena);
+    trackedFree(MEM_SEMANTIC, context->annotations);
+    trackedFree(MEM_SEMANTIC, context);
 }
 
 int typeCheckNode(ASTNode node, TypeCheckContext context, DataType expectedType) {
@@ -101,7 +125,7 @@ int typeCheckNode(ASTNode node, TypeCheckContext context, DataType expectedType)
         case BLOCK_STATEMENT:
         case BLOCK_EXPRESSION: {
             SymbolTable oldScope = context->current;
-            SymbolTable blockScope = createSymbolTable(oldScope);
+            SymbolTable blockScope = createSymbolTable(context->arena, oldScope);
 
             if (blockScope == NULL) {
                 repError(ERROR_SYMBOL_TABLE_CREATION_FAILED, "Failed to create new scope for block");
@@ -109,14 +133,11 @@ int typeCheckNode(ASTNode node, TypeCheckContext context, DataType expectedType)
                 break;
             }
 
-            context->current = blockScope;
-
-            /* Enqueue the scope for IR generation to use later */
-            enqueueBlockScope(context, blockScope);
+            setCurrentScope(context, blockScope);
 
             success = typeCheckChildren(node, context, expectedType);
 
-            context->current = oldScope;
+            setCurrentScope(context, oldScope);
             break;
         }
         case TERNARY_CONDITIONAL:
@@ -187,6 +208,21 @@ int typeCheckNode(ASTNode node, TypeCheckContext context, DataType expectedType)
         case STRUCT_VARIABLE_DEFINITION:
             success = validateStructVarDec(node, context);
             break;
+        case EXPORTDEC:
+            success = typeCheckChildren(node, context, expectedType);
+            // Importers only get the value, there is nothing of the const to link against
+            if (success && node->children && node->children->nodeType == CONST_DEC) {
+                ASTNode varDef = node->children->children;
+                Symbol sym = nodeSymbol(context, varDef);
+                if (!sym || sym->constValue.type == TYPE_UNKNOWN) {
+                    REPORT_ERROR(ERROR_EXPORTED_CONST_NOT_CONSTANT, varDef, context,
+                                "Exported const must have a compile-time value");
+                    success = 0;
+                } else {
+                    sym->isExported = 1;
+                }
+            }
+            break;
         default:
             success = typeCheckChildren(node, context, expectedType);
             break;
@@ -212,12 +248,304 @@ int typeCheckChildren(ASTNode node, TypeCheckContext context, DataType expectedT
     return success;
 }
 
-TypeCheckContext typeCheckAST(ASTNode ast, const char *sourceCode, const char *filename, TypeCheckContext ref) {
+/**
+ * Module driver
+ *
+ * Top-level statements, struct layouts and function signatures are checked
+ * first, in source order. Bodies only read those globals, so they are then
+ * checked in batches of consecutive functions, each batch on a scope stack
+ * of its own over the global table. On a pool every batch also gets its own
+ * arenas, annotations and diagnostics, merged back in source order, so the
+ * output is the same however many threads ran them. Without one, a single
+ * batch writes to the module's directly.
+ *
+ * A body still sees only what was declared above its function. Assigning a
+ * global that is uninitialised or a pointer changes what later bodies see,
+ * so modules that have such globals check their bodies in order.
+ */
+
+typedef struct BodyTask {
+    struct TypeCheckContext context;    // the module's, with a scope stack of its own
+    ASTContext ast;                     // expands deferred bodies into an arena of the task
+    TypeCheckContext module;
+    ASTNode first;                      // top-level statements first up to end
+    ASTNode end;
+    DiagnosticBuffer diagnostics;
+    size_t *bodyEnds;                   // diagnostics mark after each statement from first on
+    uint32_t annotationBase;            // first slot of the module's table the task's annotations move to
+    int shared;                         // writes the module's arenas and annotations
+    int success;
+} BodyTask;
+
+/*
+ * Where the diagnostics of each top-level statement end, in the declarations
+ * buffer and in the buffer of the task that checked its body. Printing the
+ * two slices of every statement in turn keeps the report in source order.
+ */
+typedef struct StatementDiagnostics {
+    DiagnosticBuffer declarations;
+    size_t *declarationEnds;
+    size_t *bodyEnds;
+} StatementDiagnostics;
+
+/* The function a top-level statement defines, exported or not, NULL for anything else */
+static ASTNode definedFunction(ASTNode stmt) {
+    if (stmt->nodeType == EXPORTDEC) stmt = stmt->children;
+    return stmt && stmt->nodeType == FUNCTION_DEFINITION ? stmt : NULL;
+}
+
+static void checkBodies(void *arg) {
+    BodyTask *task = arg;
+    TypeCheckContext context = &task->context;
+    if (!beginDiagnostics(&task->diagnostics)) {
+        repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to buffer diagnostics");
+        task->success = 0;
+        return;
+    }
+    // A shared table moves as it grows, the module's copy of the pointer goes stale
+    TypeCheckContext declared = task->shared ? context : task->module;
+    size_t *ends = task->bodyEnds;
+    for (ASTNode stmt = task->first; stmt != task->end; stmt = stmt->brothers, ends++) {
+        ASTNode fn = definedFunction(stmt);
+        Symbol funcSymbol = fn ? nodeSymbol(declared, fn) : NULL;
+        if (funcSymbol) {
+            context->scopes->visibleBefore = fn->start;
+            if (!validateFunctionBody(fn, funcSymbol, context)) task->success = 0;
+        }
+        *ends = markDiagnostics();
+        // Unbuffered the process would have ended here, so nothing after it is reported
+        if (task->diagnostics.fatal != ERROR_OK) break;
+    }
+    endDiagnostics();
+}
+
+static int initBodyTask(BodyTask *task, TypeCheckContext module, int shared) {
+    task->context = *module;
+    task->module = module;
+    task->shared = shared;
+    task->success = 1;
+    task->ast.arena = NULL;
+    task->context.pool = NULL;
+    task->context.currentFunction = NULL;
+    task->context.current = module->global;
+    task->context.scopes = createScopeStack();
+    if (!task->context.scopes) return 0;
+    task->context.scopes->base = module->global;
+    task->context.scopes->top = module->global;
+    if (shared) return 1;
+
+    task->context.annotations = NULL;
+    task->context.arena = createArena(MEM_SEMANTIC, BODY_ARENA_CHUNK);
+    if (module->ast) {
+        task->ast = *module->ast;
+        task->ast.arena = createArena(MEM_PARSER, BODY_ARENA_CHUNK);
+        task->context.ast = &task->ast;
+    }
+    return task->context.arena && (!module->ast || task->ast.arena) &&
+           trackAnnotatedNodes(&task->context);
+}
+
+static void moveTaskAnnotations(void *arg) {
+    BodyTask *task = arg;
+    moveAnnotations(task->module, task->annotationBase, &task->context);
+}
+
+/*
+ * Moves the annotations of every task into the module's table, each into
+ * its own range so the copies run on the pool too.
+ */
+static int mergeTaskAnnotations(BodyTask *tasks, int taskCount, TypeCheckContext module, ThreadPool pool) {
+    uint32_t count = module->annotationCount ? module->annotationCount : 1;
+    for (int i = 0; i < taskCount; i++) {
+        tasks[i].annotationBase = count;
+        count += tasks[i].context.annotationCount - 1;
+    }
+    if (!reserveAnnotations(module, count)) return 0;
+    for (int i = 0; i < taskCount; i++) {
+        if (!submitTask(pool, moveTaskAnnotations, &tasks[i])) moveTaskAnnotations(&tasks[i]);
+    }
+    waitThreadPool(pool);
+    module->annotationCount = count;
+    return 1;
+}
+
+/* Hands the rest of what the task made over to the module */
+static int mergeBodyTask(BodyTask *task, TypeCheckContext module) {
+    if (task->shared) {
+        // The table may have moved while growing
+        module->annotations = task->context.annotations;
+        module->annotationCount = task->context.annotationCount;
+        module->annotationCapacity = task->context.annotationCapacity;
+        return task->success;
+    }
+    arenaAdopt(module->arena, task->context.arena);
+    if (task->ast.arena) arenaAdopt(module->ast->arena, task->ast.arena);
+    task->context.arena = NULL;
+    task->ast.arena = NULL;
+    return task->success;
+}
+
+static void freeBodyTask(BodyTask *task) {
+    freeScopeStack(task->context.scopes);
+    if (task->shared) return;
+    freeArena(task->context.arena);
+    freeArena(task->ast.arena);
+    trackedFree(MEM_SEMANTIC, task->context.annotations);
+    trackedFree(MEM_SEMANTIC, task->context.annotatedNodes);
+}
+
+static int globalsAreOrderFree(SymbolTable global) {
+    for (int i = 0; i < global->bucketCount; i++) {
+        for (Symbol sym = global->symbols[i]; sym; sym = sym->next) {
+            if (!sym->declaredAt || sym->symbolType != SYMBOL_VARIABLE) continue;
+            if (!sym->isInitialized || sym->isPointer) return 0;
+        }
+    }
+    return 1;
+}
+
+/* Flushes the held diagnostic that ends the process, once everything before it is printed */
+static void flushIfFatal(DiagnosticBuffer *buffer) {
+    if (buffer->fatal != ERROR_OK && buffer->printed == buffer->length) flushDiagnostics(buffer);
+}
+
+/*
+ * Prints what the declarations and the bodies reported, statement by
+ * statement, then hands the counts over. Tasks cover the statements in order.
+ */
+static void flushInSourceOrder(ASTNode program, StatementDiagnostics *order, BodyTask *tasks, int taskCount) {
+    int current = 0;
+    size_t index = 0;
+    for (ASTNode stmt = program->children; stmt; stmt = stmt->brothers, index++) {
+        printDiagnostics(&order->declarations, order->declarationEnds[index]);
+        flushIfFatal(&order->declarations);
+        while (current < taskCount && stmt == tasks[current].end) current++;
+        if (current == taskCount) continue;
+        printDiagnostics(&tasks[current].diagnostics, order->bodyEnds[index]);
+        flushIfFatal(&tasks[current].diagnostics);
+    }
+    flushDiagnostics(&order->declarations);
+    for (int i = 0; i < taskCount; i++) flushDiagnostics(&tasks[i].diagnostics);
+}
+
+static int checkFunctionBodies(ASTNode program, TypeCheckContext context, StatementDiagnostics *order) {
+    int functions = 0;
+    for (ASTNode stmt = program->children; stmt; stmt = stmt->brothers) {
+        ASTNode fn = definedFunction(stmt);
+        if (fn && nodeSymbol(context, fn)) functions++;
+    }
+    if (functions == 0) {
+        flushInSourceOrder(program, order, NULL, 0);
+        return 1;
+    }
+
+    ThreadPool pool = context->pool;
+    if (pool && (functions <= BODY_TASK_FUNCTIONS || !globalsAreOrderFree(context->global))) pool = NULL;
+    int taskCount = pool ? (functions + BODY_TASK_FUNCTIONS - 1) / BODY_TASK_FUNCTIONS : 1;
+
+    BodyTask *tasks = trackedCalloc(MEM_SEMANTIC, taskCount, sizeof(BodyTask));
+    if (!tasks) {
+        flushInSourceOrder(program, order, NULL, 0);
+        repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to allocate function body tasks");
+        return 0;
+    }
+
+    // Diagnostics of every task look up lines, build the table before they race for it
+    if (pool && context->source) sourceLocation(context->source, 0);
+    if (pool && context->ast && context->ast->source) sourceLocation(context->ast->source, 0);
+
+    int success = 1;
+    int created = 0;
+    size_t index = 0;
+    ASTNode stmt = program->children;
+    while (created < taskCount) {
+        BodyTask *task = &tasks[created++];
+        if (!initBodyTask(task, context, pool == NULL)) {
+            repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to set up function body task");
+            success = 0;
+            break;
+        }
+        task->first = stmt;
+        task->bodyEnds = order->bodyEnds + index;
+        int last = created == taskCount;
+        for (int count = 0; stmt && (last || count < BODY_TASK_FUNCTIONS); stmt = stmt->brothers, index++) {
+            ASTNode fn = definedFunction(stmt);
+            if (fn && nodeSymbol(context, fn)) count++;
+        }
+        task->end = stmt;
+    }
+
+    if (success) {
+        for (int i = 0; i < taskCount; i++) {
+            if (!pool || !submitTask(pool, checkBodies, &tasks[i])) checkBodies(&tasks[i]);
+        }
+        if (pool) {
+            waitThreadPool(pool);
+            if (!mergeTaskAnnotations(tasks, taskCount, context, pool)) success = 0;
+        }
+        for (int i = 0; i < taskCount; i++) {
+            if (!mergeBodyTask(&tasks[i], context)) success = 0;
+        }
+    }
+    flushInSourceOrder(program, order, tasks, created);
+
+    for (int i = 0; i < created; i++) freeBodyTask(&tasks[i]);
+    trackedFree(MEM_SEMANTIC, tasks);
+    return success;
+}
+
+/* Phase one: everything but function bodies, in source order */
+static int checkDeclarations(ASTNode program, TypeCheckContext context, StatementDiagnostics *order) {
+    if (!beginDiagnostics(&order->declarations)) {
+        repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to buffer diagnostics");
+        return 0;
+    }
+    int success = 1;
+    size_t *ends = order->declarationEnds;
+    for (ASTNode stmt = program->children; stmt; stmt = stmt->brothers, ends++) {
+        ASTNode fn = definedFunction(stmt);
+        if (fn) {
+            if (!declareFunction(fn, context)) success = 0;
+        } else if (!typeCheckNode(stmt, context, TYPE_UNKNOWN)) {
+            success = 0;
+        }
+        *ends = markDiagnostics();
+        // As in checkBodies, nothing after a fatal error is reported
+        if (order->declarations.fatal != ERROR_OK) break;
+    }
+    endDiagnostics();
+    return success;
+}
+
+/* Checks a whole module, declarations first and then the bodies of its functions */
+static int checkProgram(ASTNode program, TypeCheckContext context) {
+    size_t statements = 0;
+    for (ASTNode stmt = program->children; stmt; stmt = stmt->brothers) statements++;
+
+    StatementDiagnostics order = {0};
+    order.declarationEnds = trackedCalloc(MEM_SEMANTIC, statements, sizeof(size_t));
+    order.bodyEnds = trackedCalloc(MEM_SEMANTIC, statements, sizeof(size_t));
+    if (!order.declarationEnds || !order.bodyEnds) {
+        trackedFree(MEM_SEMANTIC, order.declarationEnds);
+        trackedFree(MEM_SEMANTIC, order.bodyEnds);
+        repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to allocate diagnostic marks");
+        return 0;
+    }
+
+    int success = checkDeclarations(program, context, &order);
+    // Bodies of functions that failed to declare are skipped, the rest still report
+    if (!checkFunctionBodies(program, context, &order)) success = 0;
+    trackedFree(MEM_SEMANTIC, order.declarationEnds);
+    trackedFree(MEM_SEMANTIC, order.bodyEnds);
+    return success;
+}
+
+TypeCheckContext typeCheckAST(ASTNode ast, SourceFile *source, const char *filename, TypeCheckContext ref) {
     TypeCheckContext context;
     if (ref) {
         context = ref;
     } else {
-        context = createTypeCheckContext(sourceCode, filename);
+        context = createTypeCheckContext(source, filename);
     }
     if (context == NULL) {
         repError(ERROR_CONTEXT_CREATION_FAILED, "Failed to create type check context");
@@ -228,10 +556,15 @@ TypeCheckContext typeCheckAST(ASTNode ast, const char *sourceCode, const char *f
         freeTypeCheckContext(context);
         return NULL;
     }
-    int success = typeCheckNode(ast, context, TYPE_UNKNOWN);
+    int success;
+    if (ast && ast->nodeType == PROGRAM) {
+        success = checkProgram(ast, context);
+    } else {
+        success = typeCheckNode(ast, context, TYPE_UNKNOWN);
+    }
     if (!success) {
         freeTypeCheckContext(context);
         return NULL;
     }
     return context;
-}
\ No newline at end of file
+}
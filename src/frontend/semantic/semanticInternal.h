@@ -20,13 +20,13 @@
 /* External Functions */
 
 extern int parseInt(const char *start, size_t length);
+extern double parseFloat(const char *start, size_t length);
 extern char *extractText(const char *start, size_t length);
 
 /* types helpers */
 
 ASTNode getBaseTypeFromPointerChain(ASTNode typeRefNode, int *outPointerLevel);
 ResolvedType resolveMemberAccessType(ASTNode node, TypeCheckContext context);
-DataType validateMemberAccess(ASTNode node, TypeCheckContext context);
 int isPrecisionLossCast(DataType source, DataType target);
 int isNumType(DataType type);
 CompatResult isCastAllowed(DataType target, DataType source);
@@ -35,12 +35,35 @@ int getIntegerRank(DataType type);
 
 /* symbol helpers */
 
+/** @brief lookupSymbol from the current scope, recording the binding on node */
+Symbol resolveSymbol(TypeCheckContext context, ASTNode node);
 Symbol lookupSymbolOrError(TypeCheckContext context, ASTNode node);
 
+/* node annotations, on semanticSymbols.c */
+
+NodeInfo *annotateNode(TypeCheckContext context, ASTNode node);
+void annotateSymbol(TypeCheckContext context, ASTNode node, Symbol sym);
+void annotateType(TypeCheckContext context, ASTNode node, DataType type);
+/** @brief Start an empty table that remembers which node holds each slot */
+int trackAnnotatedNodes(TypeCheckContext context);
+/** @brief Make room for count slots in the context's table */
+int reserveAnnotations(TypeCheckContext context, uint32_t count);
+/** @brief Copy a tracking context's annotations to into from slot base on and renumber their nodes */
+void moveAnnotations(TypeCheckContext into, uint32_t base, TypeCheckContext from);
+
+/** @brief Symbol from table's prelude tables only, on semanticTable.c */
+Symbol lookupPrelude(SymbolTable table, NameId name);
+
+/* scope stack, on semanticScope.c */
+
+Symbol lookupBinding(ScopeStack stack, NameId name);
+/** @brief Symbol of the stack's base table, or NULL if it has none or it is hidden */
+Symbol lookupBase(ScopeStack stack, NameId name);
+void bindSymbol(ScopeStack stack, Symbol symbol);
+
 /* error helpers */
 
 void reportErrorWithText(ErrorCode error, ASTNode node, TypeCheckContext context, const char *fallbackMsg);
-char *extractSourceLine(const char *source, int lineNum);
 
 /* semantic checks helpers */
 
@@ -55,6 +78,8 @@ int validateArrayInitialization(Symbol newSymbol, ASTNode initNode, DataType var
 int validateScalarInitialization(Symbol newSymbol, ASTNode node, DataType varType, int isConst, int isMemRef, TypeCheckContext context);
 int validateStructInlineInitialization(Symbol sym, ASTNode init, DataType type, int isConst, TypeCheckContext ctx);
 int containsReturnStatement(ASTNode node);
+Symbol declareFunction(ASTNode node, TypeCheckContext context);
+int validateFunctionBody(ASTNode node, Symbol funcSymbol, TypeCheckContext context);
 int validateStructDef(ASTNode node, TypeCheckContext context);
 int validateStructVarDec(ASTNode node, TypeCheckContext context);
 StructType createStructType(ASTNode node, TypeCheckContext context);
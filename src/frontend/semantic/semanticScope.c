@@ -1,48 +1,175 @@
 /**
  * @file semanticScope.c
- * @brief Scope stack and block-scope queue management.
+ * @brief Scope stack management.
  *
  * Responsibilities:
- *   - Block scope enqueue / dequeue for IR generation
+ *   - Scope stack: name -> innermost binding across the active scopes
+ *   - Base table: shared outer scope read through, never pushed
+ *   - Prelude of a pushed global table: read on a miss, never bound
  *
- * Note: createSymbolTable / freeSymbolTable live in semanticTable.c
- * because they are pure data-structure operations.
+ * Note: createSymbolTable lives in semanticTable.c because it is a pure
+ * data-structure operation.
  */
 
 #include "semanticInternal.h"
+#include "memTrack.h"
+
+#define SCOPE_STACK_MIN_CAPACITY 64
 
 /**
- * Scope queues are being used by the IR later on
+ * Scope stack
  */
 
-void enqueueBlockScope(TypeCheckContext context, SymbolTable scope) {
-    if (!context || !scope) return;
+ScopeStack createScopeStack(void) {
+    ScopeStack stack = trackedCalloc(MEM_SEMANTIC, 1, sizeof(struct ScopeStack));
+    if (!stack) return NULL;
+    stack->names = trackedCalloc(MEM_SEMANTIC, SCOPE_STACK_MIN_CAPACITY, sizeof(NameId));
+    stack->bindings = trackedCalloc(MEM_SEMANTIC, SCOPE_STACK_MIN_CAPACITY, sizeof(Symbol));
+    if (!stack->names || !stack->bindings) {
+        freeScopeStack(stack);
+        return NULL;
+    }
+    stack->capacity = SCOPE_STACK_MIN_CAPACITY;
+    return stack;
+}
+
+static void detachTables(ScopeStack stack) {
+    for (SymbolTable table = stack->top; table && table != stack->base; table = table->parent) {
+        table->stack = NULL;
+    }
+    stack->top = stack->base;
+    stack->preluded = NULL;
+}
 
-    BlockScopeNode node = malloc(sizeof(struct BlockScopeNode));
-    if (!node) return;
+void freeScopeStack(ScopeStack stack) {
+    if (!stack) return;
+    detachTables(stack);
+    trackedFree(MEM_SEMANTIC, stack->names);
+    trackedFree(MEM_SEMANTIC, stack->bindings);
+    trackedFree(MEM_SEMANTIC, stack);
+}
 
-    node->scope = scope;
-    node->next = NULL;
+/* Slot holding name, or the free slot where it would go */
+static uint32_t findSlot(const NameId *names, uint32_t capacity, NameId name) {
+    uint32_t mask = capacity - 1;
+    uint32_t i = nameHash(name) & mask;
+    while (names[i] != NAME_NONE && names[i] != name) i = (i + 1) & mask;
+    return i;
+}
 
-    if (context->blockScopesTail) {
-        context->blockScopesTail->next = node;
-    } else {
-        context->blockScopesHead = node;
+static int growStack(ScopeStack stack) {
+    uint32_t newCap = stack->capacity * 2;
+    NameId *names = trackedCalloc(MEM_SEMANTIC, newCap, sizeof(NameId));
+    Symbol *bindings = trackedCalloc(MEM_SEMANTIC, newCap, sizeof(Symbol));
+    if (!names || !bindings) {
+        trackedFree(MEM_SEMANTIC, names);
+        trackedFree(MEM_SEMANTIC, bindings);
+        return 0;
     }
-    context->blockScopesTail = node;
+    for (uint32_t i = 0; i < stack->capacity; i++) {
+        if (stack->names[i] == NAME_NONE) continue;
+        uint32_t slot = findSlot(names, newCap, stack->names[i]);
+        names[slot] = stack->names[i];
+        bindings[slot] = stack->bindings[i];
+    }
+    trackedFree(MEM_SEMANTIC, stack->names);
+    trackedFree(MEM_SEMANTIC, stack->bindings);
+    stack->names = names;
+    stack->bindings = bindings;
+    stack->capacity = newCap;
+    return 1;
 }
 
-SymbolTable dequeueBlockScope(TypeCheckContext context) {
-    if (!context || !context->blockScopesHead) return NULL;
+Symbol lookupBinding(ScopeStack stack, NameId name) {
+    return stack->bindings[findSlot(stack->names, stack->capacity, name)];
+}
 
-    BlockScopeNode node = context->blockScopesHead;
-    SymbolTable scope = node->scope;
+Symbol lookupBase(ScopeStack stack, NameId name) {
+    if (!stack->base) return NULL;
+    Symbol sym = lookupSymbol(stack->base, name);
+    // Same view as checking the module in order: nothing declared later
+    if (sym && stack->visibleBefore && sym->declaredAt > stack->visibleBefore) return NULL;
+    return sym;
+}
 
-    context->blockScopesHead = node->next;
-    if (!context->blockScopesHead) {
-        context->blockScopesTail = NULL;
+/*
+ * Names keep their slot after every binding is gone, so slots are never
+ * deleted and probe chains stay intact.
+ */
+void bindSymbol(ScopeStack stack, Symbol symbol) {
+    if (stack->used + 1 > stack->capacity / 2 && !growStack(stack)) {
+        // Without room the name would be invisible: empty the stack, lookups
+        // walk the tables until the next setCurrentScope() rebuilds it
+        detachTables(stack);
+        memset(stack->names, 0, stack->capacity * sizeof(NameId));
+        memset(stack->bindings, 0, stack->capacity * sizeof(Symbol));
+        stack->used = 0;
+        return;
     }
+    uint32_t slot = findSlot(stack->names, stack->capacity, symbol->name);
+    if (stack->names[slot] == NAME_NONE) {
+        stack->names[slot] = symbol->name;
+        stack->used++;
+    }
+
+    // Usually the innermost, but a symbol added to an outer scope goes under the inner ones
+    Symbol *link = &stack->bindings[slot];
+    while (*link && (*link)->scope > symbol->scope) link = &(*link)->shadowed;
+    symbol->shadowed = *link;
+    *link = symbol;
+}
 
-    free(node);
-    return scope;
-}
\ No newline at end of file
+static void unbindSymbol(ScopeStack stack, Symbol symbol) {
+    Symbol *link = &stack->bindings[findSlot(stack->names, stack->capacity, symbol->name)];
+    while (*link && *link != symbol) link = &(*link)->shadowed;
+    if (*link) *link = symbol->shadowed;
+    symbol->shadowed = NULL;
+}
+
+static void pushScope(ScopeStack stack, SymbolTable table) {
+    table->stack = stack;
+    stack->top = table;
+    // Binding shared symbols would write their shadowed links
+    if (table->preludeCount) stack->preluded = table;
+    for (int i = 0; i < table->bucketCount; i++) {
+        for (Symbol sym = table->symbols[i]; sym; sym = sym->next) {
+            bindSymbol(stack, sym);
+            if (stack->top != table) return;
+        }
+    }
+}
+
+static void popScope(ScopeStack stack) {
+    SymbolTable table = stack->top;
+    for (int i = 0; i < table->bucketCount; i++) {
+        for (Symbol sym = table->symbols[i]; sym; sym = sym->next) unbindSymbol(stack, sym);
+    }
+    table->stack = NULL;
+    stack->top = table->parent;
+    if (stack->preluded == table) stack->preluded = NULL;
+}
+
+static int isAncestorOrSelf(SymbolTable ancestor, SymbolTable table) {
+    for (; table; table = table->parent) {
+        if (table == ancestor) return 1;
+    }
+    return 0;
+}
+
+/* Push table's chain from just above the current top, outermost first */
+static void pushChain(ScopeStack stack, SymbolTable table) {
+    if (!table || table == stack->top || table == stack->base) return;
+    pushChain(stack, table->parent);
+    if (stack->top == table->parent) pushScope(stack, table);
+}
+
+void setCurrentScope(TypeCheckContext context, SymbolTable table) {
+    context->current = table;
+    ScopeStack stack = context->scopes;
+    if (!stack) return;
+
+    while (stack->top && stack->top != stack->base && !isAncestorOrSelf(stack->top, table)) {
+        popScope(stack);
+    }
+    pushChain(stack, table);
+}
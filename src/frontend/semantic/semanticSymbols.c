@@ -4,17 +4,138 @@
  *
  * Responsibilities:
  *   - Identifier resolution with error reporting
+ *   - Node annotations (resolved type and symbol per AST node)
  *   - AST node-type → DataType conversion
  *
  * No type compatibility logic lives here.
  */
 
 #include "semanticInternal.h"
+#include "memTrack.h"
 
-/* This are just two helpers */
+#define ANNOTATIONS_MIN_CAPACITY 256
+
+/**
+ * Node annotations
+ */
+
+NodeInfo *annotateNode(TypeCheckContext context, ASTNode node) {
+    if (!node) return NULL;
+    if (node->info) return &context->annotations[node->info];
+
+    if (context->annotationCount == context->annotationCapacity) {
+        uint32_t newCap = context->annotationCapacity ? context->annotationCapacity * 2
+                                                      : ANNOTATIONS_MIN_CAPACITY;
+        NodeInfo *grown = trackedRealloc(MEM_SEMANTIC, context->annotations, newCap * sizeof(NodeInfo));
+        if (!grown) {
+            repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to grow node annotations");
+            return NULL;
+        }
+        context->annotations = grown;
+        if (context->annotatedNodes) {
+            ASTNode *nodes = trackedRealloc(MEM_SEMANTIC, context->annotatedNodes, newCap * sizeof(ASTNode));
+            if (!nodes) {
+                repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to grow node annotations");
+                return NULL;
+            }
+            context->annotatedNodes = nodes;
+        }
+        context->annotationCapacity = newCap;
+        // Slot 0 stands for "not annotated"
+        if (context->annotationCount == 0) context->annotationCount = 1;
+    }
+
+    node->info = context->annotationCount++;
+    if (context->annotatedNodes) context->annotatedNodes[node->info] = node;
+    NodeInfo *info = &context->annotations[node->info];
+    info->type = TYPE_UNKNOWN;
+    info->pointerLevel = 0;
+    info->structType = NULL;
+    info->symbol = NULL;
+    return info;
+}
+
+void annotateSymbol(TypeCheckContext context, ASTNode node, Symbol sym) {
+    if (!sym) return;
+    NodeInfo *info = annotateNode(context, node);
+    if (info) info->symbol = sym;
+}
+
+void annotateType(TypeCheckContext context, ASTNode node, DataType type) {
+    if (!node || (type == TYPE_UNKNOWN && !node->info)) return;
+    NodeInfo *info = annotateNode(context, node);
+    if (!info) return;
+    info->type = type;
+    // By now the declaration that made the symbol has filled it in
+    Symbol sym = info->symbol;
+    if (sym) {
+        info->structType = sym->structType;
+        info->pointerLevel = sym->symbolType == SYMBOL_FUNCTION ? sym->returnPointerLevel : sym->pointerLvl;
+    }
+}
+
+int trackAnnotatedNodes(TypeCheckContext context) {
+    context->annotations = trackedMalloc(MEM_SEMANTIC, ANNOTATIONS_MIN_CAPACITY * sizeof(NodeInfo));
+    context->annotatedNodes = trackedMalloc(MEM_SEMANTIC, ANNOTATIONS_MIN_CAPACITY * sizeof(ASTNode));
+    if (!context->annotations || !context->annotatedNodes) {
+        trackedFree(MEM_SEMANTIC, context->annotations);
+        trackedFree(MEM_SEMANTIC, context->annotatedNodes);
+        context->annotations = NULL;
+        context->annotatedNodes = NULL;
+        return 0;
+    }
+    context->annotationCount = 1;
+    context->annotationCapacity = ANNOTATIONS_MIN_CAPACITY;
+    return 1;
+}
+
+int reserveAnnotations(TypeCheckContext context, uint32_t count) {
+    if (count <= context->annotationCapacity) return 1;
+    uint32_t newCap = context->annotationCapacity ? context->annotationCapacity : ANNOTATIONS_MIN_CAPACITY;
+    while (newCap < count) newCap *= 2;
+    NodeInfo *grown = trackedRealloc(MEM_SEMANTIC, context->annotations, newCap * sizeof(NodeInfo));
+    if (!grown) {
+        repError(ERROR_MEMORY_ALLOCATION_FAILED, "Failed to grow node annotations");
+        return 0;
+    }
+    context->annotations = grown;
+    context->annotationCapacity = newCap;
+    return 1;
+}
+
+void moveAnnotations(TypeCheckContext into, uint32_t base, TypeCheckContext from) {
+    uint32_t added = from->annotationCount - 1;
+    memcpy(&into->annotations[base], &from->annotations[1], added * sizeof(NodeInfo));
+    for (uint32_t i = 1; i <= added; i++) from->annotatedNodes[i]->info = base + i - 1;
+}
+
+const NodeInfo *nodeInfo(TypeCheckContext context, ASTNode node) {
+    if (!context || !node || !node->info || node->info >= context->annotationCount) return NULL;
+    return &context->annotations[node->info];
+}
+
+Symbol nodeSymbol(TypeCheckContext context, ASTNode node) {
+    const NodeInfo *info = nodeInfo(context, node);
+    return info ? info->symbol : NULL;
+}
+
+DataType nodeDataType(TypeCheckContext context, ASTNode node) {
+    const NodeInfo *info = nodeInfo(context, node);
+    return info ? info->type : TYPE_UNKNOWN;
+}
+
+/**
+ * Resolution
+ */
+
+Symbol resolveSymbol(TypeCheckContext context, ASTNode node) {
+    Symbol sym = lookupSymbol(context->current, node->name);
+    annotateSymbol(context, node, sym);
+    return sym;
+}
 
 Symbol lookupSymbolOrError(TypeCheckContext context, ASTNode node) {
-    Symbol sym = lookupSymbol(context->current, node->start, node->length);
+    Symbol sym = resolveSymbol(context, node);
     if (!sym) {
         reportErrorWithText(ERROR_UNDEFINED_VARIABLE, node, context, "Undefined variable");
     }
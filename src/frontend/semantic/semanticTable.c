@@ -3,78 +3,45 @@
  * @brief Symbol table data structure implementation.
  *
  * Responsibilities:
- *   - Symbol table creation / destruction
+ *   - Symbol table creation (teardown is freeing the module's arena)
  *   - Symbol insertion (variable & function)
- *   - Symbol lookup (current-only and scope-walking)
- *   - Parameter list creation / destruction
+ *   - Symbol lookup (current-only, scope-walking, or one probe from a scope stack top)
+ *   - Prelude tables read under a global table
+ *   - Parameter creation
  *
  * Pure data structure — no semantic rules live here.
  */
 
 #include "semanticInternal.h"
-
-void freeSymbol(Symbol symbol) {
-    if (symbol == NULL) return;
-    if (symbol->symbolType == SYMBOL_FUNCTION && symbol->parameters) {
-        freeParamList(symbol->parameters);
-    }
-    free(symbol);
-}
-
-void freeSymbolTable(SymbolTable table) {
-    if (!table) return;
-
-    SymbolTable child = table->child;
-    while (child) {
-        SymbolTable nextChild = child->brother;
-        freeSymbolTable(child);
-        child = nextChild;
-    }
-
-    for (int i = 0; i < table->bucketCount; i++) {
-        Symbol current = table->symbols[i];
-        while (current) {
-            Symbol next = current->next;
-            freeSymbol(current);
-            current = next;
-        }
-    }
-
-    free(table->symbols);
-    free(table);
-}
+#include "arena.h"
 
 /**
  * symbols Hashtable operations 
  */
 
-/* hash documentation http://www.isthe.com/chongo/tech/comp/fnv/ */
-static uint32_t hashName(const char* name, size_t len){
-    uint32_t hash = 2166136261u;
-    for (size_t i = 0; i < len; i++) {
-        hash ^= (unsigned char)name[i];
-        hash *= 16777619u;
-    }
-    return hash;
+/* Buckets reuse the hash the interner computed once per distinct name */
+static uint32_t bucketOf(NameId name, int bucketCount) {
+    return nameHash(name) & (uint32_t)(bucketCount - 1);
 }
 
+/* The old buckets stay in the arena (or inline) until the module is done */
 static int rehashTable(SymbolTable table){
     int newCount = table->bucketCount * 2;
-    Symbol* newBuckets = calloc(newCount, sizeof(Symbol));
+    Symbol* newBuckets = arenaAlloc(table->arena, newCount * sizeof(Symbol));
     if(!newBuckets) return 0;
+    memset(newBuckets, 0, newCount * sizeof(Symbol));
 
     for(int i = 0; i < table->bucketCount; ++i){
         Symbol current = table->symbols[i];
         while(current){
             Symbol next = current->next;
-            uint32_t index = hashName(current->nameStart, current->nameLength) & (newCount - 1);
+            uint32_t index = bucketOf(current->name, newCount);
             current->next = newBuckets[index];
             newBuckets[index] = current;
             current = next;
         }
     }
 
-    free(table->symbols);
     table->symbols = newBuckets;
     table->bucketCount = newCount;
     return 1;
@@ -84,12 +51,13 @@ static int rehashTable(SymbolTable table){
  * Parammeter helpers
  */
 
-FunctionParameter createParameter(const char *nameStart, size_t nameLen, DataType type) {
-    FunctionParameter param = malloc(sizeof(struct FunctionParameter));
+FunctionParameter createParameter(Arena *arena, const char *nameStart, size_t nameLen, DataType type) {
+    FunctionParameter param = arenaAlloc(arena, sizeof(struct FunctionParameter));
     if (param == NULL) return NULL;
 
     param->nameStart = nameStart;
     param->nameLength = nameLen;
+    param->name = nameStart ? internName(nameStart, nameLen) : NAME_NONE;
     param->type = type;
     param->next = NULL;
     param->isPointer = 0;
@@ -97,80 +65,88 @@ FunctionParameter createParameter(const char *nameStart, size_t nameLen, DataTyp
     return param;
 }
 
-void freeParamList(FunctionParameter paramList) {
-    FunctionParameter current = paramList;
-    while (current != NULL) {
-        FunctionParameter next = current->next;
-        free(current);
-        current = next;
-    }
-}
-
 /**
  * Symbol table
  */
 
-SymbolTable createSymbolTable(SymbolTable parent) {
-    SymbolTable table = malloc(sizeof(struct SymbolTable));
+SymbolTable createSymbolTable(Arena *arena, SymbolTable parent) {
+    SymbolTable table = arena ? arenaAlloc(arena, sizeof(struct SymbolTable)) : NULL;
     if (table == NULL) return NULL;
 
-    table->symbols = calloc(SYMBOL_TABLE_BUCKETS, sizeof(Symbol));
-    if (!table->symbols) {
-        free(table);
-        return NULL;
-    }
-    table->bucketCount = SYMBOL_TABLE_BUCKETS;
+    memset(table->inlineBuckets, 0, sizeof(table->inlineBuckets));
+    table->symbols = table->inlineBuckets;
+    table->bucketCount = SYMBOL_TABLE_INLINE_BUCKETS;
+    table->arena = arena;
     table->parent = parent;
-    table->child = NULL;
-    table->brother = NULL;
     table->scope = (parent == NULL) ? 0 : parent->scope + 1;
     table->symbolCount = 0;
-
-    /* Register as child of parent */
-    if (parent != NULL) {
-        table->brother = parent->child;
-        parent->child = table;
-    }
+    table->stack = NULL;
+    table->prelude = NULL;
+    table->preludeCount = 0;
+    table->preludeCapacity = 0;
 
     return table;
 }
 
+/* Like the buckets, an outgrown array stays in the arena until the module is done */
+int addPreludeTable(SymbolTable table, SymbolTable frozen) {
+    if (!table || !frozen) return 0;
+
+    if (table->preludeCount == table->preludeCapacity) {
+        int newCapacity = table->preludeCapacity ? table->preludeCapacity * 2 : 4;
+        SymbolTable *prelude = arenaAlloc(table->arena, newCapacity * sizeof(SymbolTable));
+        if (!prelude) return 0;
+        if (table->preludeCount) memcpy(prelude, table->prelude, table->preludeCount * sizeof(SymbolTable));
+        table->prelude = prelude;
+        table->preludeCapacity = newCapacity;
+    }
+    table->prelude[table->preludeCount++] = frozen;
+    if (table->stack) table->stack->preluded = table;
+    return 1;
+}
+
 /** 
  * Look up table
  */
 
-Symbol lookupSymbolCurrentOnly(SymbolTable table, const char *nameStart, size_t nameLength) {
-    if (!table || !nameStart) return NULL;
-
-    uint32_t index = hashName(nameStart, nameLength) & (table->bucketCount - 1);
-    Symbol current = table->symbols[index];
+static Symbol lookupOwn(SymbolTable table, NameId name) {
+    Symbol current = table->symbols[bucketOf(name, table->bucketCount)];
     while (current) {
-        if (current->nameLength == nameLength &&
-            memcmp(current->nameStart, nameStart, nameLength) == 0) {
-            return current;
-        }
+        if (current->name == name) return current;
         current = current->next;
     }
     return NULL;
 }
 
-Symbol lookupSymbol(SymbolTable table, const char *nameStart, size_t nameLength) {
-    if (!table || !nameStart) return NULL;
-
-    uint32_t index = hashName(nameStart, nameLength) & (table->bucketCount - 1);
-    Symbol current = table->symbols[index];
-    while (current != NULL) {
-        if (current->nameLength == nameLength &&
-            memcmp(current->nameStart, nameStart, nameLength) == 0) {
-            return current;
-        }
-        current = current->next;
+Symbol lookupPrelude(SymbolTable table, NameId name) {
+    for (int i = 0; i < table->preludeCount; i++) {
+        Symbol sym = lookupOwn(table->prelude[i], name);
+        if (sym) return sym;
     }
+    return NULL;
+}
 
-    if (table->parent != NULL) {
-        return lookupSymbol(table->parent, nameStart, nameLength);
+Symbol lookupSymbolCurrentOnly(SymbolTable table, NameId name) {
+    if (!table || name == NAME_NONE) return NULL;
+
+    Symbol sym = lookupOwn(table, name);
+    return sym ? sym : lookupPrelude(table, name);
+}
+
+Symbol lookupSymbol(SymbolTable table, NameId name) {
+    if (name == NAME_NONE) return NULL;
+    // The top of a scope stack sees exactly the stack's bindings
+    if (table && table->stack && table->stack->top == table) {
+        ScopeStack stack = table->stack;
+        Symbol sym = lookupBinding(stack, name);
+        if (!sym) sym = lookupBase(stack, name);
+        return (sym || !stack->preluded) ? sym : lookupPrelude(stack->preluded, name);
     }
 
+    for (; table; table = table->parent) {
+        Symbol sym = lookupSymbolCurrentOnly(table, name);
+        if (sym) return sym;
+    }
     return NULL;
 }
 
@@ -178,85 +154,88 @@ Symbol lookupSymbol(SymbolTable table, const char *nameStart, size_t nameLength)
  * add symbols
  */
 
-Symbol addSymbol(SymbolTable table, const char *nameStart, size_t nameLength, DataType type, int line, int column) {
-    if (!table || !nameStart) return NULL;
+Symbol addSymbol(SymbolTable table, NameId name, DataType type, const char *declaredAt) {
+    if (!table || name == NAME_NONE) return NULL;
 
-    Symbol existing = lookupSymbolCurrentOnly(table, nameStart, nameLength);
+    Symbol existing = lookupSymbolCurrentOnly(table, name);
     if (existing) return NULL;
 
     if(table->symbolCount >= table->bucketCount * SYMBOL_TABLE_LOAD_FACTOR){
         rehashTable(table);
     }
 
-    Symbol newSymbol = malloc(sizeof(struct Symbol));
+    Symbol newSymbol = arenaAlloc(table->arena, sizeof(struct Symbol));
     if (newSymbol == NULL) return NULL;
     memset(newSymbol, 0, sizeof(struct Symbol));
 
-    newSymbol->nameStart = nameStart;
-    newSymbol->nameLength = nameLength;
+    newSymbol->nameStart = nameText(name);
+    newSymbol->nameLength = nameLength(name);
+    newSymbol->name = name;
     newSymbol->symbolType = SYMBOL_VARIABLE;
     newSymbol->type = type;
-    newSymbol->line = line;
-    newSymbol->column = column;
+    newSymbol->declaredAt = declaredAt;
     newSymbol->scope = table->scope;
     newSymbol->isInitialized = 0;
     newSymbol->parameters = NULL;
     newSymbol->paramCount = 0;
     newSymbol->baseType = type;
+    newSymbol->constValue.type = TYPE_UNKNOWN;
 
-    uint32_t index = hashName(nameStart, nameLength) & (table->bucketCount - 1);
+    uint32_t index = bucketOf(name, table->bucketCount);
     newSymbol->next = table->symbols[index];
     table->symbols[index] = newSymbol;
     table->symbolCount++;
+    if (table->stack) bindSymbol(table->stack, newSymbol);
 
     return newSymbol;
 }
 
 Symbol addSymbolFromNode(SymbolTable table, ASTNode node, DataType type) {
     if (!node) return NULL;
-    return addSymbol(table, node->start, node->length, type, node->line, node->column);
+    return addSymbol(table, node->name, type, node->start);
 }
 
-static Symbol addFunctionSymbol(SymbolTable symbolTable, const char *nameStart, size_t nameLength, DataType returnType, FunctionParameter parameters, int paramCount, int line, int column) {
-    if (!symbolTable || !nameStart) return NULL;
+static Symbol addFunctionSymbol(SymbolTable symbolTable, NameId name, DataType returnType, FunctionParameter parameters, int paramCount, const char *declaredAt) {
+    if (!symbolTable || name == NAME_NONE) return NULL;
 
-    Symbol exists = lookupSymbol(symbolTable, nameStart, nameLength);
+    Symbol exists = lookupSymbol(symbolTable, name);
     if (exists) return NULL;
 
     if(symbolTable->symbolCount >= symbolTable->bucketCount * SYMBOL_TABLE_LOAD_FACTOR){
         rehashTable(symbolTable);
     }
 
-    Symbol newSymbol = malloc(sizeof(struct Symbol));
+    Symbol newSymbol = arenaAlloc(symbolTable->arena, sizeof(struct Symbol));
     if (!newSymbol) return NULL;
     memset(newSymbol, 0, sizeof(struct Symbol));
 
-    newSymbol->nameStart = nameStart;
-    newSymbol->nameLength = nameLength;
+    newSymbol->nameStart = nameText(name);
+    newSymbol->nameLength = nameLength(name);
+    newSymbol->name = name;
     newSymbol->symbolType = SYMBOL_FUNCTION;
     newSymbol->type = returnType;
-    newSymbol->line = line;
-    newSymbol->column = column;
+    newSymbol->declaredAt = declaredAt;
     newSymbol->scope = symbolTable->scope;
     newSymbol->isInitialized = 1;
     newSymbol->parameters = parameters;
     newSymbol->paramCount = paramCount;
     newSymbol->functionScope = NULL;
 
-    uint32_t index = hashName(nameStart, nameLength) & (symbolTable->bucketCount - 1);
+    uint32_t index = bucketOf(name, symbolTable->bucketCount);
     newSymbol->next = symbolTable->symbols[index];
     symbolTable->symbols[index] = newSymbol;
     symbolTable->symbolCount++;
+    if (symbolTable->stack) bindSymbol(symbolTable->stack, newSymbol);
 
     return newSymbol;
 }
 
 Symbol addFunctionSymbolFromNode(SymbolTable symbolTable, ASTNode node, DataType returnType, FunctionParameter parameters, int paramCount) {
     if (!node) return NULL;
-    return addFunctionSymbol(symbolTable, node->start, node->length, returnType, parameters, paramCount, node->line, node->column);
+    return addFunctionSymbol(symbolTable, node->name, returnType, parameters, paramCount, node->start);
 }
 
-Symbol addFunctionSymbolFromString(SymbolTable symbolTable, const char *name, DataType returnType, FunctionParameter parameters, int paramCount, int line, int column) {
+Symbol addFunctionSymbolFromString(SymbolTable symbolTable, const char *name, DataType returnType, FunctionParameter parameters, int paramCount, const char *declaredAt) {
     if (!name) return NULL;
-    return addFunctionSymbol(symbolTable, name, strlen(name), returnType, parameters, paramCount, line, column);
+    return addFunctionSymbol(symbolTable, internName(name, strlen(name)), returnType, parameters, paramCount, declaredAt);
 }
\ No newline at end of file
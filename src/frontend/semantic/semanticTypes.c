@@ -363,7 +363,7 @@ ResolvedType resolveMemberAccessType(ASTNode node, TypeCheckContext context) {
         structType = objResolved.structType;
 
     } else if (objectNode->nodeType == VARIABLE) {
-        Symbol objectSymbol = lookupSymbol(context->current, objectNode->start, objectNode->length);
+        Symbol objectSymbol = resolveSymbol(context, objectNode);
         if (!objectSymbol) {
             REPORT_ERROR(ERROR_UNDEFINED_VARIABLE, objectNode, context,
                         "Undefined variable in member access");
@@ -386,8 +386,7 @@ ResolvedType resolveMemberAccessType(ASTNode node, TypeCheckContext context) {
 
     StructField field = structType->fields;
     while (field) {
-        if (field->nameLength == fieldNode->length &&
-            memcmp(field->nameStart, fieldNode->start, fieldNode->length) == 0) {
+        if (field->name == fieldNode->name) {
             result.type = field->type;
             result.structType = field->structType;
             return result;
@@ -400,11 +399,6 @@ ResolvedType resolveMemberAccessType(ASTNode node, TypeCheckContext context) {
     return result;
 }
 
-DataType validateMemberAccess(ASTNode node, TypeCheckContext context) {
-    ResolvedType resolved = resolveMemberAccessType(node, context);
-    return resolved.type;
-}
-
 /**
  * type inference
  */
@@ -425,7 +419,7 @@ static DataType inferIntLitType(DataType expectedType) {
     return TYPE_I32;
 }
 
-DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expectedType) {
+static DataType inferExpressionType(ASTNode node, TypeCheckContext context, DataType expectedType) {
     if (node == NULL) return TYPE_UNKNOWN;
     switch (node->nodeType) {
         case LITERAL: {
@@ -443,12 +437,10 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expe
                 case REF_U32:    return TYPE_U32;
                 case REF_U64:    return TYPE_U64;
                 case REF_INT_UNRESOLVED: {
-                    DataType resolved = inferIntLitType(expectedType);
-                    NodeTypes resolvedNode = symbolTypeToNodeType(resolved);
-                    if (resolvedNode != null_NODE) {
-                        node->children->nodeType = resolvedNode;
-                    }
-                    return resolved;
+                    // The first resolution sticks; it lives in the annotation, not the
+                    // tree, so a cached tree is resolved again against new imports
+                    DataType resolved = nodeDataType(context, node);
+                    return isIntegerType(resolved) ? resolved : inferIntLitType(expectedType);
                 }
                 case REF_FLOAT:  return TYPE_FLOAT;
                 case REF_BOOL:   return TYPE_BOOL;
@@ -472,7 +464,7 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expe
             if (!current) return TYPE_UNKNOWN;
 
             if (current->nodeType == VARIABLE) {
-                Symbol ptrSym = lookupSymbol(context->current, current->start, current->length);
+                Symbol ptrSym = resolveSymbol(context, current);
                 if (!ptrSym || !ptrSym->isPointer) {
                     REPORT_ERROR(ERROR_INVALID_OPERATION_FOR_TYPE, node, context,
                                 "Cannot dereference non-pointer");
@@ -495,7 +487,7 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expe
             if (current->nodeType == ARRAY_ACCESS) {
                 ASTNode arrayNode = current->children;
                 if (arrayNode && arrayNode->nodeType == VARIABLE) {
-                    Symbol arraySym = lookupSymbol(context->current, arrayNode->start, arrayNode->length);
+                    Symbol arraySym = resolveSymbol(context, arrayNode);
 
                     if (!arraySym) {
                         REPORT_ERROR(ERROR_UNDEFINED_VARIABLE, current, context,
@@ -524,7 +516,7 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expe
         }
 
         case VARIABLE: {
-            Symbol sym = lookupSymbol(context->current, node->start, node->length);
+            Symbol sym = resolveSymbol(context, node);
             if (!sym) {
                 reportErrorWithText(ERROR_UNDEFINED_VARIABLE, node, context, "Undefined variable");
                 return TYPE_UNKNOWN;
@@ -535,7 +527,7 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expe
         case ARRAY_ACCESS: {
             if (!validateArrayAccessNode(node, context)) return TYPE_UNKNOWN;
             ASTNode arrayNode = node->children;
-            Symbol arraySym = lookupSymbol(context->current, arrayNode->start, arrayNode->length);
+            Symbol arraySym = resolveSymbol(context, arrayNode);
             if (!arraySym) return TYPE_UNKNOWN;
             if (arraySym->isPointer) return arraySym->baseType;
             return arraySym->type;
@@ -642,15 +634,19 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expe
                 return TYPE_UNKNOWN;
             }
 
-            Symbol funcSymbol = lookupSymbol(context->current, node->start, node->length);
+            Symbol funcSymbol = resolveSymbol(context, node);
             if (funcSymbol != NULL && funcSymbol->symbolType == SYMBOL_FUNCTION) {
                 return funcSymbol->type;
             }
             return TYPE_UNKNOWN;
         }
 
-        case MEMBER_ACCESS:
-            return validateMemberAccess(node, context);
+        case MEMBER_ACCESS: {
+            ResolvedType resolved = resolveMemberAccessType(node, context);
+            NodeInfo *info = resolved.structType ? annotateNode(context, node) : NULL;
+            if (info) info->structType = resolved.structType;
+            return resolved.type;
+        }
 
         case TERNARY_CONDITIONAL: {
             if (!node->children || !node->children->brothers) return TYPE_UNKNOWN;
@@ -685,6 +681,13 @@ DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expe
     }
 }
 
+/* Every inferred expression keeps its type for IR generation */
+DataType getExpressionType(ASTNode node, TypeCheckContext context, DataType expectedType) {
+    DataType type = inferExpressionType(node, context, expectedType);
+    annotateType(context, node, type);
+    return type;
+}
+
 /* return type */
 
 DataType getReturnTypeFromNode(ASTNode returnTypeNode, int *outPointerLevel) {
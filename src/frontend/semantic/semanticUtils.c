@@ -5,61 +5,36 @@
  * Responsibilities:
  *   - Error context creation from AST nodes
  *   - Error reporting with text extraction
- *   - Source line extraction
+ *   - Source line and column lookup
  *   - Error context cleanup
  *
  * These helpers don't belong to types, symbols, scopes, or built-ins.
  */
 
 #include "semanticInternal.h"
-
-char *extractSourceLine(const char *source, int lineNum) {
-    if (!source || lineNum <= 0) return NULL;
-
-    const char *lineStart = source;
-    int currentLine = 1;
-
-    /* Find the start of the requested line */
-    while (*lineStart && currentLine < lineNum) {
-        if (*lineStart == '\n') {
-            currentLine++;
-        }
-        lineStart++;
-    }
-
-    if (*lineStart == '\0') return NULL;
-
-    /* Find the end of the line */
-    const char *lineEnd = lineStart;
-    while (*lineEnd && *lineEnd != '\n') {
-        lineEnd++;
-    }
-
-    /* Create the line string */
-    size_t lineLength = lineEnd - lineStart;
-    char *line = malloc(lineLength + 1);
-    if (line) {
-        strncpy(line, lineStart, lineLength);
-        line[lineLength] = '\0';
-    }
-
-    return line;
-}
+#include "memTrack.h"
 
 ErrorContext *createErrorContextFromType(ASTNode node, TypeCheckContext context) {
     if (!node || !context) return NULL;
-    ErrorContext *errCtx = malloc(sizeof(ErrorContext));
+    ErrorContext *errCtx = trackedMalloc(MEM_SEMANTIC, sizeof(ErrorContext));
     if (!errCtx) return NULL;
-    char *sourceLine = NULL;
-    if (context->sourceFile) {
-        sourceLine = extractSourceLine(context->sourceFile, node->line);
+    SourceFile *source = context->source;
+    SourceLocation loc = {0, 0};
+    uint32_t lineLength = 0;
+    errCtx->source = NULL;
+    // Synthetic nodes have no text, and imported ones point outside this source
+    if (source && node->start && node->start >= source->data &&
+        node->start <= source->data + source->length) {
+        uint32_t offset = (uint32_t)(node->start - source->data);
+        loc = sourceLocation(source, offset);
+        errCtx->source = sourceLineAt(source, offset, &lineLength);
     }
     errCtx->file = context->filename ? context->filename : "source";
-    errCtx->line = node->line;
-    errCtx->column = node->column;
-    errCtx->source = sourceLine;
+    errCtx->line = loc.line;
+    errCtx->column = loc.column;
+    errCtx->sourceLength = lineLength;
     errCtx->length = node->length;
-    errCtx->startColumn = node->column;
+    errCtx->startColumn = loc.column;
     return errCtx;
 }
 
@@ -67,12 +42,9 @@ void reportErrorWithText(ErrorCode error, ASTNode node, TypeCheckContext context
                          const char *fallbackMsg) {
     char *tempText = extractText(node->start, node->length);
     REPORT_ERROR(error, node, context, tempText ? tempText : fallbackMsg);
-    free(tempText);
+    trackedFree(MEM_SEMANTIC, tempText);
 }
 
 void freeErrorContext(ErrorContext *errCtx) {
-    if (errCtx) {
-        free(errCtx->source);
-        free(errCtx);
-    }
+    trackedFree(MEM_SEMANTIC, errCtx);
 }
\ No newline at end of file
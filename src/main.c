@@ -11,6 +11,14 @@ void printUsage(const char* programName) {
     printf("    --verbose    Show build steps\n");
     printf("    --ir         Show intermediate representation for all modules\n");
     printf("    --ast        Show AST for all modules\n");
+    printf("    --no-cache   Ignore the build cache and recompile every module\n");
+    printf("    -j<N>        Discover, lex and type check on N threads (default: one per CPU)\n");
+    printf("    --time-report\n");
+    printf("                 Print time spent in each compiler phase\n");
+    printf("    --mem-report\n");
+    printf("                 Print allocations per subsystem and per phase, and peak RSS\n");
+    printf("    --trace=<file>\n");
+    printf("                 Write Chrome trace-event JSON of every phase to <file>\n");
     printf("    -O0          No optimization (default)\n");
     printf("    -O1          Basic optimization (3 passes)\n");
     printf("    -O2          Moderate optimization (5 passes)\n");
@@ -30,6 +38,11 @@ int main(int argc, char* argv[]) {
     int showAST = 0;
     int showIR = 0;
     int optLvl = 0;
+    int useCache = 1;
+    int jobs = 0;
+    int timeReport = 0;
+    int memReport = 0;
+    const char *tracePath = NULL;
 
     if (argc < 2) {
         printUsage(argv[0]);
@@ -50,6 +63,30 @@ int main(int argc, char* argv[]) {
         else if (strcmp(argv[i], "--ir") == 0) {
             showIR = 1;
         }
+        else if (strcmp(argv[i], "--no-cache") == 0) {
+            useCache = 0;
+        }
+        else if (strcmp(argv[i], "--time-report") == 0) {
+            timeReport = 1;
+        }
+        else if (strcmp(argv[i], "--mem-report") == 0) {
+            memReport = 1;
+        }
+        else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            tracePath = argv[i] + 8;
+            if (*tracePath == '\0') {
+                fprintf(stderr, "Error: --trace= requires a file name\n");
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "-j", 2) == 0) {
+            char *end;
+            jobs = (int)strtol(argv[i] + 2, &end, 10);
+            if (argv[i][2] == '\0' || *end != '\0' || jobs < 1) {
+                fprintf(stderr, "Invalid job count: %s (use -j<N>, N >= 1)\n", argv[i]);
+                return 1;
+            }
+        }
         else if (strcmp(argv[i], "-o") == 0) {
             if (i + 1 < argc) {
                 outputFile = argv[++i];
@@ -97,7 +134,18 @@ int main(int argc, char* argv[]) {
     }
 
     // Build project
-    if (!buildProject(inputFile, exeFile, optLvl, verbose, showAST, showIR)) {
+    BuildOptions opts = {
+        .optLevel = optLvl,
+        .verbose = verbose,
+        .showAST = showAST,
+        .showIR = showIR,
+        .useCache = useCache,
+        .jobs = jobs,
+        .timeReport = timeReport,
+        .tracePath = tracePath,
+        .memReport = memReport,
+    };
+    if (!buildProject(inputFile, exeFile, &opts)) {
         return 1;
     }
 
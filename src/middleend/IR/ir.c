@@ -3,9 +3,10 @@
 #include <stdio.h>
 #include "semantic.h"
 #include "irHelpers.h"
+#include "memTrack.h"
 
 IrContext *createIrContext(){
-    IrContext *ctx = malloc(sizeof(IrContext));
+    IrContext *ctx = trackedMalloc(MEM_IR, sizeof(IrContext));
     if(!ctx) return NULL;
 
     ctx->instructions = NULL;
@@ -14,6 +15,7 @@ IrContext *createIrContext(){
     ctx->nextTempNum = 1;
     ctx->nextLabelNum = 1;
     ctx->pendingJumps = NULL;
+    ctx->compileTime = NULL;
     return ctx;
 }
 
@@ -23,11 +25,12 @@ void freeIrContext(IrContext *ctx) {
     IrInstruction *inst = ctx->instructions;
     while (inst) {
         IrInstruction *next = inst->next;
-        free(inst);
+        trackedFree(MEM_IR, inst);
         inst = next;
     }
     
-    free(ctx);
+    freeIrContext(ctx->compileTime);
+    trackedFree(MEM_IR, ctx);
 }
 
 IrOperand createTemp(IrContext *ctx, IrDataType type){
@@ -38,12 +41,13 @@ IrOperand createTemp(IrContext *ctx, IrDataType type){
     };
 }
 
-IrOperand createVar(const char *name, size_t len, IrDataType type){
+IrOperand createVar(NameId name, IrDataType type){
     return (IrOperand){
         .type = OPERAND_VAR,
         .dataType = type,
-        .value.var.name = name,
-        .value.var.nameLen = len
+        .value.var.name = nameText(name),
+        .value.var.nameLen = nameLength(name),
+        .value.var.id = name
     };
 }
 
@@ -85,6 +89,16 @@ IrOperand createStringConst(const char* val, size_t len){
     return op;
 }
 
+// A value the type checker worked out, in the IR type of its own type
+IrOperand createValueConst(ConstValue value){
+    switch (value.type) {
+        case TYPE_FLOAT:  return createFloatConst((float)value.floatVal);
+        case TYPE_DOUBLE: return createDoubleConst(value.floatVal);
+        case TYPE_BOOL:   return createBoolConst((int)value.intVal);
+        default:          return createSizedIntConst(value.intVal, symbolTypeToIrType(value.type));
+    }
+}
+
 IrOperand createLabel(int label){
     return (IrOperand){
         .type = OPERAND_LABEL,
@@ -93,14 +107,20 @@ IrOperand createLabel(int label){
     };
 }
 
-IrOperand createFn(const char *start, size_t len){
+IrOperand createFn(NameId name){
     return (IrOperand) {
         .type = OPERAND_FUNCTION,
-        .value.fn.name = start,
-        .value.fn.nameLen = len
+        .value.fn.name = nameText(name),
+        .value.fn.nameLen = nameLength(name),
+        .value.fn.id = name
     };
 }
 
+/* Slot holding the caller's buffer address for functions returning a struct */
+static NameId hiddenPtrName(void) {
+    return internName("__hidden_ptr", 12);
+}
+
 IrOperand createNone(){
     return (IrOperand){
         .type = OPERAND_NONE,
@@ -129,7 +149,7 @@ void appendInstruction(IrContext *ctx, IrInstruction *inst){
 }
 
 IrInstruction *emitBinary(IrContext *ctx, IrOpCode op, IrOperand res, IrOperand ar1, IrOperand ar2){
-    IrInstruction *inst = malloc(sizeof(IrInstruction));
+    IrInstruction *inst = trackedMalloc(MEM_IR, sizeof(IrInstruction));
     if(!inst) return NULL;
 
     inst->op = op;
@@ -189,13 +209,8 @@ IrInstruction *emitPointerStore(IrContext *ctx, IrOperand base, IrOperand off, I
     return emitBinary(ctx, IR_POINTER_STORE, base, off, val);
 }
 
-IrInstruction *emitCall(IrContext *ctx, IrOperand res, const char *fnName, 
-                        size_t nameLen, int params) {
-    IrOperand func = (IrOperand) {
-        .type = OPERAND_FUNCTION,
-        .value.fn.name = fnName,
-        .value.fn.nameLen = nameLen
-    };  
+IrInstruction *emitCall(IrContext *ctx, IrOperand res, NameId fnName, int params) {
+    IrOperand func = createFn(fnName);
     
     IrOperand paramCount = createSizedIntConst(params, IR_TYPE_I32);
     
@@ -203,7 +218,7 @@ IrInstruction *emitCall(IrContext *ctx, IrOperand res, const char *fnName,
 }
 
 IrInstruction *emitMemberStore(IrContext *ctx, IrOperand structVar, int offset, IrOperand val){
-    IrInstruction *inst = malloc(sizeof(struct IrInstruction));
+    IrInstruction *inst = trackedMalloc(MEM_IR, sizeof(struct IrInstruction));
     if(!inst) return NULL;
     inst->op = IR_MEMBER_STORE;
     inst->result = structVar;
@@ -217,7 +232,7 @@ IrInstruction *emitMemberStore(IrContext *ctx, IrOperand structVar, int offset,
 }
 
 IrInstruction *emitMemberLoad(IrContext *ctx, IrOperand dest, IrOperand structVar, int offset){
-    IrInstruction *inst = malloc(sizeof(struct IrInstruction));
+    IrInstruction *inst = trackedMalloc(MEM_IR, sizeof(struct IrInstruction));
     if(!inst) return NULL;
     inst->op = IR_MEMBER_LOAD;
     inst->result = dest;
@@ -231,7 +246,7 @@ IrInstruction *emitMemberLoad(IrContext *ctx, IrOperand dest, IrOperand structVa
 }
 
 IrInstruction *emitAllocStruct(IrContext *ctx, IrOperand dest, int size){
-    IrInstruction *inst = malloc(sizeof(struct IrInstruction));
+    IrInstruction *inst = trackedMalloc(MEM_IR, sizeof(struct IrInstruction));
     if(!inst) return NULL;
     inst->op = IR_ALLOC_STRUCT;
     inst->result = dest;
@@ -369,7 +384,7 @@ IrOpCode astOpToIrOp(NodeTypes nodeType) {
 }
 
 static MemberAccessInfo resolveMemberAccessChain(ASTNode node, TypeCheckContext typeCtx, IrContext *irCtx) {
-    MemberAccessInfo info = { NULL, 0, 0, NULL, TYPE_UNKNOWN, 0, 0 };
+    MemberAccessInfo info = { NAME_NONE, 0, NULL, TYPE_UNKNOWN, 0, 0 };
     
     if (!node || node->nodeType != MEMBER_ACCESS) return info;
     
@@ -390,7 +405,7 @@ static MemberAccessInfo resolveMemberAccessChain(ASTNode node, TypeCheckContext
                     .value.temp.tempNum = info.baseTempNum
                 };
             } else {
-                base = createVar(info.baseName, info.baseNameLen, IR_TYPE_POINTER);
+                base = createVar(info.baseName, IR_TYPE_POINTER);
             }
 
             emitMemberLoad(irCtx, temp, base, info.totalOffset);
@@ -402,7 +417,7 @@ static MemberAccessInfo resolveMemberAccessChain(ASTNode node, TypeCheckContext
 
         StructField field = info.finalStructType->fields;
         while (field) {
-            if (bufferEqual(fieldNode->start, fieldNode->length, field->nameStart, field->nameLength)) {
+            if (field->name == fieldNode->name) {
                 info.totalOffset += field->offset;
                 info.finalStructType = field->structType;
                 info.fieldType = field->type;
@@ -410,20 +425,18 @@ static MemberAccessInfo resolveMemberAccessChain(ASTNode node, TypeCheckContext
             }
             field = field->next;
         }
-        info.baseName = NULL;
+        info.baseName = NAME_NONE;
         return info;
         
     } else if (objectNode->nodeType == VARIABLE) {
-        Symbol structSym = lookupSymbol(typeCtx->current, 
-                                        objectNode->start, objectNode->length);
+        Symbol structSym = nodeSymbol(typeCtx, objectNode);
         if (!structSym || !structSym->structType) return info;
         
-        info.baseName = objectNode->start;
-        info.baseNameLen = objectNode->length;
+        info.baseName = objectNode->name;
         
         StructField field = structSym->structType->fields;
         while (field) {
-            if (bufferEqual(fieldNode->start, fieldNode->length, field->nameStart, field->nameLength)) {
+            if (field->name == fieldNode->name) {
                 info.totalOffset = field->offset;
                 info.finalStructType = field->structType;
                 info.fieldType = field->type;
@@ -445,18 +458,13 @@ static void generateFunctionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
     ASTNode returnType = paramList->brothers;
     ASTNode body = returnType->brothers;
 
-    Symbol fnSymbol = lookupSymbol(typeCtx->current, node->start, node->length);
+    Symbol fnSymbol = nodeSymbol(typeCtx, node);
     if (!fnSymbol) return;
     
     Symbol oldFunction = typeCtx->currentFunction;
-    SymbolTable oldScope = typeCtx->current;
-    
     typeCtx->currentFunction = fnSymbol;
-    if (fnSymbol->functionScope) {
-        typeCtx->current = fnSymbol->functionScope;
-    }
     
-    IrOperand funcName = createFn(node->start, node->length);
+    IrOperand funcName = createFn(node->name);
     IrOperand exportFlag = createSizedIntConst(isExported, IR_TYPE_I32);
     int returnsDataContainerFlag = fnSymbol->type == TYPE_STRUCT;
     IrOperand returnsDataContainer = createSizedIntConst(returnsDataContainerFlag, IR_TYPE_I32);
@@ -467,7 +475,7 @@ static void generateFunctionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         FunctionParameter param = fnSymbol->parameters;
         int paramIndex = returnsDataContainerFlag ? 1 : 0; // Adjust for hidden struct return param
         if(returnsDataContainerFlag){
-            IrOperand hiddenPtr = createVar("__hidden_ptr", 13, IR_TYPE_POINTER);
+            IrOperand hiddenPtr = createVar(hiddenPtrName(), IR_TYPE_POINTER);
             emitBinary(ctx, IR_LOAD_PARAM, hiddenPtr, createNone(), createSizedIntConst(0, IR_TYPE_I32));
         }
         while (param) {
@@ -475,7 +483,7 @@ static void generateFunctionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
             if (param->isPointer) {
                 irType = IR_TYPE_POINTER;
             }
-            IrOperand paramVar = createVar(param->nameStart, param->nameLength, irType);
+            IrOperand paramVar = createVar(param->name, irType);
             IrOperand indexOp = createSizedIntConst(paramIndex, IR_TYPE_I32);
 
             emitBinary(ctx, IR_LOAD_PARAM, paramVar, createNone(), indexOp);
@@ -488,7 +496,48 @@ static void generateFunctionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
     
     emitBinary(ctx, IR_FUNC_END, funcName, none, none);
     typeCtx->currentFunction = oldFunction;
-    typeCtx->current = oldScope;
+}
+
+static int containsCall(ASTNode node) {
+    for (; node; node = node->brothers) {
+        if (node->nodeType == FUNCTION_CALL || containsCall(node->children)) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Works out a const initializer the type checker could not fold, loops and all.
+ * @details Consts run here earlier may have made it foldable. Otherwise the initializer
+ * is lowered after a copy of every function of the module and handed to the interpreter.
+ * Only top-level consts are tried, a function's are left to run.
+ */
+static ConstValue compileTimeValue(IrContext *ctx, ASTNode init, TypeCheckContext typeCtx, DataType type) {
+    ConstValue unknown = {.type = TYPE_UNKNOWN};
+    if (typeCtx->currentFunction) return unknown;
+    ConstValue folded = convertConstant(evaluateConstant(typeCtx, init, type), type);
+    if (folded.type != TYPE_UNKNOWN) return folded;
+
+    if (!typeCtx->ast || !typeCtx->ast->root) return unknown;
+    if (!isIntegerType(type) && type != TYPE_FLOAT && type != TYPE_DOUBLE && type != TYPE_BOOL) return unknown;
+    // Without a call the interpreter has nothing more to go on than the type checker
+    if (!containsCall(init)) return unknown;
+
+    if (!ctx->compileTime) {
+        ctx->compileTime = createIrContext();
+        if (!ctx->compileTime) return unknown;
+        for (ASTNode stmt = typeCtx->ast->root->children; stmt; stmt = stmt->brothers) {
+            ASTNode fn = stmt->nodeType == EXPORTDEC ? stmt->children : stmt;
+            if (fn && fn->nodeType == FUNCTION_DEFINITION) {
+                generateFunctionIr(ctx->compileTime, fn, typeCtx, 0);
+            }
+        }
+    }
+
+    IrContext *ct = ctx->compileTime;
+    IrInstruction *last = ct->lastInstruction;
+    IrOperand result = generateExpressionIr(ct, init, typeCtx, type);
+    IrInstruction *start = last ? last->next : ct->instructions;
+    return convertConstant(interpretIr(ct, start, result), type);
 }
 
 IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx, DataType expectedType) {
@@ -511,6 +560,12 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
             case REF_U16: return createSizedIntConst(parseInt(node->start, node->length), IR_TYPE_U16);
             case REF_U32: return createSizedIntConst(parseInt(node->start, node->length), IR_TYPE_U32);
             case REF_U64: return createSizedIntConst(parseInt(node->start, node->length), IR_TYPE_U64);
+            case REF_INT_UNRESOLVED: {
+                // The type checker records what the literal resolved to
+                DataType type = nodeDataType(typeCtx, node);
+                if (!isIntegerType(type)) return createNone();
+                return createSizedIntConst(parseInt(node->start, node->length), symbolTypeToIrType(type));
+            }
 
             case REF_FLOAT:
                 return createFloatConst(parseFloat(node->start, node->length));
@@ -530,8 +585,11 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
     }
 
     case VARIABLE: {
-        Symbol sym = lookupSymbol(typeCtx->current, node->start, node->length);
+        Symbol sym = nodeSymbol(typeCtx, node);
         if(!sym) return createNone();
+        if (sym->symbolType == SYMBOL_VARIABLE && sym->isConst && sym->constValue.type != TYPE_UNKNOWN) {
+            return createValueConst(sym->constValue);
+        }
         
         IrDataType type;
         if (sym->isPointer || sym->type == TYPE_POINTER) {
@@ -542,7 +600,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
             type = symbolTypeToIrType(sym->type);
         }
         
-        return createVar(node->start, node->length, type);
+        return createVar(node->name, type);
     }
 
     case ADD_OP:
@@ -570,7 +628,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         IrOperand leftOp = generateExpressionIr(ctx, left, typeCtx, expectedType);
         IrOperand rightOp = generateExpressionIr(ctx, right, typeCtx, expectedType);
 
-        IrDataType resultType = symbolTypeToIrType(getExpressionType(node, typeCtx, expectedType));
+        IrDataType resultType = symbolTypeToIrType(nodeDataType(typeCtx, node));
 
         IrOperand res = createTemp(ctx, resultType);
         IrOpCode op = astOpToIrOp(node->nodeType);
@@ -605,7 +663,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
                 .value.temp.tempNum = info.baseTempNum
             };
         }else {
-            base = createVar(info.baseName, info.baseNameLen, IR_TYPE_POINTER);
+            base = createVar(info.baseName, IR_TYPE_POINTER);
         }
         emitMemberLoad(ctx, temp, base, info.totalOffset);
         
@@ -621,10 +679,10 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
             ASTNode indexNode = arrNode->brothers;
             
             IrOperand indexOp = generateExpressionIr(ctx, indexNode, typeCtx, TYPE_I32);
-            Symbol arraySym = lookupSymbol(typeCtx->current, arrNode->start, arrNode->length);
+            Symbol arraySym = nodeSymbol(typeCtx, arrNode);
             if (!arraySym) return createNone();
             
-            IrOperand base = createVar(arrNode->start, arrNode->length, IR_TYPE_POINTER);
+            IrOperand base = createVar(arrNode->name, IR_TYPE_POINTER);
             IrOperand result = createTemp(ctx, IR_TYPE_POINTER);
             
             // Emit: result = &base[index] (leaq + offset computation)
@@ -633,10 +691,10 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         }
 
         // &variable
-        Symbol targetSym = lookupSymbol(typeCtx->current, target->start, target->length);
+        Symbol targetSym = nodeSymbol(typeCtx, target);
         if (!targetSym) return createNone();
         IrDataType targetType = symbolTypeToIrType(targetSym->type);
-        IrOperand targetVar = createVar(target->start, target->length, targetType);
+        IrOperand targetVar = createVar(target->name, targetType);
         IrOperand result = createTemp(ctx, IR_TYPE_POINTER);
         emitUnary(ctx, IR_ADDROF, result, targetVar);
         return result;
@@ -653,7 +711,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         // Determine the type of the dereferenced value
         Symbol ptrSym = NULL;
         if (ptrNode->nodeType == VARIABLE) {
-            ptrSym = lookupSymbol(typeCtx->current, ptrNode->start, ptrNode->length);
+            ptrSym = nodeSymbol(typeCtx, ptrNode);
         }
 
         IrDataType derefType = ptrSym ? symbolTypeToIrType(ptrSym->type) : IR_TYPE_I32;
@@ -716,7 +774,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
     }
 
     case FUNCTION_CALL: {
-        Symbol funcSymbol = lookupSymbol(typeCtx->current, node->start, node->length);
+        Symbol funcSymbol = nodeSymbol(typeCtx, node);
         int paramCount = 0;
         if(funcSymbol && funcSymbol->type != TYPE_VOID && funcSymbol->type == TYPE_STRUCT){
             ++paramCount;
@@ -747,7 +805,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         IrDataType retType = funcSymbol && funcSymbol->type != TYPE_STRUCT ? symbolTypeToIrType(funcSymbol->type) : IR_TYPE_VOID;
         
         IrOperand result = (retType == IR_TYPE_VOID) ? createNone() : createTemp(ctx, retType);
-        emitCall(ctx, result, node->start, node->length, paramCount);
+        emitCall(ctx, result, node->name, paramCount);
         return result;
     }
 
@@ -766,9 +824,9 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         if (!left || !right) return createNone();
         Symbol leftSym = NULL;
         if (left->children) {
-            leftSym = lookupSymbol(typeCtx->current, left->children->start, left->children->length);
+            leftSym = nodeSymbol(typeCtx, left->children);
         }
-        DataType leftTypeExpected = getExpressionType(left, typeCtx, TYPE_UNKNOWN);
+        DataType leftTypeExpected = nodeDataType(typeCtx, left);
         IrOperand rightOp = generateExpressionIr(ctx, right, typeCtx, leftTypeExpected);
         IrOperand leftOp;
 
@@ -800,7 +858,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
                     .value.temp.tempNum = info.baseTempNum
                 };
             } else {
-                base = createVar(info.baseName, info.baseNameLen, IR_TYPE_POINTER);
+                base = createVar(info.baseName, IR_TYPE_POINTER);
             }
             
             if (node->nodeType != ASSIGNMENT) {
@@ -815,7 +873,7 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
                 emitMemberStore(ctx, base, info.totalOffset, rightOp);
             }
         }else {
-            DataType directLeftExpected = leftSym ? leftSym->type : getExpressionType(left, typeCtx, TYPE_UNKNOWN);
+            DataType directLeftExpected = leftSym ? leftSym->type : nodeDataType(typeCtx, left);
             leftOp = generateExpressionIr(ctx, left, typeCtx, directLeftExpected);
             if (node->nodeType != ASSIGNMENT) {
                 IrDataType resultType = leftOp.dataType;
@@ -847,15 +905,21 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
         return res;
     }
 
+    case TERNARY_CONDITIONAL: {
+        // Only ternaries with a constant result are lowered so far
+        ConstValue value = evaluateConstant(typeCtx, node, expectedType);
+        return value.type != TYPE_UNKNOWN ? createValueConst(value) : createNone();
+    }
+
     case ARRAY_ACCESS:{
         ASTNode arrNode = node->children;
         ASTNode index = arrNode->brothers;
         IrOperand indexOp = generateExpressionIr(ctx, index, typeCtx, TYPE_I32);
 
-        Symbol arraySym = lookupSymbol(typeCtx->current, arrNode->start, arrNode->length);
+        Symbol arraySym = nodeSymbol(typeCtx, arrNode);
         IrDataType elemType = symbolTypeToIrType(arraySym->type);
 
-        IrOperand arrayBase = createVar(arrNode->start, arrNode->length, IR_TYPE_POINTER);
+        IrOperand arrayBase = createVar(arrNode->name, IR_TYPE_POINTER);
 
         IrOperand result = createTemp(ctx, elemType);
         emitPointerLoad(ctx, result, arrayBase, indexOp);
@@ -879,36 +943,24 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx,
         }
         case BLOCK_STATEMENT:
         case BLOCK_EXPRESSION: {
-            // IMPORTANT: Dequeue the block scope that was created during type checking
-            // This ensures symbol lookups work correctly for block-local variables
-            
-            SymbolTable oldScope = typeCtx->current;
-            SymbolTable blockScope = dequeueBlockScope(typeCtx);
-            
-            if (blockScope) {
-                typeCtx->current = blockScope;
-            }
-            
+            // Names inside were bound on their nodes while type checking
             ASTNode child = node->children;
             while(child){
                 generateStatementIr(ctx, child, typeCtx, expectedType);
                 child = child->brothers;
             }
-            
-            // Restore the previous scope
-            typeCtx->current = oldScope;
             break;
         }
         case LET_DEC:
         case CONST_DEC:
         if (node->children) {
             ASTNode varDef = node->children;
-            Symbol sym = lookupSymbol(typeCtx->current, varDef->start, varDef->length);
+            Symbol sym = nodeSymbol(typeCtx, varDef);
             if(sym->type == TYPE_STRUCT){
-                IrOperand var = createVar(varDef->start, varDef->length, IR_TYPE_POINTER);
+                IrOperand var = createVar(varDef->name, IR_TYPE_POINTER);
                 int totalSize = sym->structType->size;
                 if(typeCtx->currentFunction && typeCtx->currentFunction->returnedVar == sym){
-                    emitCopy(ctx, var, createVar("__hidden_ptr", 13, IR_TYPE_POINTER));
+                    emitCopy(ctx, var, createVar(hiddenPtrName(), IR_TYPE_POINTER));
                 }else{
                     emitAllocStruct(ctx, var, totalSize);
                     if(varDef->children->brothers && varDef->children->brothers->children->nodeType == FUNCTION_CALL){
@@ -939,7 +991,7 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx,
             break;
         case VAR_DEFINITION: {
             if (node->children && node->children->brothers) {
-                Symbol sym = lookupSymbol(typeCtx->current, node->start, node->length);
+                Symbol sym = nodeSymbol(typeCtx, node);
                 if (!sym) {
                     // todo: handle error properly instead of silently returning and generating incorrect IR
                     return;
@@ -950,13 +1002,20 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx,
                     initValueNode && initValueNode->nodeType == LITERAL &&
                     initValueNode->children && initValueNode->children->nodeType == REF_STRING) {
 
-                    IrOperand var = createVar(node->start, node->length, IR_TYPE_POINTER);
+                    IrOperand var = createVar(node->name, IR_TYPE_POINTER);
                     IrOperand strConst = createStringConst(initValueNode->start, initValueNode->length);
                     emitBinary(ctx, IR_STRING_INIT, var, strConst, createNone());
                     break;
                 }
 
-                IrOperand val = generateExpressionIr(ctx, node->children->brothers->children, typeCtx, sym->type);
+                // Consts folded while type checking never run their initializer, and
+                // the rest are run now if they can be, reads after this one fold too
+                if (sym->isConst && !sym->isPointer && sym->constValue.type == TYPE_UNKNOWN) {
+                    sym->constValue = compileTimeValue(ctx, initValueNode, typeCtx, sym->type);
+                }
+                IrOperand val = sym->isConst && sym->constValue.type != TYPE_UNKNOWN
+                    ? createValueConst(sym->constValue)
+                    : generateExpressionIr(ctx, initValueNode, typeCtx, sym->type);
 
                 ASTNode typeRefChild = node->children->children;
                 IrDataType type;
@@ -966,34 +1025,36 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx,
                     type = nodeTypeToIrType(typeRefChild ? typeRefChild->nodeType : REF_I32);
                 }
 
-                IrOperand var = createVar(node->start, node->length, type);
+                IrOperand var = createVar(node->name, type);
                 emitCopy(ctx, var, val);
             }
             break;
         }
         case ARRAY_VARIABLE_DEFINITION:{
             if(node->children){
-                // todo: use symbol table instead of node values, even if ast is supposed to be correct after sem pass
                 ASTNode typeref = node->children;
                 IrDataType type = nodeTypeToIrType(typeref->children->nodeType);
                 DataType elemType = getDataTypeFromNode(typeref->children->nodeType);
                 ASTNode staticSizeNode = typeref->brothers;
-                IrOperand arr = createVar(node->start, node->length, type);
+                IrOperand arr = createVar(node->name, type);
                 ASTNode valNode = staticSizeNode->brothers;
-                int staticSize;
-                if(staticSizeNode->nodeType == LITERAL){
-                    staticSize = parseInt(staticSizeNode->start, staticSizeNode->length);
-                }else{
-                    Symbol arrSym = lookupSymbol(typeCtx->current, staticSizeNode->start, staticSizeNode->length);
-                    staticSize = arrSym->constVal;
-                }
+                Symbol arrSym = nodeSymbol(typeCtx, node);
+                // The size expression was evaluated while type checking
+                int staticSize = arrSym->staticSize;
                 IrOperand sizeOp = createSizedIntConst(staticSize, IR_TYPE_I32);
                 emitUnary(ctx, IR_REQ_MEM, arr, sizeOp);
                 if(valNode){
                     if (valNode->children->nodeType == ARRAY_LIT) {
                         ASTNode arrLitVal = valNode->children->children;
                         for (int i = 0; i < staticSize; ++i) {
-                            IrOperand val = generateExpressionIr(ctx, arrLitVal, typeCtx, elemType);
+                            // Tables of constants are stored as computed, calls included
+                            ConstValue elem = convertConstant(evaluateConstant(typeCtx, arrLitVal, elemType), elemType);
+                            if (elem.type == TYPE_UNKNOWN && arrSym->isConst) {
+                                elem = compileTimeValue(ctx, arrLitVal, typeCtx, elemType);
+                            }
+                            IrOperand val = elem.type != TYPE_UNKNOWN
+                                ? createValueConst(elem)
+                                : generateExpressionIr(ctx, arrLitVal, typeCtx, elemType);
                             IrOperand off = createSizedIntConst(i, IR_TYPE_I32);
                             emitPointerStore(ctx, arr, off, val);
                             arrLitVal = arrLitVal->brothers;
@@ -1065,6 +1126,7 @@ void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx,
             if (node->children && node->children->nodeType == FUNCTION_DEFINITION) {
                 generateFunctionIr(ctx, node->children, typeCtx, 1);
             }
+            // Exported consts are folded at every read and get no storage
             break;
         }
 
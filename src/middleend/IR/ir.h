@@ -63,8 +63,7 @@ typedef enum {
 } IrOpCode;
 
 typedef struct {
-    const char *baseName;
-    size_t baseNameLen;
+    NameId baseName;
     int totalOffset;
     StructType finalStructType;
     DataType fieldType;
@@ -108,6 +107,7 @@ typedef struct IrOperand {
         struct {
             const char *name;
             size_t nameLen;
+            NameId id;      // operands name the same variable when ids match
         } var;
         struct {
             union {
@@ -131,6 +131,7 @@ typedef struct IrOperand {
         struct {
             const char *name;
             size_t nameLen;
+            NameId id;
         } fn;
     } value;
 } IrOperand;
@@ -157,20 +158,22 @@ typedef struct IrContext {
         int targetLabel;                    
         struct JumpPatch *next;
     } *pendingJumps;
-    
+
+    struct IrContext *compileTime;          // the module's functions again, for consts run at compile time; NULL until needed
 } IrContext;
 
 IrContext *createIrContext();
 void freeIrContext(IrContext *ctx);
 
 IrOperand createTemp(IrContext *ctx, IrDataType type);
-IrOperand createVar(const char *name, size_t len, IrDataType type);
+IrOperand createVar(NameId name, IrDataType type);
 IrOperand createConst(IrDataType type);
 IrOperand createSizedIntConst(int64_t val, IrDataType type);
 IrOperand createFloatConst(float val);
 IrOperand createDoubleConst(double val);
 IrOperand createBoolConst(int val);
 IrOperand createStringConst(const char* val, size_t len);
+IrOperand createValueConst(ConstValue value);
 IrOperand createLabel(int label);
 IrOperand createNone();
 
@@ -182,7 +185,7 @@ IrInstruction *emitLabel(IrContext *ctx, int lab);
 IrInstruction *emitGoto(IrContext *ctx, int lab);
 IrInstruction *emitIfFalse(IrContext *ctx, IrOperand cond, int lab);
 IrInstruction *emitReturn(IrContext *ctx, IrOperand ret);
-IrInstruction *emitCall(IrContext *ctx, IrOperand res, const char *fnName, size_t nameLen, int params);
+IrInstruction *emitCall(IrContext *ctx, IrOperand res, NameId fnName, int params);
 
 IrDataType symbolTypeToIrType(DataType type);
 IrDataType nodeTypeToIrType(NodeTypes nodeType);
@@ -192,5 +195,9 @@ IrOperand generateExpressionIr(IrContext *ctx, ASTNode node, TypeCheckContext ty
 void generateStatementIr(IrContext *ctx, ASTNode node, TypeCheckContext typeCtx, DataType expectedType);
 IrContext *generateIr(ASTNode ast, TypeCheckContext typeCtx);
 
+// Runs top-level IR from start at compile time, calling the functions in ctx, and
+// returns the value of result; TYPE_UNKNOWN when the code cannot run in the sandbox
+ConstValue interpretIr(IrContext *ctx, IrInstruction *start, IrOperand result);
+
 void printInstruction(IrInstruction *inst);
 void printIR(IrContext *ctx);
\ No newline at end of file
@@ -0,0 +1,679 @@
+/**
+ * @file irInterpreter.c
+ * @brief Compile-time execution of IR.
+ *
+ * Responsibilities:
+ *   - Running arithmetic, branches, loops and calls between the functions
+ *     of one IrContext
+ *   - Backing variables, arrays and pointers with a sandboxed memory
+ *   - Giving up on whatever it cannot run exactly as the program would
+ *
+ * Memory is an array of typed cells and a pointer is the index of a cell.
+ * Every variable lives in a cell, so &variable works, and an array element
+ * takes one cell whatever its type, which holds as long as no pointer is
+ * cast. Cell 0 is never handed out and stands for null. A call's cells are
+ * released when it returns, like a stack frame.
+ *
+ * Built-ins, imported functions, strings and structs have no meaning in the
+ * sandbox, so reaching one ends the run, as do reads of unset memory and
+ * anything that traps at run time.
+ */
+
+#include <stdlib.h>
+#include "ir.h"
+#include "memTrack.h"
+
+#define IR_INTERP_STEP_LIMIT 1000000
+#define IR_INTERP_CALL_DEPTH 64
+#define IR_INTERP_MEMORY_CELLS (1 << 16)
+#define IR_INTERP_PENDING_ARGS 64
+
+typedef struct IrValue {
+    IrDataType type;            // IR_TYPE_VOID while the cell or temp is unset
+    union {
+        int64_t intVal;         // integers, bools and pointers
+        double floatVal;        // floats are kept rounded to float
+    };
+} IrValue;
+
+typedef struct IrFunction {
+    NameId name;
+    IrInstruction *begin;
+    int firstTemp;
+    int tempCount;
+} IrFunction;
+
+typedef struct IrFrame {
+    NameId *varNames;
+    int64_t *varCells;          // the cell each variable lives in
+    int varCount;
+    int varCapacity;
+    IrValue *temps;             // indexed by tempNum - firstTemp
+    int firstTemp;
+    int tempCount;
+    const IrValue *args;
+    int argCount;
+} IrFrame;
+
+typedef struct IrInterpreter {
+    IrFunction *functions;
+    int functionCount;
+    IrInstruction **labels;     // LABEL instruction of each label number
+    int labelCount;
+    IrValue *memory;
+    int64_t memoryUsed;
+    int64_t memoryCapacity;
+    IrValue pending[IR_INTERP_PENDING_ARGS];   // PARAM values not yet taken by a CALL
+    int pendingCount;
+    int steps;
+    int depth;
+} IrInterpreter;
+
+/**
+ * Values
+ */
+
+static int isIntegerIr(IrDataType type) {
+    return type <= IR_TYPE_U64 || type == IR_TYPE_BOOL;
+}
+
+static int isFloatingIr(IrDataType type) {
+    return type == IR_TYPE_FLOAT || type == IR_TYPE_DOUBLE;
+}
+
+static int isSignedIr(IrDataType type) {
+    return type <= IR_TYPE_I64;
+}
+
+static int bitWidth(IrDataType type) {
+    switch (type) {
+        case IR_TYPE_I8:  case IR_TYPE_U8:  case IR_TYPE_BOOL: return 8;
+        case IR_TYPE_I16: case IR_TYPE_U16: return 16;
+        case IR_TYPE_I32: case IR_TYPE_U32: return 32;
+        default: return 64;
+    }
+}
+
+static IrValue intOf(IrDataType type, int64_t value) {
+    IrValue result = {.type = type};
+    switch (type) {
+        case IR_TYPE_I8:   result.intVal = (int8_t)value; break;
+        case IR_TYPE_I16:  result.intVal = (int16_t)value; break;
+        case IR_TYPE_I32:  result.intVal = (int32_t)value; break;
+        case IR_TYPE_U8:   result.intVal = (uint8_t)value; break;
+        case IR_TYPE_U16:  result.intVal = (uint16_t)value; break;
+        case IR_TYPE_U32:  result.intVal = (uint32_t)value; break;
+        case IR_TYPE_BOOL: result.intVal = value != 0; break;
+        default:           result.intVal = value; break;
+    }
+    return result;
+}
+
+static IrValue floatOf(IrDataType type, double value) {
+    IrValue result = {.type = type};
+    result.floatVal = type == IR_TYPE_FLOAT ? (float)value : value;
+    return result;
+}
+
+static int isTrue(IrValue value) {
+    return isFloatingIr(value.type) ? value.floatVal != 0 : value.intVal != 0;
+}
+
+static int convertValue(IrValue value, IrDataType type, IrValue *out) {
+    if (value.type == type) {
+        *out = value;
+        return 1;
+    }
+    // Pointers never turn into numbers or back, their cells mean nothing outside
+    if (value.type == IR_TYPE_POINTER || type == IR_TYPE_POINTER) return 0;
+
+    if (isFloatingIr(type)) {
+        if (isFloatingIr(value.type)) *out = floatOf(type, value.floatVal);
+        else if (value.type == IR_TYPE_U64) *out = floatOf(type, (double)(uint64_t)value.intVal);
+        else if (isIntegerIr(value.type)) *out = floatOf(type, (double)value.intVal);
+        else return 0;
+        return 1;
+    }
+    if (!isIntegerIr(type)) return 0;
+    if (isIntegerIr(value.type)) {
+        *out = intOf(type, value.intVal);
+        return 1;
+    }
+    if (!isFloatingIr(value.type)) return 0;
+    if (type == IR_TYPE_BOOL) {
+        *out = intOf(type, value.floatVal != 0);
+        return 1;
+    }
+
+    // Out of range conversions are undefined, NaN included
+    double d = value.floatVal;
+    if (!(d >= -9223372036854775808.0 && d < 18446744073709551616.0)) return 0;
+    *out = intOf(type, d >= 9223372036854775808.0 ? (int64_t)(uint64_t)d : (int64_t)d);
+    return 1;
+}
+
+static ConstValue toConstValue(IrValue value) {
+    ConstValue result = {.type = TYPE_UNKNOWN};
+    switch (value.type) {
+        case IR_TYPE_I8:     result.type = TYPE_I8; break;
+        case IR_TYPE_I16:    result.type = TYPE_I16; break;
+        case IR_TYPE_I32:    result.type = TYPE_I32; break;
+        case IR_TYPE_I64:    result.type = TYPE_I64; break;
+        case IR_TYPE_U8:     result.type = TYPE_U8; break;
+        case IR_TYPE_U16:    result.type = TYPE_U16; break;
+        case IR_TYPE_U32:    result.type = TYPE_U32; break;
+        case IR_TYPE_U64:    result.type = TYPE_U64; break;
+        case IR_TYPE_BOOL:   result.type = TYPE_BOOL; break;
+        case IR_TYPE_FLOAT:  result.type = TYPE_FLOAT; break;
+        case IR_TYPE_DOUBLE: result.type = TYPE_DOUBLE; break;
+        default:             return result;
+    }
+    if (isFloatingIr(value.type)) result.floatVal = value.floatVal;
+    else result.intVal = value.intVal;
+    return result;
+}
+
+/**
+ * Operators
+ */
+
+static int arithmetic(IrOpCode op, IrDataType type, IrValue a, IrValue b, IrValue *out) {
+    if (!convertValue(a, type, &a) || !convertValue(b, type, &b)) return 0;
+
+    if (isFloatingIr(type)) {
+        switch (op) {
+            case IR_ADD: *out = floatOf(type, a.floatVal + b.floatVal); return 1;
+            case IR_SUB: *out = floatOf(type, a.floatVal - b.floatVal); return 1;
+            case IR_MUL: *out = floatOf(type, a.floatVal * b.floatVal); return 1;
+            case IR_DIV:
+                if (b.floatVal == 0) return 0;
+                *out = floatOf(type, a.floatVal / b.floatVal);
+                return 1;
+            default: return 0;
+        }
+    }
+    if (!isIntegerIr(type)) return 0;
+
+    int64_t x = a.intVal, y = b.intVal;
+    uint64_t ux = (uint64_t)x, uy = (uint64_t)y;
+    int bits = bitWidth(type);
+    switch (op) {
+        case IR_ADD:     *out = intOf(type, (int64_t)(ux + uy)); return 1;
+        case IR_SUB:     *out = intOf(type, (int64_t)(ux - uy)); return 1;
+        case IR_MUL:     *out = intOf(type, (int64_t)(ux * uy)); return 1;
+        case IR_BIT_AND: *out = intOf(type, x & y); return 1;
+        case IR_BIT_OR:  *out = intOf(type, x | y); return 1;
+        case IR_BIT_XOR: *out = intOf(type, x ^ y); return 1;
+
+        case IR_DIV:
+        case IR_MOD: {
+            // Both trap at run time
+            int64_t minimum = bits == 64 ? INT64_MIN : -((int64_t)1 << (bits - 1));
+            if (y == 0 || (isSignedIr(type) && y == -1 && x == minimum)) return 0;
+            if (isSignedIr(type)) *out = intOf(type, op == IR_DIV ? x / y : x % y);
+            else *out = intOf(type, (int64_t)(op == IR_DIV ? ux / uy : ux % uy));
+            return 1;
+        }
+
+        case IR_SHL:
+        case IR_SHR:
+            if (uy >= (uint64_t)bits) return 0;
+            if (op == IR_SHL) *out = intOf(type, (int64_t)(ux << uy));
+            else *out = intOf(type, isSignedIr(type) ? x >> y : (int64_t)(ux >> uy));
+            return 1;
+
+        default: return 0;
+    }
+}
+
+static int comparison(IrOpCode op, IrValue a, IrValue b, IrValue *out) {
+    int order;
+    if (a.type == IR_TYPE_POINTER || b.type == IR_TYPE_POINTER) {
+        if (a.type != b.type || (op != IR_EQ && op != IR_NE)) return 0;
+        order = a.intVal != b.intVal;
+    } else if (isFloatingIr(a.type) || isFloatingIr(b.type)) {
+        if (!convertValue(a, IR_TYPE_DOUBLE, &a) || !convertValue(b, IR_TYPE_DOUBLE, &b)) return 0;
+        // NaN is unordered, every comparison but != is false
+        if (a.floatVal != a.floatVal || b.floatVal != b.floatVal) {
+            *out = intOf(IR_TYPE_BOOL, op == IR_NE);
+            return 1;
+        }
+        order = (a.floatVal > b.floatVal) - (a.floatVal < b.floatVal);
+    } else if (a.type == IR_TYPE_U64 || b.type == IR_TYPE_U64) {
+        uint64_t x = (uint64_t)a.intVal, y = (uint64_t)b.intVal;
+        order = (x > y) - (x < y);
+    } else {
+        order = (a.intVal > b.intVal) - (a.intVal < b.intVal);
+    }
+
+    int result;
+    switch (op) {
+        case IR_EQ: result = order == 0; break;
+        case IR_NE: result = order != 0; break;
+        case IR_LT: result = order < 0; break;
+        case IR_LE: result = order <= 0; break;
+        case IR_GT: result = order > 0; break;
+        case IR_GE: result = order >= 0; break;
+        default: return 0;
+    }
+    *out = intOf(IR_TYPE_BOOL, result);
+    return 1;
+}
+
+static int unary(IrOpCode op, IrDataType type, IrValue a, IrValue *out) {
+    if (op == IR_NOT) {
+        if (a.type == IR_TYPE_POINTER) return 0;
+        *out = intOf(IR_TYPE_BOOL, !isTrue(a));
+        return 1;
+    }
+    if (!convertValue(a, type, &a)) return 0;
+    if (op == IR_NEG && isFloatingIr(type)) {
+        *out = floatOf(type, -a.floatVal);
+        return 1;
+    }
+    if (!isIntegerIr(type)) return 0;
+    if (op == IR_NEG) *out = intOf(type, (int64_t)(0 - (uint64_t)a.intVal));
+    else if (op == IR_BIT_NOT) *out = intOf(type, ~a.intVal);
+    else return 0;
+    return 1;
+}
+
+/**
+ * Memory
+ */
+
+// First cell of a fresh block, 0 once the memory limit is reached
+static int64_t allocateCells(IrInterpreter *in, int64_t count) {
+    if (count <= 0 || in->memoryUsed + count > IR_INTERP_MEMORY_CELLS) return 0;
+    if (in->memoryUsed + count > in->memoryCapacity) {
+        int64_t capacity = in->memoryCapacity ? in->memoryCapacity : 1024;
+        while (capacity < in->memoryUsed + count) capacity *= 2;
+        IrValue *memory = trackedRealloc(MEM_IR, in->memory, capacity * sizeof(IrValue));
+        if (!memory) return 0;
+        in->memory = memory;
+        in->memoryCapacity = capacity;
+    }
+    int64_t first = in->memoryUsed;
+    for (int64_t i = 0; i < count; i++) {
+        in->memory[first + i].type = IR_TYPE_VOID;
+    }
+    in->memoryUsed += count;
+    return first;
+}
+
+static IrValue *cellAt(IrInterpreter *in, IrValue pointer) {
+    if (pointer.type != IR_TYPE_POINTER || pointer.intVal <= 0 || pointer.intVal >= in->memoryUsed) {
+        return NULL;
+    }
+    return &in->memory[pointer.intVal];
+}
+
+static IrValue pointerTo(int64_t cell) {
+    IrValue pointer = {.type = IR_TYPE_POINTER};
+    pointer.intVal = cell;
+    return pointer;
+}
+
+// Cell of a variable, given one when create is set and it has none yet
+static int64_t variableCell(IrInterpreter *in, IrFrame *frame, NameId name, int create) {
+    for (int i = 0; i < frame->varCount; i++) {
+        if (frame->varNames[i] == name) return frame->varCells[i];
+    }
+    if (!create) return 0;
+
+    if (frame->varCount == frame->varCapacity) {
+        int capacity = frame->varCapacity ? frame->varCapacity * 2 : 16;
+        NameId *names = trackedRealloc(MEM_IR, frame->varNames, capacity * sizeof(NameId));
+        if (!names) return 0;
+        frame->varNames = names;
+        int64_t *cells = trackedRealloc(MEM_IR, frame->varCells, capacity * sizeof(int64_t));
+        if (!cells) return 0;
+        frame->varCells = cells;
+        frame->varCapacity = capacity;
+    }
+    int64_t cell = allocateCells(in, 1);
+    if (!cell) return 0;
+    frame->varNames[frame->varCount] = name;
+    frame->varCells[frame->varCount] = cell;
+    frame->varCount++;
+    return cell;
+}
+
+/**
+ * Operands
+ */
+
+/**
+ * Arrays are named with their element type while holding their block, and a
+ * value loaded through a pointer may be named as a pointer itself, so either
+ * way round the value is taken as it is.
+ */
+static int isUntyped(const IrOperand *op, IrValue value) {
+    return op->type != OPERAND_CONSTANT &&
+           (value.type == IR_TYPE_POINTER || op->dataType == IR_TYPE_POINTER);
+}
+
+static int readOperand(IrInterpreter *in, IrFrame *frame, const IrOperand *op, IrValue *out) {
+    IrValue value;
+    switch (op->type) {
+        case OPERAND_CONSTANT:
+            if (op->dataType == IR_TYPE_FLOAT) value = floatOf(IR_TYPE_FLOAT, op->value.constant.floatVal);
+            else if (op->dataType == IR_TYPE_DOUBLE) value = floatOf(IR_TYPE_DOUBLE, op->value.constant.doubleVal);
+            else if (op->dataType == IR_TYPE_POINTER) value = pointerTo(op->value.constant.intVal);
+            else if (isIntegerIr(op->dataType)) value = intOf(op->dataType, op->value.constant.intVal);
+            else return 0;
+            *out = value;
+            return 1;
+
+        case OPERAND_TEMP: {
+            int slot = op->value.temp.tempNum - frame->firstTemp;
+            if (slot < 0 || slot >= frame->tempCount) return 0;
+            value = frame->temps[slot];
+            break;
+        }
+
+        case OPERAND_VAR: {
+            // Globals have no cell in a frame, reading one gives up
+            int64_t cell = variableCell(in, frame, op->value.var.id, 0);
+            if (!cell) return 0;
+            value = in->memory[cell];
+            break;
+        }
+
+        default:
+            return 0;
+    }
+    if (value.type == IR_TYPE_VOID) return 0;
+    if (!isUntyped(op, value)) return convertValue(value, op->dataType, out);
+    *out = value;
+    return 1;
+}
+
+static int writeOperand(IrInterpreter *in, IrFrame *frame, const IrOperand *op, IrValue value) {
+    if (!isUntyped(op, value) && !convertValue(value, op->dataType, &value)) return 0;
+
+    switch (op->type) {
+        case OPERAND_TEMP: {
+            int slot = op->value.temp.tempNum - frame->firstTemp;
+            if (slot < 0 || slot >= frame->tempCount) return 0;
+            frame->temps[slot] = value;
+            return 1;
+        }
+        case OPERAND_VAR: {
+            int64_t cell = variableCell(in, frame, op->value.var.id, 1);
+            if (!cell) return 0;
+            in->memory[cell] = value;
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Execution
+ */
+
+static void noteTemp(const IrOperand *op, int *low, int *high) {
+    if (op->type != OPERAND_TEMP) return;
+    if (op->value.temp.tempNum < *low) *low = op->value.temp.tempNum;
+    if (op->value.temp.tempNum > *high) *high = op->value.temp.tempNum;
+}
+
+// Temps a function body or a top-level run uses, which createTemp numbered in one run
+static void tempRange(IrInstruction *inst, int *first, int *count) {
+    int low = INT32_MAX, high = -1;
+    for (; inst && inst->op != IR_FUNC_END && inst->op != IR_FUNC_BEGIN; inst = inst->next) {
+        noteTemp(&inst->result, &low, &high);
+        noteTemp(&inst->ar1, &low, &high);
+        noteTemp(&inst->ar2, &low, &high);
+    }
+    *first = high < 0 ? 0 : low;
+    *count = high < 0 ? 0 : high - low + 1;
+}
+
+static void indexContext(IrInterpreter *in, IrContext *ctx) {
+    int functionCount = 0;
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (inst->op == IR_FUNC_BEGIN) functionCount++;
+    }
+    in->functions = functionCount ? trackedCalloc(MEM_IR, functionCount, sizeof(IrFunction)) : NULL;
+    in->labelCount = ctx->nextLabelNum;
+    in->labels = trackedCalloc(MEM_IR, in->labelCount ? in->labelCount : 1, sizeof(IrInstruction *));
+    if ((functionCount && !in->functions) || !in->labels) return;
+
+    for (IrInstruction *inst = ctx->instructions; inst; inst = inst->next) {
+        if (inst->op == IR_FUNC_BEGIN) {
+            IrFunction *fn = &in->functions[in->functionCount++];
+            fn->name = inst->result.value.fn.id;
+            fn->begin = inst;
+            tempRange(inst->next, &fn->firstTemp, &fn->tempCount);
+        } else if (inst->op == IR_LABEL) {
+            int label = inst->result.value.label.labelNum;
+            if (label >= 0 && label < in->labelCount) in->labels[label] = inst;
+        }
+    }
+}
+
+static IrInstruction *labelTarget(IrInterpreter *in, const IrOperand *label) {
+    if (label->type != OPERAND_LABEL) return NULL;
+    int num = label->value.label.labelNum;
+    return num >= 0 && num < in->labelCount ? in->labels[num] : NULL;
+}
+
+static int execute(IrInterpreter *in, IrFrame *frame, IrInstruction *inst, IrValue *returned);
+
+static int callFunction(IrInterpreter *in, NameId name, const IrValue *args, int argCount, IrValue *returned) {
+    IrFunction *fn = NULL;
+    for (int i = 0; i < in->functionCount && !fn; i++) {
+        if (in->functions[i].name == name) fn = &in->functions[i];
+    }
+    // Built-ins and imported functions have no body here; struct results need a caller's block
+    if (!fn || in->depth == IR_INTERP_CALL_DEPTH || fn->begin->ar2.value.constant.intVal) return 0;
+
+    IrFrame frame = {
+        .firstTemp = fn->firstTemp,
+        .tempCount = fn->tempCount,
+        .args = args,
+        .argCount = argCount
+    };
+    frame.temps = trackedMalloc(MEM_IR, (fn->tempCount ? fn->tempCount : 1) * sizeof(IrValue));
+    if (!frame.temps) return 0;
+    for (int i = 0; i < fn->tempCount; i++) frame.temps[i].type = IR_TYPE_VOID;
+
+    int64_t mark = in->memoryUsed;
+    in->depth++;
+    int ok = execute(in, &frame, fn->begin->next, returned);
+    in->depth--;
+    in->memoryUsed = mark;
+
+    trackedFree(MEM_IR, frame.temps);
+    trackedFree(MEM_IR, frame.varNames);
+    trackedFree(MEM_IR, frame.varCells);
+    return ok;
+}
+
+static int execute(IrInterpreter *in, IrFrame *frame, IrInstruction *inst, IrValue *returned) {
+    returned->type = IR_TYPE_VOID;
+    IrValue a, b, r;
+
+    for (; inst && inst->op != IR_FUNC_END; inst = inst->next) {
+        if (++in->steps > IR_INTERP_STEP_LIMIT) return 0;
+
+        switch (inst->op) {
+            case IR_LABEL:
+            case IR_NOP:
+                break;
+
+            case IR_COPY:
+                if (!readOperand(in, frame, &inst->ar1, &a)) return 0;
+                if (!writeOperand(in, frame, &inst->result, a)) return 0;
+                break;
+
+            case IR_CAST:
+                if (!readOperand(in, frame, &inst->ar1, &a) || a.type == IR_TYPE_POINTER) return 0;
+                if (!convertValue(a, inst->result.dataType, &r)) return 0;
+                if (!writeOperand(in, frame, &inst->result, r)) return 0;
+                break;
+
+            case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_MOD:
+            case IR_BIT_AND: case IR_BIT_OR: case IR_BIT_XOR: case IR_SHL: case IR_SHR:
+                if (!readOperand(in, frame, &inst->ar1, &a) || !readOperand(in, frame, &inst->ar2, &b)) return 0;
+                if (!arithmetic(inst->op, inst->result.dataType, a, b, &r)) return 0;
+                if (!writeOperand(in, frame, &inst->result, r)) return 0;
+                break;
+
+            case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+                if (!readOperand(in, frame, &inst->ar1, &a) || !readOperand(in, frame, &inst->ar2, &b)) return 0;
+                if (!comparison(inst->op, a, b, &r)) return 0;
+                if (!writeOperand(in, frame, &inst->result, r)) return 0;
+                break;
+
+            case IR_AND:
+            case IR_OR:
+                if (!readOperand(in, frame, &inst->ar1, &a) || !readOperand(in, frame, &inst->ar2, &b)) return 0;
+                r = intOf(IR_TYPE_BOOL, inst->op == IR_AND ? isTrue(a) && isTrue(b) : isTrue(a) || isTrue(b));
+                if (!writeOperand(in, frame, &inst->result, r)) return 0;
+                break;
+
+            case IR_NEG:
+            case IR_NOT:
+            case IR_BIT_NOT:
+                if (!readOperand(in, frame, &inst->ar1, &a)) return 0;
+                if (!unary(inst->op, inst->result.dataType, a, &r)) return 0;
+                if (!writeOperand(in, frame, &inst->result, r)) return 0;
+                break;
+
+            case IR_GOTO:
+                inst = labelTarget(in, &inst->ar1);
+                if (!inst) return 0;
+                break;
+
+            case IR_IF_TRUE:
+            case IR_IF_FALSE:
+                if (!readOperand(in, frame, &inst->ar1, &a)) return 0;
+                if (isTrue(a) == (inst->op == IR_IF_TRUE)) {
+                    inst = labelTarget(in, &inst->ar2);
+                    if (!inst) return 0;
+                }
+                break;
+
+            case IR_LOAD_PARAM: {
+                int64_t index = inst->ar2.value.constant.intVal;
+                if (index < 0 || index >= frame->argCount) return 0;
+                if (!writeOperand(in, frame, &inst->result, frame->args[index])) return 0;
+                break;
+            }
+
+            case IR_PARAM:
+                if (in->pendingCount == IR_INTERP_PENDING_ARGS) return 0;
+                if (!readOperand(in, frame, &inst->ar1, &in->pending[in->pendingCount])) return 0;
+                in->pendingCount++;
+                break;
+
+            case IR_CALL: {
+                int64_t count = inst->ar2.value.constant.intVal;
+                if (count < 0 || count > in->pendingCount) return 0;
+                in->pendingCount -= (int)count;
+                IrValue args[IR_INTERP_PENDING_ARGS];
+                for (int64_t i = 0; i < count; i++) args[i] = in->pending[in->pendingCount + i];
+                if (!callFunction(in, inst->ar1.value.fn.id, args, (int)count, &r)) return 0;
+                if (inst->result.type != OPERAND_NONE) {
+                    if (r.type == IR_TYPE_VOID || !writeOperand(in, frame, &inst->result, r)) return 0;
+                }
+                break;
+            }
+
+            case IR_RETURN:
+                return readOperand(in, frame, &inst->ar1, returned);
+
+            case IR_RETURN_VOID:
+                return 1;
+
+            case IR_REQ_MEM: {
+                if (inst->result.type != OPERAND_VAR) return 0;
+                if (!readOperand(in, frame, &inst->ar1, &a) || !isIntegerIr(a.type)) return 0;
+                int64_t block = allocateCells(in, a.intVal);
+                int64_t cell = block ? variableCell(in, frame, inst->result.value.var.id, 1) : 0;
+                if (!cell) return 0;
+                in->memory[cell] = pointerTo(block);
+                break;
+            }
+
+            case IR_ADDROF:
+                if (inst->ar2.type == OPERAND_NONE) {
+                    // &variable, the variable already lives in a cell
+                    if (inst->ar1.type != OPERAND_VAR) return 0;
+                    int64_t cell = variableCell(in, frame, inst->ar1.value.var.id, 1);
+                    if (!cell) return 0;
+                    r = pointerTo(cell);
+                } else {
+                    // &base[index]
+                    if (!readOperand(in, frame, &inst->ar1, &a) || !readOperand(in, frame, &inst->ar2, &b)) return 0;
+                    if (a.type != IR_TYPE_POINTER || !isIntegerIr(b.type)) return 0;
+                    r = pointerTo(a.intVal + b.intVal);
+                }
+                if (!writeOperand(in, frame, &inst->result, r)) return 0;
+                break;
+
+            case IR_POINTER_LOAD:
+            case IR_POINTER_STORE:
+            case IR_DEREF:
+            case IR_STORE: {
+                // PTRLD to, base, offset; PTRST base, offset, value; DEREF to, pointer; STORE -, pointer, value
+                int indexed = inst->op == IR_POINTER_LOAD || inst->op == IR_POINTER_STORE;
+                const IrOperand *base = inst->op == IR_POINTER_STORE ? &inst->result : &inst->ar1;
+                if (!readOperand(in, frame, base, &a) || a.type != IR_TYPE_POINTER) return 0;
+                if (indexed) {
+                    const IrOperand *offset = inst->op == IR_POINTER_STORE ? &inst->ar1 : &inst->ar2;
+                    if (!readOperand(in, frame, offset, &b) || !isIntegerIr(b.type)) return 0;
+                    a.intVal += b.intVal;
+                }
+                IrValue *cell = cellAt(in, a);
+                if (!cell) return 0;
+
+                if (inst->op == IR_POINTER_STORE || inst->op == IR_STORE) {
+                    if (!readOperand(in, frame, &inst->ar2, &b)) return 0;
+                    *cell = b;
+                } else {
+                    if (cell->type == IR_TYPE_VOID) return 0;
+                    if (!writeOperand(in, frame, &inst->result, *cell)) return 0;
+                }
+                break;
+            }
+
+            default:
+                // Strings, structs and nested functions
+                return 0;
+        }
+    }
+    return 1;
+}
+
+ConstValue interpretIr(IrContext *ctx, IrInstruction *start, IrOperand result) {
+    ConstValue value = {.type = TYPE_UNKNOWN};
+    if (!ctx) return value;
+
+    IrInterpreter in = {0};
+    indexContext(&in, ctx);
+    IrFrame frame = {0};
+    tempRange(start, &frame.firstTemp, &frame.tempCount);
+    frame.temps = trackedMalloc(MEM_IR, (frame.tempCount ? frame.tempCount : 1) * sizeof(IrValue));
+    in.memoryUsed = 1;
+
+    if (in.labels && frame.temps) {
+        for (int i = 0; i < frame.tempCount; i++) frame.temps[i].type = IR_TYPE_VOID;
+        IrValue returned, computed;
+        if (execute(&in, &frame, start, &returned) && readOperand(&in, &frame, &result, &computed)) {
+            value = toConstValue(computed);
+        }
+    }
+
+    trackedFree(MEM_IR, frame.temps);
+    trackedFree(MEM_IR, frame.varNames);
+    trackedFree(MEM_IR, frame.varCells);
+    trackedFree(MEM_IR, in.functions);
+    trackedFree(MEM_IR, in.labels);
+    trackedFree(MEM_IR, in.memory);
+    return value;
+}
@@ -1,6 +1,7 @@
 #include "ir.h"
 #include <stdlib.h>
 #include "irHelpers.h"
+#include "memTrack.h"
 
 int binaryConstant(IrInstruction *inst){
     return inst->ar1.type == OPERAND_CONSTANT && inst->ar2.type == OPERAND_CONSTANT;
@@ -91,7 +92,7 @@ int operandsEqual(IrOperand a, IrOperand b) {
     if (a.type != b.type) return 0;
     switch (a.type) {
         case OPERAND_TEMP: return a.value.temp.tempNum == b.value.temp.tempNum;
-        case OPERAND_VAR: return bufferEqual(a.value.var.name, a.value.var.nameLen, b.value.var.name, b.value.var.nameLen);
+        case OPERAND_VAR: return a.value.var.id == b.value.var.id;
         case OPERAND_LABEL: return a.value.label.labelNum == b.value.label.labelNum;
         default:
             return 0;
@@ -177,7 +178,7 @@ int deadCodeElimination(IrContext *ctx) {
                         ctx->lastInstruction = toDelete->prev;
                     }
 
-                    free(toDelete);
+                    trackedFree(MEM_IR, toDelete);
                     ctx->instructionCount--;
                     changed = 1;
                     continue;
@@ -3,33 +3,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <sys/stat.h>
+#include <pthread.h>
 
 #include "lexer.h"
 #include "codegen.h"
 #include "optimization.h"
-
-static char *readFile(const char *fileName){
-    FILE *file = fopen(fileName, "r");
-    if(!file){
-        fprintf(stderr, "Error: Cannot open file '%s'\n", fileName);
-        return NULL;
-    }
-
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    char *content = malloc(fileSize + 1);
-    if(!content){
-        fprintf(stderr, "Error: Cannot allocate memory for file '%s'\n", fileName);
-        fclose(file);
-        return NULL;
-    }
-
-    size_t bytesRead = fread(content, 1, fileSize, file);
-    content[bytesRead] = '\0';
-    fclose(file);
-    return content;
+#include "threadPool.h"
+#include "trace.h"
+#include "flatAST.h"
+#include "memTrack.h"
+
+static int fileExists(const char *path){
+    struct stat st;
+    return stat(path, &st) == 0;
 }
 
 static char *extractModuleName(const char *path){
@@ -111,18 +98,68 @@ char *resolveModulePath(const char *basePath, const char *moduleName){
     return resolved;
 }
 
-Module *findModule(BuildContext *ctx, const char *path){
-    for(int i=0;i<ctx->moduleCount; ++i){
-        if(strcmp(ctx->modules[i].path, path)==0){
-            return &ctx->modules[i];
-        }
+/**
+ * Module registry: open-addressed table from path hash to module index
+ */
+
+#define MODULE_INDEX_INITIAL 64
+
+static uint64_t hashPath(const char *path){
+    return hashBytes(path, strlen(path), HASH_SEED);
+}
+
+static int lookupModuleIndex(BuildContext *ctx, const char *path, uint64_t hash){
+    if(ctx->indexCapacity == 0) return -1;
+    int mask = ctx->indexCapacity - 1;
+    for(int slot = (int)(hash & mask);; slot = (slot + 1) & mask){
+        int idx = ctx->index[slot];
+        if(idx < 0) return -1;
+        Module *mod = &ctx->modules[idx];
+        if(mod->pathHash == hash && strcmp(mod->path, path) == 0) return idx;
+    }
+}
+
+static void insertModuleIndex(BuildContext *ctx, int idx){
+    int mask = ctx->indexCapacity - 1;
+    int slot = (int)(ctx->modules[idx].pathHash & mask);
+    while(ctx->index[slot] >= 0){
+        slot = (slot + 1) & mask;
+    }
+    ctx->index[slot] = idx;
+}
+
+static void reindexModules(BuildContext *ctx){
+    memset(ctx->index, -1, sizeof(int) * ctx->indexCapacity);
+    for(int i = 0; i < ctx->moduleCount; ++i){
+        insertModuleIndex(ctx, i);
     }
-    return NULL;
+}
+
+static int growModuleIndex(BuildContext *ctx){
+    int newCap = ctx->indexCapacity == 0 ? MODULE_INDEX_INITIAL : ctx->indexCapacity * 2;
+    int *newIndex = malloc(sizeof(int) * newCap);
+    if(!newIndex) return 0;
+
+    free(ctx->index);
+    ctx->index = newIndex;
+    ctx->indexCapacity = newCap;
+    reindexModules(ctx);
+    return 1;
+}
+
+Module *findModule(BuildContext *ctx, const char *path){
+    int idx = lookupModuleIndex(ctx, path, hashPath(path));
+    return idx >= 0 ? &ctx->modules[idx] : NULL;
 }
 
 static Module *addModule(BuildContext *ctx, const char *name, const char *path){
-    Module *existing = findModule(ctx, path);
-    if(existing) return existing;
+    uint64_t hash = hashPath(path);
+    int existing = lookupModuleIndex(ctx, path, hash);
+    if(existing >= 0) return &ctx->modules[existing];
+
+    // keep the table at most half full
+    if((ctx->moduleCount + 1) * 2 > ctx->indexCapacity && !growModuleIndex(ctx)) return NULL;
+
     if(ctx->moduleCount >= ctx->moduleCapacity){
         int newCap = ctx->moduleCapacity == 0 ? 8 : ctx->moduleCapacity * 2;
         Module *newMods = realloc(ctx->modules, sizeof(Module) * newCap);
@@ -135,128 +172,274 @@ static Module *addModule(BuildContext *ctx, const char *name, const char *path){
     memset(mod, 0, sizeof(Module));
     mod->name = strdup(name);
     mod->path = strdup(path);
+    mod->pathHash = hash;
     mod->imports = NULL;
     mod->importCount = 0;
     mod->importCapacity = 0;
     mod->interface = NULL;
+    insertModuleIndex(ctx, ctx->moduleCount - 1);
     return mod;
 }
 
-static int findModulesRec(BuildContext *ctx, const char *path){
-    char *name = extractModuleName(path);
-    if(!name) return 0;
+/**
+ * Import pre-scan over the token stream: `import "path";` at brace depth 0
+ * is exactly what extractImports finds on the AST, without parsing.
+ */
+char **scanImports(TokenList *tokens, int *count){
+    *count = 0;
+    if(!tokens) return NULL;
+
+    char **imports = NULL;
+    int capacity = 0;
+    int depth = 0;
+
+    for(size_t i = 0; i < tokens->count; ++i){
+        TokenType type = tokenType(tokens, i);
+        if(type == TK_LBRACE) depth++;
+        else if(type == TK_RBRACE && depth > 0) depth--;
+        if(depth != 0 || type != TK_IMPORT || i + 1 >= tokens->count) continue;
+
+        Token pathTok = tokenAt(tokens, i + 1);
+        if(pathTok.type != TK_STR) continue;
+
+        if(*count >= capacity){
+            int newCap = capacity == 0 ? 4 : capacity * 2;
+            char **newImports = realloc(imports, sizeof(char*) * newCap);
+            if(!newImports) break;
+            imports = newImports;
+            capacity = newCap;
+        }
 
-    char* resPath = realpath(path, NULL);
-    if(!resPath){
-        fprintf(stderr, "Error: Cannot resolve path '%s'\n", path);
-        free(name);
-        return 0;
+        const char *start = tokenStart(tokens, &pathTok);
+        size_t length = pathTok.length;
+        if(length>=2&&start[0]=='"'&&start[length-1]=='"'){
+            start++;
+            length-=2;
+        }
+        imports[(*count)++] = strndup(start, length);
     }
-    
-    if(findModule(ctx, resPath)){
-        free(name);
-        free(resPath);
-        return 1;
+    return imports;
+}
+
+static void freeImportNames(char **imports, int count){
+    for(int i = 0; i < count; ++i){
+        free(imports[i]);
     }
+    free(imports);
+}
 
-    char *source = readFile(path);
-    if (!source) {
-        fprintf(stderr, "Error: Cannot read module '%s' at '%s'\n", name, path);
-        free(name);
-        free(resPath);
-        return 0;
+/**
+ * Discovery worklist
+ *
+ * Every resolved path is registered once (under the lock) and queued; a
+ * worker reads and lexes it, scans its imports and registers those in turn.
+ * The lock guards ctx->modules and the path index, file I/O and lexing run
+ * outside it.
+ */
+
+typedef struct DiscoveryState {
+    BuildContext *ctx;
+    ThreadPool pool;
+    pthread_mutex_t lock;
+    int failed;
+} DiscoveryState;
+
+typedef struct DiscoveryTask {
+    DiscoveryState *state;
+    int moduleIndex;
+} DiscoveryTask;
+
+static void discoverModuleTask(void *arg);
+
+static void markDiscoveryFailed(DiscoveryState *state){
+    pthread_mutex_lock(&state->lock);
+    state->failed = 1;
+    pthread_mutex_unlock(&state->lock);
+}
+
+/**
+ * Returns the index of the module at resolved path resPath, queueing it
+ * for discovery the first time it is seen. -1 on failure.
+ */
+static int registerModule(DiscoveryState *state, const char *resPath){
+    BuildContext *ctx = state->ctx;
+
+    pthread_mutex_lock(&state->lock);
+    int idx = lookupModuleIndex(ctx, resPath, hashPath(resPath));
+    if(idx >= 0){
+        pthread_mutex_unlock(&state->lock);
+        return idx;
     }
 
-    TokenList *tokens = lex(source, resPath);
-    if (!tokens) {
-        fprintf(stderr, "Error: Failed to lex module '%s'\n", name);
-        free(source);
-        free(name);
-        free(resPath);
-        return 0;
+    char *name = extractModuleName(resPath);
+    Module *mod = name ? addModule(ctx, name, resPath) : NULL;
+    free(name);
+    if(!mod){
+        pthread_mutex_unlock(&state->lock);
+        fprintf(stderr, "Error: Failed to add module '%s'\n", resPath);
+        return -1;
     }
+    idx = (int)(mod - ctx->modules);
+    pthread_mutex_unlock(&state->lock);
 
-    ASTContext *ast = ASTGenerator(tokens);
-    if (!ast || !ast->root) {
-        fprintf(stderr, "Error: Failed to parse module '%s'\n", name);
-        freeTokens(tokens);
-        free(source);
-        free(name);
-        free(resPath);
-        return 0;
+    DiscoveryTask *task = malloc(sizeof(DiscoveryTask));
+    if(task){
+        task->state = state;
+        task->moduleIndex = idx;
     }
+    if(!task || !submitTask(state->pool, discoverModuleTask, task)){
+        free(task);
+        fprintf(stderr, "Error: Failed to queue module '%s'\n", resPath);
+        return -1;
+    }
+    return idx;
+}
 
-    Module *mod = addModule(ctx, name, resPath);
-    if(!mod){
-        fprintf(stderr, "Error: Failed to add module '%s'\n", name);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
-        free(name);
-        free(resPath);
-        return 0;
+static void discoverModuleTask(void *arg){
+    DiscoveryTask *task = arg;
+    DiscoveryState *state = task->state;
+    BuildContext *ctx = state->ctx;
+    int modIndex = task->moduleIndex;
+    free(task);
+
+    // name and path strings never move, only the Module structs do
+    pthread_mutex_lock(&state->lock);
+    const char *name = ctx->modules[modIndex].name;
+    const char *path = ctx->modules[modIndex].path;
+    pthread_mutex_unlock(&state->lock);
+
+    TraceMark spanStart = traceBegin();
+    SourceFile *source = mapSourceFile(path);
+    traceEnd("mapSource", name, spanStart);
+    if (!source) {
+        fprintf(stderr, "Error: Cannot read module '%s' at '%s'\n", name, path);
+        markDiscoveryFailed(state);
+        return;
     }
 
-    int importCount;
-    char **imports = extractImports(ast->root, &importCount);
+    spanStart = traceBegin();
+    uint64_t sourceHash = hashBytes(source->data, source->length, HASH_SEED);
+    traceEnd("hashSource", name, spanStart);
 
-    char* basePath = extractBasePath(resPath);
-    
-    for(int i = 0; i<importCount; ++i){
-        if(mod->importCount >= mod->importCapacity){
-            int newCap = mod->importCapacity == 0 ? 4 : mod->importCapacity * 2;
-            char **newImports = realloc(mod->imports, sizeof(char*) * newCap);
-            if(!newImports){
-                fprintf(stderr, "Error: Failed to allocate imports for module '%s'\n", name);
-                freeASTContext(ast);
-                freeTokens(tokens);
-                free(source);
-                free(name);
-                free(resPath);
-                free(basePath);
-                return 0;
-            }
+    // An unchanged source gets its tree back from the cache, no lexing or parsing
+    ASTContext *ast = NULL;
+    if (ctx->useCache) {
+        char astPath[512];
+        cachePath(astPath, sizeof(astPath), ctx->cacheDir, name, ".ast");
+        spanStart = traceBegin();
+        ast = loadFlatAST(astPath, sourceHash, source);
+        traceEnd("loadFlatAST", name, spanStart);
+    }
 
-            mod->imports = newImports;
-            mod->importCapacity = newCap;
+    // Otherwise the token list owns the mapping, compileModule parses it later and unmaps it when done
+    TokenList *tokens = NULL;
+    int importCount;
+    char **imports;
+    if (ast) {
+        imports = extractImports(ast->root, &importCount);
+    } else {
+        spanStart = traceBegin();
+        tokens = lexSource(source);
+        traceEnd("lex", name, spanStart);
+        if (!tokens) {
+            fprintf(stderr, "Error: Failed to lex module '%s'\n", name);
+            markDiscoveryFailed(state);
+            return;
         }
+        spanStart = traceBegin();
+        imports = scanImports(tokens, &importCount);
+        traceEnd("scanImports", name, spanStart);
+    }
+    int *importIndices = importCount > 0 ? malloc(sizeof(int) * importCount) : NULL;
+    char* basePath = extractBasePath(path);
+    int resolved = 0;
+    int ok = importCount == 0 || importIndices;
 
+    for(int i = 0; ok && i<importCount; ++i){
         char *importPath = resolveModulePath(basePath, imports[i]);
         if(!importPath){
             fprintf(stderr, "Error: Failed to resolve import '%s' for module '%s'\n", imports[i], name);
-            free(imports);
-            freeASTContext(ast);
-            freeTokens(tokens);
-            free(source);
-            free(name);
-            free(resPath);
-            free(basePath);
-            return 0;
+            ok = 0;
+            break;
         }
-        mod->imports[mod->importCount++] = strdup(importPath);  // store resolved path
-        free(imports[i]);
 
-        if(!findModulesRec(ctx, importPath)){
+        int importIndex = registerModule(state, importPath);
+        free(importPath);
+        if(importIndex < 0){
             fprintf(stderr, "Error: Failed to process import '%s' for module '%s'\n", imports[i], name);
-            free(importPath);
-            free(imports);
-            freeASTContext(ast);
-            freeTokens(tokens);
-            free(source);
-            free(name);
-            free(resPath);
-            free(basePath);
-            return 0;
+            ok = 0;
+            break;
+        }
+        importIndices[resolved++] = importIndex;
+    }
+
+    pthread_mutex_lock(&state->lock);
+    Module *mod = &ctx->modules[modIndex];
+    mod->tokens = tokens;
+    mod->ast = ast;
+    mod->source = ast ? source : NULL;
+    mod->sourceHash = sourceHash;
+    mod->imports = importIndices;
+    mod->importCount = resolved;
+    mod->importCapacity = importCount;
+    if(!ok) state->failed = 1;
+    pthread_mutex_unlock(&state->lock);
+
+    freeImportNames(imports, importCount);
+    free(basePath);
+}
+
+/**
+ * Workers finish in any order, renumber modules in depth-first import
+ * order from the entry so the compilation order is reproducible.
+ */
+static int orderModulesDepthFirst(BuildContext *ctx){
+    int n = ctx->moduleCount;
+    int *newIndex = malloc(sizeof(int) * n);
+    int *stack = malloc(sizeof(int) * n);
+    int *cursor = calloc(n, sizeof(int));
+    Module *ordered = malloc(sizeof(Module) * ctx->moduleCapacity);
+    if(!newIndex || !stack || !cursor || !ordered){
+        free(newIndex);
+        free(stack);
+        free(cursor);
+        free(ordered);
+        return 0;
+    }
+    memset(newIndex, -1, sizeof(int) * n);
+
+    // entry module is always registered first
+    int count = 0, top = 0;
+    newIndex[0] = count++;
+    stack[top++] = 0;
+    while(top > 0){
+        Module *mod = &ctx->modules[stack[top - 1]];
+        if(cursor[stack[top - 1]] >= mod->importCount){
+            top--;
+            continue;
+        }
+        int next = mod->imports[cursor[stack[top - 1]]++];
+        if(newIndex[next] < 0){
+            newIndex[next] = count++;
+            stack[top++] = next;
         }
-        free(importPath);
     }
 
-    free(basePath);
-    free(imports);
-    freeASTContext(ast);
-    freeTokens(tokens);
-    free(source);
-    free(name);
+    for(int i = 0; i < n; ++i){
+        Module *mod = &ctx->modules[i];
+        for(int j = 0; j < mod->importCount; ++j){
+            mod->imports[j] = newIndex[mod->imports[j]];
+        }
+        ordered[newIndex[i]] = *mod;
+    }
+
+    free(ctx->modules);
+    ctx->modules = ordered;
+    reindexModules(ctx);
+
+    free(newIndex);
+    free(stack);
+    free(cursor);
     return 1;
 }
 
@@ -264,143 +447,294 @@ int findModules(BuildContext *ctx, const char *entryPath){
     ctx->modules = NULL;
     ctx->moduleCount = 0;
     ctx->moduleCapacity = 0;
+    ctx->index = NULL;
+    ctx->indexCapacity = 0;
     ctx->basePath = extractBasePath(entryPath);
-    return findModulesRec(ctx, entryPath);
+
+    char* resPath = realpath(entryPath, NULL);
+    if(!resPath){
+        fprintf(stderr, "Error: Cannot resolve path '%s'\n", entryPath);
+        return 0;
+    }
+
+    DiscoveryState state = {.ctx = ctx, .failed = 0};
+    state.pool = createThreadPool(ctx->jobs);
+    if(!state.pool){
+        fprintf(stderr, "Error: Cannot start discovery workers\n");
+        free(resPath);
+        return 0;
+    }
+    pthread_mutex_init(&state.lock, NULL);
+
+    if(registerModule(&state, resPath) < 0){
+        state.failed = 1;
+    }
+    waitThreadPool(state.pool);
+    freeThreadPool(state.pool);
+    pthread_mutex_destroy(&state.lock);
+    free(resPath);
+
+    // every module was reached from the entry, so all of them got their imports
+    if(state.failed) return 0;
+    return orderModulesDepthFirst(ctx);
 }
 
 int *topoSortModules(BuildContext *ctx, int *outCount) {
     int n = ctx->moduleCount;
-    int *inDegree = calloc(n, sizeof(int));
+    *outCount = 0;
+    if (n == 0) return NULL;
+
+    int *inDegree = malloc(n * sizeof(int));
+    int *revStart = calloc(n + 1, sizeof(int));
     int *result = malloc(n * sizeof(int));
-    int *queue = malloc(n * sizeof(int));
-    int qHead = 0, qTail = 0;
-    int resultCount = 0;
-    
-    // Actually: in-degree[i] = number of modules that i depends on
-    // We want modules with no dependencies first
+    if (!inDegree || !revStart || !result) {
+        free(inDegree);
+        free(revStart);
+        free(result);
+        return NULL;
+    }
+
+    // in-degree[i] = number of modules that i depends on
+    // reverse edges (dependents) are laid out CSR style: revEdges[revStart[m] .. revStart[m+1])
+    int edgeCount = 0;
     for (int i = 0; i < n; i++) {
         Module *mod = &ctx->modules[i];
         inDegree[i] = mod->importCount;
-        
-        // But only count imports that are actual modules we're building
-        inDegree[i] = 0;
+        edgeCount += mod->importCount;
         for (int j = 0; j < mod->importCount; j++) {
-            if (findModule(ctx, mod->imports[j])) {
-                inDegree[i]++;
-            }
+            revStart[mod->imports[j] + 1]++;
         }
-        
+    }
+    for (int i = 0; i < n; i++) {
+        revStart[i + 1] += revStart[i];
+    }
+
+    int *revEdges = malloc((edgeCount > 0 ? edgeCount : 1) * sizeof(int));
+    int *fill = malloc(n * sizeof(int));
+    if (!revEdges || !fill) {
+        free(revEdges);
+        free(fill);
+        free(inDegree);
+        free(revStart);
+        free(result);
+        return NULL;
+    }
+    memcpy(fill, revStart, n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        Module *mod = &ctx->modules[i];
+        for (int j = 0; j < mod->importCount; j++) {
+            revEdges[fill[mod->imports[j]]++] = i;
+        }
+    }
+    free(fill);
+
+    // Kahn's algorithm, result doubles as the queue
+    int qTail = 0;
+    for (int i = 0; i < n; i++) {
         if (inDegree[i] == 0) {
-            queue[qTail++] = i;
+            result[qTail++] = i;
         }
     }
-    
-    // Process queue
-    while (qHead < qTail) {
-        int curr = queue[qHead++];
-        result[resultCount++] = curr;
-        
+    for (int qHead = 0; qHead < qTail; qHead++) {
+        int curr = result[qHead];
         // For each module that imports this one, decrease its in-degree
-        for (int i = 0; i < n; i++) {
-            Module *mod = &ctx->modules[i];
-            for (int j = 0; j < mod->importCount; j++) {
-                if (strcmp(mod->imports[j], ctx->modules[curr].path) == 0) {
-                    inDegree[i]--;
-                    if (inDegree[i] == 0) {
-                        queue[qTail++] = i;
-                    }
-                }
+        for (int e = revStart[curr]; e < revStart[curr + 1]; e++) {
+            int dependent = revEdges[e];
+            if (--inDegree[dependent] == 0) {
+                result[qTail++] = dependent;
             }
         }
     }
-    
+
     free(inDegree);
-    free(queue);
-    
+    free(revStart);
+    free(revEdges);
+
     // Check for cycle
-    if (resultCount != n) {
+    if (qTail != n) {
         fprintf(stderr, "Error: Circular dependency detected\n");
         free(result);
-        *outCount = 0;
         return NULL;
     }
-    
-    *outCount = resultCount;
+
+    *outCount = qTail;
     return result;
 }
 
-static int compileModule(BuildContext *ctx, Module *mod, int optLevel, 
+/**
+ * Combined interface hash of everything mod imports, in import order
+ */
+static uint64_t hashModuleDeps(BuildContext *ctx, Module *mod){
+    uint64_t hash = HASH_SEED;
+    for(int i = 0; i < mod->importCount; i++){
+        uint64_t ifaceHash = ctx->modules[mod->imports[i]].interfaceHash;
+        hash = hashBytes(&ifaceHash, sizeof(ifaceHash), hash);
+    }
+    return hash;
+}
+
+/**
+ * Reuse the cached object if nothing the module was built from changed.
+ * Only the interface hash of imports is compared, so an implementation-only
+ * edit to a dependency does not invalidate this module.
+ */
+static int loadCachedModule(BuildContext *ctx, Module *mod, int optLevel, uint64_t depsHash){
+    char stampPath[512], ifacePath[512], objPath[512];
+    cachePath(stampPath, sizeof(stampPath), ctx->cacheDir, mod->name, ".stamp");
+    cachePath(ifacePath, sizeof(ifacePath), ctx->cacheDir, mod->name, ".orni");
+    cachePath(objPath, sizeof(objPath), ctx->cacheDir, mod->name, ".o");
+
+    ModuleStamp stamp;
+    if(!readModuleStamp(stampPath, &stamp)) return 0;
+    if(stamp.sourceHash != mod->sourceHash || stamp.depsHash != depsHash ||
+       stamp.optLevel != optLevel || !fileExists(objPath)){
+        return 0;
+    }
+
+    ModuleInterface *iface = readModuleInterface(ifacePath);
+    if(!iface) return 0;
+    if(iface->hash != stamp.interfaceHash){
+        freeModuleInterface(iface);
+        return 0;
+    }
+
+    mod->interface = iface;
+    mod->interfaceHash = stamp.interfaceHash;
+    return 1;
+}
+
+// Tokens own the source when the module was lexed, otherwise the module handed it over
+static void releaseModuleSource(TokenList *tokens, SourceFile *source) {
+    if (tokens) freeTokens(tokens);
+    else releaseSource(source);
+}
+
+static int compileModule(BuildContext *ctx, Module *mod, ThreadPool checkPool, int optLevel,
                         int verbose, int showAST, int showIR) {
+    // Tokens or a cached tree were produced during discovery, compileModule owns them from here
+    TokenList *tokens = mod->tokens;
+    ASTContext *ast = mod->ast;
+    SourceFile *source = tokens ? tokens->source : mod->source;
+    mod->tokens = NULL;
+    mod->ast = NULL;
+    mod->source = NULL;
+    if (!tokens && !ast) {
+        fprintf(stderr, "Error: Module '%s' was not lexed\n", mod->path);
+        return 0;
+    }
+    int parsedNow = ast == NULL;
+
+    TraceMark spanStart = traceBegin();
+    uint64_t depsHash = hashModuleDeps(ctx, mod);
+    int upToDate = ctx->useCache && !showAST && !showIR &&
+                   loadCachedModule(ctx, mod, optLevel, depsHash);
+    traceEnd("cacheCheck", mod->name, spanStart);
+
+    if (upToDate) {
+        if (verbose) {
+            printf("  Up to date %s\n", mod->name);
+        }
+        freeASTContext(ast);
+        releaseModuleSource(tokens, source);
+        return 1;
+    }
+
     if (verbose) {
         printf("  Compiling %s...\n", mod->name);
     }
-    
-    // Read source
-    char *source = readFile(mod->path);
-    if (!source) {
-        fprintf(stderr, "Error: Cannot read '%s'\n", mod->path);
-        return 0;
-    }
 
     if (showAST || showIR) {
         printf("\n=== MODULE: %s ===\n", mod->name);
         printf("Source: %s\n", mod->path);
     }
     
-    // Lex
-    TokenList *tokens = lex(source, mod->path);
-    if (!tokens) {
-        free(source);
-        return 0;
+    // Parse, unless the tree came from the cache
+    if (parsedNow) {
+        spanStart = traceBegin();
+        // Bodies are parsed as type checking reaches them; --ast prints the whole tree up front
+        ast = showAST ? ASTGenerator(tokens) : ASTGeneratorDeferred(tokens);
+        traceEnd("ASTGenerator", mod->name, spanStart);
     }
-    
-    // Parse
-    ASTContext *ast = ASTGenerator(tokens);
     if (!ast || !ast->root) {
-        freeTokens(tokens);
-        free(source);
+        freeASTContext(ast);
+        releaseModuleSource(tokens, source);
         return 0;
     }
 
     if (showAST) {
         printf("\n--- AST: %s ---\n", mod->name);
-        printAST(ast->root, 0);
+        FlatAST *flat = flattenAST(ast);
+        printFlatAST(flat);
+        freeFlatAST(flat);
         printf("\n");
     }
     
     // Create type check context
+    spanStart = traceBegin();
     TypeCheckContext typeCtx = createTypeCheckContext(source, mod->path);
     if (!typeCtx) {
         freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+        releaseModuleSource(tokens, source);
         return 0;
     }
+    typeCtx->ast = ast;
+    typeCtx->pool = checkPool;
     
-    // Load imports into symbol table
+    // Imported exports are read in place from each interface's shared table
     for (int i = 0; i < mod->importCount; i++) {
-        Module *imported = findModule(ctx, mod->imports[i]);
-        if (imported && imported->interface) {
-            addImportsToSymbolTable(typeCtx->global, imported->interface);
+        Module *imported = &ctx->modules[mod->imports[i]];
+        if (imported->interface) {
+            addPreludeTable(typeCtx->global, getInterfaceSymbols(imported->interface));
+        }
+    }
+    // Type check, a failed check has already freed the context
+    if (!typeCheckAST(ast->root, source, mod->path, typeCtx)) {
+        traceEnd("typeCheckAST", mod->name, spanStart);
+        freeASTContext(ast);
+        releaseModuleSource(tokens, source);
+        return 0;
+    }
+    traceEnd("typeCheckAST", mod->name, spanStart);
+    // Type checking expanded every body, so the tree is complete; later
+    // builds reuse it while the source stays the same
+    if (parsedNow && ctx->useCache && getErrorCount() == 0) {
+        spanStart = traceBegin();
+        char astPath[512];
+        cachePath(astPath, sizeof(astPath), ctx->cacheDir, mod->name, ".ast");
+        FlatAST *flat = flattenAST(ast);
+        if (!flat || !saveFlatAST(flat, mod->sourceHash, astPath)) {
+            // Not fatal, the module is just parsed again next time
+            remove(astPath);
         }
+        freeFlatAST(flat);
+        traceEnd("saveFlatAST", mod->name, spanStart);
     }
-    // Type check
-    typeCheckAST(ast->root, source, mod->path, typeCtx);
     // Extract exports for dependents
+    spanStart = traceBegin();
     mod->interface = extractExportsWithContext(ast->root, mod->name, typeCtx);
+    mod->interfaceHash = mod->interface ? mod->interface->hash : 0;
+    traceEnd("extractExportsWithContext", mod->name, spanStart);
     // Generate IR
+    spanStart = traceBegin();
     IrContext *ir = generateIr(ast->root, typeCtx);
+    traceEnd("generateIr", mod->name, spanStart);
+
+    // Nothing past IR needs the tokens, AST or scopes, only the source text
+    // that names point into. Freeing them here keeps peak memory at the
+    // largest module instead of growing with every module compiled.
+    freeTypeCheckContext(typeCtx);
+    freeASTContext(ast);
+    if (tokens) freeTokenArray(tokens);
     if (!ir) {
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+        releaseModuleSource(tokens, source);
         return 0;
     }
     
     // Optimize
     if (optLevel > 0) {
+        spanStart = traceBegin();
         optimizeIR(ir, optLevel);
+        traceEnd("optimizeIR", mod->name, spanStart);
     }
 
     if (showIR) {
@@ -417,8 +751,8 @@ static int compileModule(BuildContext *ctx, Module *mod, int optLevel,
         imports = malloc(mod->importCount * sizeof(ModuleInterface*));
         if (imports) {
             for (int i = 0; i < mod->importCount; i++) {
-                Module *imported = findModule(ctx, mod->imports[i]);
-                if (imported && imported->interface) {
+                Module *imported = &ctx->modules[mod->imports[i]];
+                if (imported->interface) {
                     imports[importCount++] = imported->interface;
                 }
             }
@@ -426,15 +760,14 @@ static int compileModule(BuildContext *ctx, Module *mod, int optLevel,
     }
     
     // Generate assembly
+    spanStart = traceBegin();
     char *assembly = generateAssembly(ir, mod->name, imports, importCount);
+    traceEnd("generateAssembly", mod->name, spanStart);
     free(imports);
 
     if (!assembly) {
         freeIrContext(ir);
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+        releaseModuleSource(tokens, source);
         return 0;
     }
 
@@ -443,45 +776,55 @@ static int compileModule(BuildContext *ctx, Module *mod, int optLevel,
     
     // Write assembly file
     char asmPath[512];
-    snprintf(asmPath, sizeof(asmPath), "%s/%s.s", ctx->basePath, mod->name);
+    cachePath(asmPath, sizeof(asmPath), ctx->cacheDir, mod->name, ".s");
     if (!writeAssemblyToFile(assembly, asmPath)) {
         free(assembly);
         freeIrContext(ir);
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+        releaseModuleSource(tokens, source);
         return 0;
     }
     
     // Assemble to .o
     char objPath[512];
     char cmd[2048];
-    snprintf(objPath, sizeof(objPath), "%s/%s.o", ctx->basePath, mod->name);
+    cachePath(objPath, sizeof(objPath), ctx->cacheDir, mod->name, ".o");
     snprintf(cmd, sizeof(cmd), "gcc -c -o %s %s 2>&1", objPath, asmPath);
     
+    spanStart = traceBegin();
     int result = system(cmd);
+    traceEnd("gcc", mod->name, spanStart);
     if (result != 0) {
         fprintf(stderr, "Error: Failed to assemble '%s'\n", asmPath);
         free(assembly);
         freeIrContext(ir);
-        freeTypeCheckContext(typeCtx);
-        freeASTContext(ast);
-        freeTokens(tokens);
-        free(source);
+        releaseModuleSource(tokens, source);
         return 0;
     }
     
     // Cleanup assembly file
     remove(asmPath);
-    
+
+    // Record what the object was built from
+    spanStart = traceBegin();
+    char ifacePath[512], stampPath[512];
+    cachePath(ifacePath, sizeof(ifacePath), ctx->cacheDir, mod->name, ".orni");
+    cachePath(stampPath, sizeof(stampPath), ctx->cacheDir, mod->name, ".stamp");
+    ModuleStamp stamp = {
+        .sourceHash = mod->sourceHash,
+        .depsHash = depsHash,
+        .interfaceHash = mod->interfaceHash,
+        .optLevel = optLevel
+    };
+    if (!writeModuleInterface(mod->interface, ifacePath) || !writeModuleStamp(stampPath, &stamp)) {
+        // Not fatal, the module just gets rebuilt next time
+        remove(stampPath);
+    }
+    traceEnd("writeCache", mod->name, spanStart);
+
     // Cleanup
     free(assembly);
     freeIrContext(ir);
-    freeTypeCheckContext(typeCtx);
-    freeASTContext(ast);
-    freeTokens(tokens);
-    free(source);
+    releaseModuleSource(tokens, source);
     
     return 1;
 }
@@ -495,26 +838,23 @@ static int linkModules(BuildContext *ctx, const char *outputPath, int verbose) {
     
     for (int i = 0; i < ctx->moduleCount; i++) {
         pos += snprintf(cmd + pos, sizeof(cmd) - pos, " %s/%s.o", 
-                        ctx->basePath, ctx->modules[i].name);
+                        ctx->cacheDir, ctx->modules[i].name);
     }
     
     pos += snprintf(cmd + pos, sizeof(cmd) - pos, " ./runtime.s 2>&1");
     
+    // .o files stay in the cache for the next build
     int result = system(cmd);
-    
-    // Cleanup .o files
-    for (int i = 0; i < ctx->moduleCount; i++) {
-        char objPath[512];
-        snprintf(objPath, sizeof(objPath), "%s/%s.o", ctx->basePath, ctx->modules[i].name);
-        remove(objPath);
-    }
-    
     return result == 0;
 }
 
-int buildProject(const char *entryPath, const char *outputPath, int optLevel, 
-                 int verbose, int showAST, int showIR) {
+static int runBuild(const char *entryPath, const char *outputPath, const BuildOptions *opts) {
     BuildContext ctx = {0};
+    int optLevel = opts->optLevel;
+    int verbose = opts->verbose;
+    int showAST = opts->showAST;
+    int showIR = opts->showIR;
+    ctx.jobs = opts->jobs;
     
     if (verbose || showAST || showIR) {
         printf("=== BUILD ===\n");
@@ -522,9 +862,22 @@ int buildProject(const char *entryPath, const char *outputPath, int optLevel,
         printf("Optimization: -O%d\n", optLevel);
     }
     
+    // The cache sits next to the entry file and discovery already reads from it
+    char *basePath = extractBasePath(entryPath);
+    ctx.cacheDir = basePath ? openCacheDir(basePath) : NULL;
+    free(basePath);
+    if (!ctx.cacheDir) {
+        freeBuildContext(&ctx);
+        return 0;
+    }
+    ctx.useCache = opts->useCache;
+
     // 1. Discover all modules
     if (verbose) printf("Discovering modules...\n");
-    if (!findModules(&ctx, entryPath)) {
+    TraceMark spanStart = traceBegin();
+    int found = findModules(&ctx, entryPath);
+    traceEnd("findModules", NULL, spanStart);
+    if (!found) {
         freeBuildContext(&ctx);
         return 0;
     }
@@ -538,7 +891,9 @@ int buildProject(const char *entryPath, const char *outputPath, int optLevel,
     
     // 2. Topological sort
     int sortedCount;
+    spanStart = traceBegin();
     int *sorted = topoSortModules(&ctx, &sortedCount);
+    traceEnd("topoSortModules", NULL, spanStart);
     if (!sorted) {
         freeBuildContext(&ctx);
         return 0;
@@ -552,23 +907,30 @@ int buildProject(const char *entryPath, const char *outputPath, int optLevel,
         printf("\n");
     }
     
-    // 3. Compile each module in order
+    // 3. Compile each module in order, function bodies are type checked on the pool
     if (verbose) printf("Compiling...\n");
+    int workers = ctx.jobs > 0 ? ctx.jobs : defaultWorkerCount();
+    ThreadPool checkPool = workers > 1 ? createThreadPool(workers) : NULL;
     for (int i = 0; i < sortedCount; i++) {
         Module *mod = &ctx.modules[sorted[i]];
-        if (!compileModule(&ctx, mod, optLevel, verbose, showAST, showIR)) {
+        if (!compileModule(&ctx, mod, checkPool, optLevel, verbose, showAST, showIR)) {
             fprintf(stderr, "Error: Failed to compile module '%s'\n", mod->name);
+            freeThreadPool(checkPool);
             free(sorted);
             freeBuildContext(&ctx);
             return 0;
         }
     }
+    freeThreadPool(checkPool);
     
     free(sorted);
     
     // 4. Link
     if (verbose) printf("Linking...\n");
-    if (!linkModules(&ctx, outputPath, verbose)) {
+    spanStart = traceBegin();
+    int linked = linkModules(&ctx, outputPath, verbose);
+    traceEnd("link", NULL, spanStart);
+    if (!linked) {
         fprintf(stderr, "Error: Linking failed\n");
         freeBuildContext(&ctx);
         return 0;
@@ -583,19 +945,42 @@ int buildProject(const char *entryPath, const char *outputPath, int optLevel,
     return 1;
 }
 
+int buildProject(const char *entryPath, const char *outputPath, const BuildOptions *opts) {
+    int tracing = opts->timeReport || opts->tracePath || opts->memReport;
+    if (tracing) enableTracing();
+    if (opts->memReport) enableMemTracking();
+
+    int ok = runBuild(entryPath, outputPath, opts);
+
+    if (opts->timeReport) printTimeReport(stdout);
+    if (opts->memReport) {
+        disableMemTracking();
+        printf("\n=== MEMORY REPORT ===\n");
+        printSubsystemMemReport(stdout);
+        printf("\n");
+        printPhaseMemReport(stdout);
+        printf("Peak RSS: %.1f MiB\n", peakRssKb() / 1024.0);
+    }
+    if (opts->tracePath && !writeChromeTrace(opts->tracePath)) ok = 0;
+    if (tracing) resetTracing();
+    return ok;
+}
+
 void freeBuildContext(BuildContext *ctx) {
     for (int i = 0; i < ctx->moduleCount; i++) {
         Module *mod = &ctx->modules[i];
         free(mod->name);
         free(mod->path);
-        for (int j = 0; j < mod->importCount; j++) {
-            free(mod->imports[j]);
-        }
         free(mod->imports);
+        freeTokens(mod->tokens);
+        freeASTContext(mod->ast);
+        releaseSource(mod->source);
         if (mod->interface) {
             freeModuleInterface(mod->interface);
         }
     }
     free(ctx->modules);
+    free(ctx->index);
     free(ctx->basePath);
+    free(ctx->cacheDir);
 }
\ No newline at end of file
@@ -2,25 +2,54 @@
 #define BUILD_H
 
 #include "interface.h"
+#include "cache.h"
 
 typedef struct Module {
     char *name;
     char *path;
-    char **imports;
+    uint64_t pathHash;
+    int *imports;           // indices into BuildContext.modules
     int importCount;
     int importCapacity;
     ModuleInterface *interface;
+    TokenList *tokens;      // from discovery, consumed by compilation
+    ASTContext *ast;        // from the AST cache instead, tokens is then NULL
+    SourceFile *source;     // owned here while ast came from the cache
+    uint64_t sourceHash;
+    uint64_t interfaceHash;
 } Module;
 
 typedef struct BuildContext {
     Module *modules;
     int moduleCount;
     int moduleCapacity;
+    int *index;             // path hash -> module index, -1 marks an empty slot
+    int indexCapacity;
     char *basePath;
+    char *cacheDir;         // set before discovery, which reads parsed trees from it
+    int useCache;
+    int jobs;               // discovery and body type checking workers, <= 0 uses one per CPU
 } BuildContext;
 
+typedef struct BuildOptions {
+    int optLevel;
+    int verbose;
+    int showAST;
+    int showIR;
+    int useCache;
+    int jobs;
+    int timeReport;         // print per-phase totals after the build
+    const char *tracePath;  // write Chrome trace-event JSON here, NULL to skip
+    int memReport;          // count allocations per subsystem and phase
+} BuildOptions;
+
 char **extractImports(ASTNode ast, int *count);
 
+/**
+ * @brief Collect top-level import paths straight from the tokens, no parse needed
+ */
+char **scanImports(TokenList *tokens, int *count);
+
 /**
  * @brief Resolve module path from import name
  * "math" -> "/path/to/math.orn"
@@ -29,6 +58,10 @@ char *resolveModulePath(const char *basePath, const char *moduleName);
 
 /**
  * @brief Discover all modules starting from entry file
+ * Modules are read and lexed concurrently on ctx->jobs workers, then
+ * numbered in depth-first import order from the entry (index 0). With
+ * useCache, a module whose source hash matches its cached tree loads that
+ * tree instead of being lexed.
  */
 int findModules(BuildContext *ctx, const char *entryPath);
 
@@ -40,11 +73,13 @@ int *topoSortModules(BuildContext *ctx, int *outCount);
 
 /**
  * @brief Build entire project from entry file
+ * With useCache, modules whose source and imported interfaces are unchanged
+ * reuse the object and interface stored in the cache directory.
  */
-int buildProject(const char *entryPath, const char *outputPath, int optLevel, int verbose,int showAST, int showIR);
+int buildProject(const char *entryPath, const char *outputPath, const BuildOptions *opts);
 
 /**
- * @brief Find module by name
+ * @brief Find module by resolved path, O(1) through the path index
  */
 Module *findModule(BuildContext *ctx, const char *name);
 
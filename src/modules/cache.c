@@ -0,0 +1,63 @@
+#include "cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+/* hash documentation http://www.isthe.com/chongo/tech/comp/fnv/ */
+uint64_t hashBytes(const void *data, size_t len, uint64_t seed){
+    const unsigned char *p = data;
+    uint64_t hash = seed;
+    for(size_t i = 0; i < len; ++i){
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+char *openCacheDir(const char *basePath){
+    size_t len = strlen(basePath) + 1 + strlen(CACHE_DIR_NAME) + 1;
+    char *dir = malloc(len);
+    if(!dir) return NULL;
+    snprintf(dir, len, "%s/%s", basePath, CACHE_DIR_NAME);
+
+    if(mkdir(dir, 0755) != 0 && errno != EEXIST){
+        fprintf(stderr, "Error: Cannot create cache directory '%s'\n", dir);
+        free(dir);
+        return NULL;
+    }
+    return dir;
+}
+
+void cachePath(char *out, size_t size, const char *cacheDir, const char *moduleName,
+               const char *ext){
+    snprintf(out, size, "%s/%s%s", cacheDir, moduleName, ext);
+}
+
+int readModuleStamp(const char *path, ModuleStamp *stamp){
+    FILE *f = fopen(path, "r");
+    if(!f) return 0;
+
+    int version = 0;
+    int ok = fscanf(f, "stamp %d\n", &version) == 1 && version == CACHE_STAMP_VERSION &&
+             fscanf(f, "source %" SCNx64 "\n", &stamp->sourceHash) == 1 &&
+             fscanf(f, "deps %" SCNx64 "\n", &stamp->depsHash) == 1 &&
+             fscanf(f, "interface %" SCNx64 "\n", &stamp->interfaceHash) == 1 &&
+             fscanf(f, "opt %d\n", &stamp->optLevel) == 1;
+    fclose(f);
+    return ok;
+}
+
+int writeModuleStamp(const char *path, const ModuleStamp *stamp){
+    FILE *f = fopen(path, "w");
+    if(!f) return 0;
+
+    fprintf(f, "stamp %d\n", CACHE_STAMP_VERSION);
+    fprintf(f, "source %016" PRIx64 "\n", stamp->sourceHash);
+    fprintf(f, "deps %016" PRIx64 "\n", stamp->depsHash);
+    fprintf(f, "interface %016" PRIx64 "\n", stamp->interfaceHash);
+    fprintf(f, "opt %d\n", stamp->optLevel);
+    return fclose(f) == 0;
+}
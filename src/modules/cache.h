@@ -0,0 +1,51 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CACHE_DIR_NAME ".orn-cache"
+#define CACHE_STAMP_VERSION 1
+#define HASH_SEED 14695981039346656037ull
+
+/**
+ * @brief Per-module record of what the cached object was built from.
+ *
+ * A module is up to date when its own source hash, the combined interface
+ * hash of its imports and the optimization level all match. Dependents
+ * only look at interfaceHash, so body-only edits stop at the module.
+ */
+typedef struct ModuleStamp {
+    uint64_t sourceHash;
+    uint64_t depsHash;
+    uint64_t interfaceHash;
+    int optLevel;
+} ModuleStamp;
+
+/**
+ * @brief 64-bit FNV-1a, chainable through seed (start with HASH_SEED)
+ */
+uint64_t hashBytes(const void *data, size_t len, uint64_t seed);
+
+/**
+ * @brief Create the cache directory under basePath, returns its path
+ */
+char *openCacheDir(const char *basePath);
+
+/**
+ * @brief Build "<cacheDir>/<moduleName><ext>"
+ */
+void cachePath(char *out, size_t size, const char *cacheDir, const char *moduleName,
+               const char *ext);
+
+/**
+ * @brief Read a module stamp, returns 0 if missing or stale format
+ */
+int readModuleStamp(const char *path, ModuleStamp *stamp);
+
+/**
+ * @brief Write a module stamp
+ */
+int writeModuleStamp(const char *path, const ModuleStamp *stamp);
+
+#endif // CACHE_H
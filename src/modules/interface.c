@@ -1,112 +1,18 @@
 #include "interface.h"
+#include "cache.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-const char *dataTypeToString(DataType type) {
-    switch (type) {
-    case TYPE_I8:
-        return "i8";
-    case TYPE_I16:
-        return "i16";
-    case TYPE_I32:
-        return "i32";
-    case TYPE_I64:
-        return "i64";
-    case TYPE_U8:
-        return "u8";
-    case TYPE_U16:
-        return "u16";
-    case TYPE_U32:
-        return "u32";
-    case TYPE_U64:
-        return "u64";
-    case TYPE_FLOAT:
-        return "float";
-    case TYPE_DOUBLE:
-        return "double";
-    case TYPE_STRING:
-        return "string";
-    case TYPE_BOOL:
-        return "bool";
-    case TYPE_VOID:
-        return "void";
-    case TYPE_POINTER:
-        return "ptr";
-    default:
-        return "unknown";
-    }
-}
-
-DataType stringToDataType(const char *str) {
-    if (!str) return TYPE_UNKNOWN;
-    if (strcmp(str, "i8") == 0) return TYPE_I8;
-    if (strcmp(str, "i16") == 0) return TYPE_I16;
-    if (strcmp(str, "i32") == 0) return TYPE_I32;
-    if (strcmp(str, "i64") == 0) return TYPE_I64;
-    if (strcmp(str, "u8") == 0) return TYPE_U8;
-    if (strcmp(str, "u16") == 0) return TYPE_U16;
-    if (strcmp(str, "u32") == 0) return TYPE_U32;
-    if (strcmp(str, "u64") == 0) return TYPE_U64;
-    if (strcmp(str, "float") == 0) return TYPE_FLOAT;
-    if (strcmp(str, "double") == 0) return TYPE_DOUBLE;
-    if (strcmp(str, "string") == 0) return TYPE_STRING;
-    if (strcmp(str, "bool") == 0) return TYPE_BOOL;
-    if (strcmp(str, "void") == 0) return TYPE_VOID;
-    if (strcmp(str, "ptr") == 0) return TYPE_POINTER;
-    if (str[0] == '*') return TYPE_POINTER;
-    return TYPE_STRUCT;
-}
-
-static char *buildTypeString(DataType type, int pointerLevel) {
-    const char *baseStr = dataTypeToString(type);
-
-    size_t len = pointerLevel + strlen(baseStr) + 1;
-    char *result = malloc(len);
-    if (!result) return NULL;
-
-    memset(result, '*', pointerLevel);
-    strcpy(result + pointerLevel, baseStr);
-    return result;
-}
-
-static char *buildParamSignature(FunctionParameter params) {
-    if (!params) {
-        return strdup("");
-    }
-
-    size_t totalLen = 0;
-    FunctionParameter p = params;
-    while (p) {
-        totalLen += strlen(dataTypeToString(p->type)) + p->pointerLevel + 3;
-        p = p->next;
-    }
-
-    char *result = malloc(totalLen + 1);
-    if (!result) return NULL;
-    result[0] = '\0';
-
-    p = params;
-    int first = 1;
-    while (p) {
-        if (!first) strcat(result, ", ");
-        first = 0;
+#include "stringBuffer.h"
+#include "arena.h"
 
-        // Handle pointer types
-        DataType baseType = p->type;
-        int ptrLevel = p->pointerLevel;
-
-        char *typeStr = buildTypeString(baseType, ptrLevel);
-        if (typeStr) {
-            strcat(result, typeStr);
-            free(typeStr);
-        }
-        p = p->next;
-    }
-
-    return result;
-}
+#define INTERFACE_ARENA_CHUNK (4 * 1024)
 
 static ExportedFunction *createExportedFunction(ASTNode funcNode, TypeCheckContext ctx) {
     if (!funcNode || funcNode->nodeType != FUNCTION_DEFINITION) return NULL;
@@ -115,13 +21,30 @@ static ExportedFunction *createExportedFunction(ASTNode funcNode, TypeCheckConte
     if (!ef) return NULL;
 
     ef->name = strndup(funcNode->start, funcNode->length);
+    ef->nameId = funcNode->name;
+    ef->returnType = TYPE_VOID;
 
-    Symbol funcSym = lookupSymbol(ctx->global, funcNode->start, funcNode->length);
+    Symbol funcSym = lookupSymbol(ctx->global, funcNode->name);
     if (funcSym && funcSym->symbolType == SYMBOL_FUNCTION) {
-        ef->signature = buildParamSignature(funcSym->parameters);
-        DataType retType = funcSym->returnsPointer ? funcSym->returnBaseType : funcSym->type;
-        int retPtrLevel = funcSym->returnPointerLevel;
-        ef->returnType = buildTypeString(retType, retPtrLevel);
+        if (funcSym->paramCount > 0) {
+            ExportedParam *params = malloc(funcSym->paramCount * sizeof(ExportedParam));
+            if (!params) {
+                free(ef->name);
+                free(ef);
+                return NULL;
+            }
+            int n = 0;
+            for (FunctionParameter p = funcSym->parameters; p && n < funcSym->paramCount;
+                 p = p->next) {
+                params[n].type = (uint8_t)p->type;
+                params[n].pointerLevel = (uint8_t)p->pointerLevel;
+                n++;
+            }
+            ef->params = params;
+            ef->paramCount = n;
+        }
+        ef->returnType = funcSym->returnsPointer ? funcSym->returnBaseType : funcSym->type;
+        ef->returnPointerLevel = funcSym->returnPointerLevel;
     }
 
     return ef;
@@ -130,7 +53,7 @@ static ExportedFunction *createExportedFunction(ASTNode funcNode, TypeCheckConte
 static ExportedStruct *createExportedStruct(ASTNode structNode, TypeCheckContext ctx) {
     if (!structNode || structNode->nodeType != STRUCT_DEFINITION) return NULL;
 
-    Symbol structSym = lookupSymbol(ctx->global, structNode->start, structNode->length);
+    Symbol structSym = lookupSymbol(ctx->global, structNode->name);
     if (!structSym || structSym->symbolType != SYMBOL_TYPE || !structSym->structType) {
         return NULL;
     }
@@ -155,7 +78,7 @@ static ExportedStruct *createExportedStruct(ASTNode structNode, TypeCheckContext
         }
 
         ef->name = strndup(field->nameStart, field->nameLength);
-        ef->type = strdup(dataTypeToString(field->type));
+        ef->type = field->type;
         ef->offset = field->offset;
         ef->isPointer = 0;  // @todo: pointers in structs
         ef->pointerLevel = 0;
@@ -174,13 +97,34 @@ static ExportedStruct *createExportedStruct(ASTNode structNode, TypeCheckContext
     return es;
 }
 
-static StructType createStructTypeFromExport(ExportedStruct *es) {
-    StructType st = malloc(sizeof(struct StructType));
+static ExportedConst *createExportedConst(ASTNode constNode, TypeCheckContext ctx) {
+    ASTNode varDef = constNode ? constNode->children : NULL;
+    if (!varDef || varDef->nodeType != VAR_DEFINITION) return NULL;
+
+    Symbol constSym = lookupSymbol(ctx->global, varDef->name);
+    if (!constSym || constSym->symbolType != SYMBOL_VARIABLE ||
+        constSym->constValue.type == TYPE_UNKNOWN) {
+        return NULL;
+    }
+
+    ExportedConst *ec = calloc(1, sizeof(ExportedConst));
+    if (!ec) return NULL;
+
+    ec->name = strndup(varDef->start, varDef->length);
+    ec->nameId = varDef->name;
+    ec->value = constSym->constValue;
+    return ec;
+}
+
+// Lives in the importing module's arena, names point at the interned text
+static StructType createStructTypeFromExport(Arena *arena, ExportedStruct *es) {
+    StructType st = arenaAlloc(arena, sizeof(struct StructType));
     if (!st) return NULL;
+    memset(st, 0, sizeof(struct StructType));
 
-    char *nameCopy = strdup(es->name);
-    st->nameStart = nameCopy;
-    st->nameLength = strlen(es->name);
+    NameId structName = internName(es->name, strlen(es->name));
+    st->nameStart = nameText(structName);
+    st->nameLength = nameLength(structName);
     st->size = es->size;
     st->fieldCount = es->fieldCount;
     st->fields = NULL;
@@ -189,17 +133,17 @@ static StructType createStructTypeFromExport(ExportedStruct *es) {
     StructField lastField = NULL;
 
     while (ef) {
-        StructField sf = malloc(sizeof(struct StructField));
+        StructField sf = arenaAlloc(arena, sizeof(struct StructField));
         if (!sf) {
             ef = ef->next;
             continue;
         }
+        memset(sf, 0, sizeof(struct StructField));
 
-        // Duplicar nombre del campo
-        char *fieldNameCopy = strdup(ef->name);
-        sf->nameStart = fieldNameCopy;
-        sf->nameLength = strlen(ef->name);
-        sf->type = stringToDataType(ef->type);
+        sf->name = internName(ef->name, strlen(ef->name));
+        sf->nameStart = nameText(sf->name);
+        sf->nameLength = nameLength(sf->name);
+        sf->type = ef->type;
         sf->offset = ef->offset;
         sf->next = NULL;
 
@@ -228,10 +172,16 @@ ModuleInterface *extractExportsWithContext(ASTNode ast, const char *moduleName,
     iface->functionCount = 0;
     iface->structs = NULL;
     iface->structCount = 0;
+    iface->consts = NULL;
+    iface->constCount = 0;
+    iface->functionsDecoded = 1;
+    iface->structsDecoded = 1;
+    iface->constsDecoded = 1;
 
     ASTNode stmt = ast->children;
     ExportedFunction *lastFunc = NULL;
     ExportedStruct *lastStruct = NULL;
+    ExportedConst *lastConst = NULL;
 
     while (stmt) {
         if (stmt->nodeType == EXPORTDEC && stmt->children) {
@@ -261,77 +211,62 @@ ModuleInterface *extractExportsWithContext(ASTNode ast, const char *moduleName,
                     iface->structCount++;
                 }
             }
+            else if (child->nodeType == CONST_DEC) {
+                ExportedConst *ec = createExportedConst(child, ctx);
+                if (ec) {
+                    if (!iface->consts) {
+                        iface->consts = ec;
+                    } else if (lastConst) {
+                        lastConst->next = ec;
+                    }
+                    lastConst = ec;
+                    iface->constCount++;
+                }
+            }
         }
         stmt = stmt->brothers;
     }
 
+    iface->hash = hashModuleInterface(iface);
     return iface;
 }
 
-static int countPointerStars(const char **str) {
-    int count = 0;
-    while (**str == '*') {
-        count++;
-        (*str)++;
-    }
-    return count;
-}
-
-static FunctionParameter parseParamSignature(const char *sig) {
-    if (!sig || !*sig) return NULL;
-
+static FunctionParameter buildParamList(Arena *arena, const ExportedParam *params, int count) {
     FunctionParameter first = NULL;
     FunctionParameter last = NULL;
 
-    const char *p = sig;
-    while (*p) {
-        // Skip whitespace and commas
-        while (*p == ' ' || *p == ',') p++;
-        if (!*p) break;
-
-        // Count pointer level
-        int ptrLevel = countPointerStars(&p);
-
-        // Read type name
-        const char *typeStart = p;
-        while (*p && *p != ',' && *p != ' ') p++;
-
-        char *typeName = strndup(typeStart, p - typeStart);
-        DataType type = stringToDataType(typeName);
-        free(typeName);
-
-        // Create parameter (name is NULL for imported functions - we only need types)
-        FunctionParameter param = createParameter(NULL, 0, type);
-        if (param) {
-            param->pointerLevel = ptrLevel;
-            param->isPointer = (ptrLevel > 0);
-            if (ptrLevel > 0) {
-                param->type = TYPE_POINTER;
-            }
+    for (int i = 0; i < count; i++) {
+        // Name is NULL for imported functions - we only need types
+        FunctionParameter param = createParameter(arena, NULL, 0, (DataType)params[i].type);
+        if (!param) continue;
 
-            if (!first) {
-                first = param;
-            } else if (last) {
-                last->next = param;
-            }
-            last = param;
+        param->pointerLevel = params[i].pointerLevel;
+        param->isPointer = (param->pointerLevel > 0);
+        if (param->pointerLevel > 0) {
+            param->type = TYPE_POINTER;
         }
+
+        if (!first) {
+            first = param;
+        } else {
+            last->next = param;
+        }
+        last = param;
     }
 
     return first;
 }
 
-int addImportsToSymbolTable(SymbolTable table, ModuleInterface *iface) {
-    if (!table || !iface) return 0;
-
-    ExportedStruct *es = iface->structs;
+/* Decodes every export once, importers then read the table in place */
+static void materializeExports(SymbolTable table, ModuleInterface *iface) {
+    ExportedStruct *es = getInterfaceStructs(iface);
     while (es) {
-        Symbol existing = lookupSymbolCurrentOnly(table, es->name, strlen(es->name));
+        Symbol existing = lookupSymbolCurrentOnly(table, findName(es->name, strlen(es->name)));
         if (!existing) {
-            StructType structType = createStructTypeFromExport(es);
+            StructType structType = createStructTypeFromExport(table->arena, es);
             if (structType) {
-                Symbol sym = addSymbol(table, structType->nameStart, structType->nameLength,
-                                       TYPE_STRUCT, 0, 0);
+                NameId name = internName(structType->nameStart, structType->nameLength);
+                Symbol sym = addSymbol(table, name, TYPE_STRUCT, NULL);
                 if (sym) {
                     sym->symbolType = SYMBOL_TYPE;
                     sym->structType = structType;
@@ -341,28 +276,17 @@ int addImportsToSymbolTable(SymbolTable table, ModuleInterface *iface) {
         es = es->next;
     }
 
-    ExportedFunction *func = iface->functions;
+    ExportedFunction *func = getInterfaceFunctions(iface);
     while (func) {
-        const char *retTypeStr = func->returnType;
-        int returnPtrLevel = countPointerStars(&retTypeStr);
-        DataType returnType = stringToDataType(retTypeStr);
-
-        FunctionParameter params = parseParamSignature(func->signature);
-
-        int paramCount = 0;
-        FunctionParameter p = params;
-        while (p) {
-            paramCount++;
-            p = p->next;
-        }
+        FunctionParameter params = buildParamList(table->arena, func->params, func->paramCount);
 
-        Symbol funcSym =
-            addFunctionSymbolFromString(table, func->name, returnType, params, paramCount, 0, 0);
+        Symbol funcSym = addFunctionSymbolFromString(table, func->name, func->returnType, params,
+                                                     func->paramCount, NULL);
         if (funcSym) {
-            funcSym->returnPointerLevel = returnPtrLevel;
-            funcSym->returnsPointer = (returnPtrLevel > 0);
-            if (returnPtrLevel > 0) {
-                funcSym->returnBaseType = returnType;
+            funcSym->returnPointerLevel = func->returnPointerLevel;
+            funcSym->returnsPointer = (func->returnPointerLevel > 0);
+            if (func->returnPointerLevel > 0) {
+                funcSym->returnBaseType = func->returnType;
                 funcSym->type = TYPE_POINTER;
             }
         }
@@ -370,24 +294,47 @@ int addImportsToSymbolTable(SymbolTable table, ModuleInterface *iface) {
         func = func->next;
     }
 
-    return 1;
+    // Only the value comes across, reads of it are folded by the importer
+    for (ExportedConst *ec = getInterfaceConsts(iface); ec; ec = ec->next) {
+        Symbol constSym = addSymbol(table, ec->nameId, ec->value.type, NULL);
+        if (constSym) {
+            constSym->isConst = 1;
+            constSym->isInitialized = 1;
+            constSym->constValue = ec->value;
+        }
+    }
+}
+
+SymbolTable getInterfaceSymbols(ModuleInterface *iface) {
+    if (!iface) return NULL;
+    if (iface->symbols) return iface->symbols;
+
+    iface->symbolArena = createArena(MEM_SEMANTIC, INTERFACE_ARENA_CHUNK);
+    SymbolTable table = iface->symbolArena ? createSymbolTable(iface->symbolArena, NULL) : NULL;
+    if (!table) {
+        freeArena(iface->symbolArena);
+        iface->symbolArena = NULL;
+        return NULL;
+    }
+    materializeExports(table, iface);
+    iface->symbols = table;
+    return table;
 }
 
-static void freeExportedFields(ExportedField *field) {
+static void freeExportedFields(ExportedField *field, int ownsNames) {
     while (field) {
         ExportedField *next = field->next;
-        free(field->name);
-        free(field->type);
+        if (ownsNames) free(field->name);
         free(field);
         field = next;
     }
 }
 
-static void freeExportedStructs(ExportedStruct *es) {
+static void freeExportedStructs(ExportedStruct *es, int ownsNames) {
     while (es) {
         ExportedStruct *next = es->next;
-        free(es->name);
-        freeExportedFields(es->fields);
+        if (ownsNames) free(es->name);
+        freeExportedFields(es->fields, ownsNames);
         free(es);
         es = next;
     }
@@ -396,18 +343,512 @@ static void freeExportedStructs(ExportedStruct *es) {
 void freeModuleInterface(ModuleInterface *iface) {
     if (!iface) return;
 
-    free(iface->moduleName);
+    // Mapped interfaces borrow names and params from the image
+    int ownsNames = iface->image == NULL;
+    if (ownsNames) free(iface->moduleName);
 
     ExportedFunction *func = iface->functions;
     while (func) {
         ExportedFunction *next = func->next;
-        free(func->name);
-        free(func->signature);
-        free(func->returnType);
+        if (ownsNames) {
+            free(func->name);
+            free((void *)func->params);
+        }
         free(func);
         func = next;
     }
-    freeExportedStructs(iface->structs);
+    freeExportedStructs(iface->structs, ownsNames);
+
+    ExportedConst *ec = iface->consts;
+    while (ec) {
+        ExportedConst *next = ec->next;
+        if (ownsNames) free(ec->name);
+        free(ec);
+        ec = next;
+    }
 
+    // Importers' annotations point into this, so it goes with the interface
+    freeArena(iface->symbolArena);
+
+    if (iface->image) {
+        munmap((void *)iface->image, iface->imageSize);
+    }
     free(iface);
-}
\ No newline at end of file
+}
+
+/**
+ * Interface hashing
+ */
+
+static uint64_t hashString(const char *str, uint64_t hash) {
+    if (str) hash = hashBytes(str, strlen(str), hash);
+    return hashBytes("", 1, hash); // separator, so "ab","c" != "a","bc"
+}
+
+static uint64_t hashInt(long value, uint64_t hash) {
+    return hashBytes(&value, sizeof(value), hash);
+}
+
+static int compareExportedFunctions(const void *a, const void *b) {
+    const ExportedFunction *fa = *(const ExportedFunction *const *)a;
+    const ExportedFunction *fb = *(const ExportedFunction *const *)b;
+    return strcmp(fa->name, fb->name);
+}
+
+static int compareExportedStructs(const void *a, const void *b) {
+    const ExportedStruct *sa = *(const ExportedStruct *const *)a;
+    const ExportedStruct *sb = *(const ExportedStruct *const *)b;
+    return strcmp(sa->name, sb->name);
+}
+
+static int compareExportedConsts(const void *a, const void *b) {
+    const ExportedConst *ca = *(const ExportedConst *const *)a;
+    const ExportedConst *cb = *(const ExportedConst *const *)b;
+    return strcmp(ca->name, cb->name);
+}
+
+uint64_t hashModuleInterface(ModuleInterface *iface) {
+    if (!iface) return 0;
+
+    uint64_t hash = hashString(iface->moduleName, HASH_SEED);
+
+    // Exports are hashed sorted by name so reordering declarations is not a change
+    if (iface->functionCount > 0) {
+        ExportedFunction **funcs = malloc(iface->functionCount * sizeof(ExportedFunction *));
+        if (!funcs) return 0;
+        int n = 0;
+        for (ExportedFunction *f = getInterfaceFunctions(iface); f && n < iface->functionCount;
+             f = f->next) {
+            funcs[n++] = f;
+        }
+        qsort(funcs, n, sizeof(ExportedFunction *), compareExportedFunctions);
+        for (int i = 0; i < n; i++) {
+            hash = hashString("fn", hash);
+            hash = hashString(funcs[i]->name, hash);
+            hash = hashInt(funcs[i]->paramCount, hash);
+            for (int p = 0; p < funcs[i]->paramCount; p++) {
+                hash = hashInt(funcs[i]->params[p].type, hash);
+                hash = hashInt(funcs[i]->params[p].pointerLevel, hash);
+            }
+            hash = hashInt(funcs[i]->returnType, hash);
+            hash = hashInt(funcs[i]->returnPointerLevel, hash);
+        }
+        free(funcs);
+    }
+
+    if (iface->structCount > 0) {
+        ExportedStruct **structs = malloc(iface->structCount * sizeof(ExportedStruct *));
+        if (!structs) return 0;
+        int n = 0;
+        for (ExportedStruct *s = getInterfaceStructs(iface); s && n < iface->structCount;
+             s = s->next) {
+            structs[n++] = s;
+        }
+        qsort(structs, n, sizeof(ExportedStruct *), compareExportedStructs);
+        for (int i = 0; i < n; i++) {
+            hash = hashString("struct", hash);
+            hash = hashString(structs[i]->name, hash);
+            hash = hashInt(structs[i]->size, hash);
+            // Field order is part of the layout, keep declaration order
+            for (ExportedField *f = structs[i]->fields; f; f = f->next) {
+                hash = hashString(f->name, hash);
+                hash = hashInt(f->type, hash);
+                hash = hashInt(f->offset, hash);
+                hash = hashInt(f->pointerLevel, hash);
+            }
+        }
+        free(structs);
+    }
+
+    // Importers fold the values, so changing one is an interface change
+    if (iface->constCount > 0) {
+        ExportedConst **consts = malloc(iface->constCount * sizeof(ExportedConst *));
+        if (!consts) return 0;
+        int n = 0;
+        for (ExportedConst *c = getInterfaceConsts(iface); c && n < iface->constCount; c = c->next) {
+            consts[n++] = c;
+        }
+        qsort(consts, n, sizeof(ExportedConst *), compareExportedConsts);
+        for (int i = 0; i < n; i++) {
+            hash = hashString("const", hash);
+            hash = hashString(consts[i]->name, hash);
+            hash = hashInt(consts[i]->value.type, hash);
+            hash = hashBytes(&consts[i]->value.intVal, sizeof(consts[i]->value.intVal), hash);
+        }
+        free(consts);
+    }
+
+    return hash;
+}
+
+/**
+ * .orni binary format
+ *
+ * [header][consts][functions][structs][fields][params][string table]
+ *
+ * Every name is an offset into the NUL-separated string table and every
+ * type is a DataType byte, so loading is an mmap plus a header check.
+ * Records are only turned into the linked lists on first access.
+ */
+
+#define ORNI_MAGIC "ORNI"
+#define ORNI_VERSION 3
+
+typedef struct OrniHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t hash;
+    uint32_t moduleName;
+    uint32_t constCount;
+    uint32_t functionCount;
+    uint32_t structCount;
+    uint32_t fieldCount;
+    uint32_t paramCount;
+    uint32_t stringTableSize;
+} OrniHeader;
+
+// Value holds the bits of ConstValue.intVal, which double values share
+typedef struct OrniConst {
+    uint32_t name;
+    uint8_t type;
+    uint8_t reserved[3];
+    int64_t value;
+} OrniConst;
+
+typedef struct OrniFunction {
+    uint32_t name;
+    uint32_t firstParam;
+    uint16_t paramCount;
+    uint8_t returnType;
+    uint8_t returnPointerLevel;
+} OrniFunction;
+
+typedef struct OrniStruct {
+    uint32_t name;
+    uint32_t size;
+    uint32_t firstField;
+    uint32_t fieldCount;
+} OrniStruct;
+
+typedef struct OrniField {
+    uint32_t name;
+    uint32_t offset;
+    uint8_t type;
+    uint8_t pointerLevel;
+    uint16_t reserved;
+} OrniField;
+
+static const OrniHeader *orniHeader(ModuleInterface *iface) {
+    return (const OrniHeader *)iface->image;
+}
+
+static const OrniConst *orniConsts(ModuleInterface *iface) {
+    return (const OrniConst *)(iface->image + sizeof(OrniHeader));
+}
+
+static const OrniFunction *orniFunctions(ModuleInterface *iface) {
+    return (const OrniFunction *)(orniConsts(iface) + orniHeader(iface)->constCount);
+}
+
+static const OrniStruct *orniStructs(ModuleInterface *iface) {
+    return (const OrniStruct *)(orniFunctions(iface) + orniHeader(iface)->functionCount);
+}
+
+static const OrniField *orniFields(ModuleInterface *iface) {
+    return (const OrniField *)(orniStructs(iface) + orniHeader(iface)->structCount);
+}
+
+static const ExportedParam *orniParams(ModuleInterface *iface) {
+    return (const ExportedParam *)(orniFields(iface) + orniHeader(iface)->fieldCount);
+}
+
+static char *orniString(ModuleInterface *iface, uint32_t offset) {
+    const char *strings = (const char *)(orniParams(iface) + orniHeader(iface)->paramCount);
+    if (offset >= orniHeader(iface)->stringTableSize) return NULL;
+    return (char *)strings + offset;
+}
+
+ExportedFunction *getInterfaceFunctions(ModuleInterface *iface) {
+    if (!iface) return NULL;
+    if (iface->functionsDecoded) return iface->functions;
+    iface->functionsDecoded = 1;
+
+    const OrniHeader *header = orniHeader(iface);
+    const OrniFunction *records = orniFunctions(iface);
+    ExportedFunction *last = NULL;
+    int count = 0;
+
+    for (uint32_t i = 0; i < header->functionCount; i++) {
+        const OrniFunction *rec = &records[i];
+        char *name = orniString(iface, rec->name);
+        if (!name || (uint64_t)rec->firstParam + rec->paramCount > header->paramCount) continue;
+
+        ExportedFunction *ef = calloc(1, sizeof(ExportedFunction));
+        if (!ef) break;
+        ef->name = name;
+        ef->nameId = internName(name, strlen(name));
+        ef->params = orniParams(iface) + rec->firstParam;
+        ef->paramCount = rec->paramCount;
+        ef->returnType = (DataType)rec->returnType;
+        ef->returnPointerLevel = rec->returnPointerLevel;
+
+        if (!iface->functions) {
+            iface->functions = ef;
+        } else {
+            last->next = ef;
+        }
+        last = ef;
+        count++;
+    }
+
+    iface->functionCount = count;
+    return iface->functions;
+}
+
+ExportedStruct *getInterfaceStructs(ModuleInterface *iface) {
+    if (!iface) return NULL;
+    if (iface->structsDecoded) return iface->structs;
+    iface->structsDecoded = 1;
+
+    const OrniHeader *header = orniHeader(iface);
+    const OrniStruct *records = orniStructs(iface);
+    const OrniField *fields = orniFields(iface);
+    ExportedStruct *last = NULL;
+    int count = 0;
+
+    for (uint32_t i = 0; i < header->structCount; i++) {
+        const OrniStruct *rec = &records[i];
+        char *name = orniString(iface, rec->name);
+        if (!name || (uint64_t)rec->firstField + rec->fieldCount > header->fieldCount) continue;
+
+        ExportedStruct *es = calloc(1, sizeof(ExportedStruct));
+        if (!es) break;
+        es->name = name;
+        es->size = rec->size;
+
+        ExportedField *lastField = NULL;
+        for (uint32_t f = 0; f < rec->fieldCount; f++) {
+            const OrniField *fieldRec = &fields[rec->firstField + f];
+            char *fieldName = orniString(iface, fieldRec->name);
+            if (!fieldName) continue;
+
+            ExportedField *ef = calloc(1, sizeof(ExportedField));
+            if (!ef) break;
+            ef->name = fieldName;
+            ef->type = (DataType)fieldRec->type;
+            ef->offset = fieldRec->offset;
+            ef->pointerLevel = fieldRec->pointerLevel;
+            ef->isPointer = fieldRec->pointerLevel > 0;
+
+            if (!es->fields) {
+                es->fields = ef;
+            } else {
+                lastField->next = ef;
+            }
+            lastField = ef;
+            es->fieldCount++;
+        }
+
+        if (!iface->structs) {
+            iface->structs = es;
+        } else {
+            last->next = es;
+        }
+        last = es;
+        count++;
+    }
+
+    iface->structCount = count;
+    return iface->structs;
+}
+
+ExportedConst *getInterfaceConsts(ModuleInterface *iface) {
+    if (!iface) return NULL;
+    if (iface->constsDecoded) return iface->consts;
+    iface->constsDecoded = 1;
+
+    const OrniHeader *header = orniHeader(iface);
+    const OrniConst *records = orniConsts(iface);
+    ExportedConst *last = NULL;
+    int count = 0;
+
+    for (uint32_t i = 0; i < header->constCount; i++) {
+        const OrniConst *rec = &records[i];
+        char *name = orniString(iface, rec->name);
+        if (!name) continue;
+
+        ExportedConst *ec = calloc(1, sizeof(ExportedConst));
+        if (!ec) break;
+        ec->name = name;
+        ec->nameId = internName(name, strlen(name));
+        ec->value.type = (DataType)rec->type;
+        ec->value.intVal = rec->value;
+
+        if (!iface->consts) {
+            iface->consts = ec;
+        } else {
+            last->next = ec;
+        }
+        last = ec;
+        count++;
+    }
+
+    iface->constCount = count;
+    return iface->consts;
+}
+
+static uint32_t internOrniString(StringBuffer *strings, const char *str) {
+    uint32_t offset = (uint32_t)strings->len;
+    sbAppend(strings, str ? str : "");
+    sbAppendChar(strings, '\0');
+    return offset;
+}
+
+int writeModuleInterface(ModuleInterface *iface, const char *path) {
+    if (!iface || !path) return 0;
+
+    ExportedFunction *funcs = getInterfaceFunctions(iface);
+    ExportedStruct *structs = getInterfaceStructs(iface);
+    ExportedConst *consts = getInterfaceConsts(iface);
+
+    uint32_t paramCount = 0, fieldCount = 0;
+    for (ExportedFunction *f = funcs; f; f = f->next) paramCount += f->paramCount;
+    for (ExportedStruct *s = structs; s; s = s->next) fieldCount += s->fieldCount;
+
+    OrniConst *constRecs = calloc(iface->constCount ? iface->constCount : 1, sizeof(OrniConst));
+    OrniFunction *funcRecs = calloc(iface->functionCount ? iface->functionCount : 1,
+                                    sizeof(OrniFunction));
+    OrniStruct *structRecs = calloc(iface->structCount ? iface->structCount : 1,
+                                    sizeof(OrniStruct));
+    OrniField *fieldRecs = calloc(fieldCount ? fieldCount : 1, sizeof(OrniField));
+    ExportedParam *paramRecs = calloc(paramCount ? paramCount : 1, sizeof(ExportedParam));
+    StringBuffer strings = sbCreate(1024);
+    if (!constRecs || !funcRecs || !structRecs || !fieldRecs || !paramRecs || !strings.data) {
+        free(constRecs);
+        free(funcRecs);
+        free(structRecs);
+        free(fieldRecs);
+        free(paramRecs);
+        sbFree(&strings);
+        return 0;
+    }
+
+    OrniHeader header = {0};
+    memcpy(header.magic, ORNI_MAGIC, 4);
+    header.version = ORNI_VERSION;
+    header.hash = iface->hash;
+    header.moduleName = internOrniString(&strings, iface->moduleName);
+
+    uint32_t nc = 0;
+    for (ExportedConst *c = consts; c; c = c->next, nc++) {
+        constRecs[nc].name = internOrniString(&strings, c->name);
+        constRecs[nc].type = (uint8_t)c->value.type;
+        constRecs[nc].value = c->value.intVal;
+    }
+
+    uint32_t nf = 0, np = 0;
+    for (ExportedFunction *f = funcs; f; f = f->next, nf++) {
+        funcRecs[nf].name = internOrniString(&strings, f->name);
+        funcRecs[nf].firstParam = np;
+        funcRecs[nf].paramCount = (uint16_t)f->paramCount;
+        funcRecs[nf].returnType = (uint8_t)f->returnType;
+        funcRecs[nf].returnPointerLevel = (uint8_t)f->returnPointerLevel;
+        for (int p = 0; p < f->paramCount; p++) {
+            paramRecs[np++] = f->params[p];
+        }
+    }
+
+    uint32_t ns = 0, nfield = 0;
+    for (ExportedStruct *s = structs; s; s = s->next, ns++) {
+        structRecs[ns].name = internOrniString(&strings, s->name);
+        structRecs[ns].size = (uint32_t)s->size;
+        structRecs[ns].firstField = nfield;
+        structRecs[ns].fieldCount = (uint32_t)s->fieldCount;
+        for (ExportedField *field = s->fields; field; field = field->next) {
+            fieldRecs[nfield].name = internOrniString(&strings, field->name);
+            fieldRecs[nfield].offset = (uint32_t)field->offset;
+            fieldRecs[nfield].type = (uint8_t)field->type;
+            fieldRecs[nfield].pointerLevel = (uint8_t)field->pointerLevel;
+            nfield++;
+        }
+    }
+
+    header.constCount = nc;
+    header.functionCount = nf;
+    header.structCount = ns;
+    header.fieldCount = nfield;
+    header.paramCount = np;
+    header.stringTableSize = (uint32_t)strings.len;
+
+    int ok = 0;
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(constRecs, sizeof(OrniConst), nc, f) == nc &&
+             fwrite(funcRecs, sizeof(OrniFunction), nf, f) == nf &&
+             fwrite(structRecs, sizeof(OrniStruct), ns, f) == ns &&
+             fwrite(fieldRecs, sizeof(OrniField), nfield, f) == nfield &&
+             fwrite(paramRecs, sizeof(ExportedParam), np, f) == np &&
+             fwrite(strings.data, 1, strings.len, f) == strings.len;
+        ok = (fclose(f) == 0) && ok;
+    }
+
+    free(constRecs);
+    free(funcRecs);
+    free(structRecs);
+    free(fieldRecs);
+    free(paramRecs);
+    sbFree(&strings);
+    return ok;
+}
+
+ModuleInterface *readModuleInterface(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(OrniHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) return NULL;
+
+    const OrniHeader *header = image;
+    uint64_t expected = sizeof(OrniHeader) +
+                        (uint64_t)header->constCount * sizeof(OrniConst) +
+                        (uint64_t)header->functionCount * sizeof(OrniFunction) +
+                        (uint64_t)header->structCount * sizeof(OrniStruct) +
+                        (uint64_t)header->fieldCount * sizeof(OrniField) +
+                        (uint64_t)header->paramCount * sizeof(ExportedParam) +
+                        header->stringTableSize;
+    const char *lastByte = (const char *)image + size - 1;
+
+    if (memcmp(header->magic, ORNI_MAGIC, 4) != 0 || header->version != ORNI_VERSION ||
+        expected != size || header->stringTableSize == 0 || *lastByte != '\0') {
+        munmap(image, size);
+        return NULL;
+    }
+
+    ModuleInterface *iface = calloc(1, sizeof(ModuleInterface));
+    if (!iface) {
+        munmap(image, size);
+        return NULL;
+    }
+
+    iface->image = image;
+    iface->imageSize = size;
+    iface->hash = header->hash;
+    iface->functionCount = (int)header->functionCount;
+    iface->structCount = (int)header->structCount;
+    iface->constCount = (int)header->constCount;
+    iface->moduleName = orniString(iface, header->moduleName);
+    if (!iface->moduleName) {
+        freeModuleInterface(iface);
+        return NULL;
+    }
+    return iface;
+}
@@ -1,19 +1,40 @@
 #ifndef INTERFACE_H
 #define INTERFACE_H
 
+#include <stdint.h>
+
 #include "parser.h"
 #include "semantic.h"
 
+/**
+ * Parameter record, same layout in memory and in .orni so mapped
+ * interfaces point straight at the file.
+ */
+typedef struct ExportedParam {
+    uint8_t type;          // DataType
+    uint8_t pointerLevel;
+} ExportedParam;
+
 typedef struct ExportedFunction {
     char *name;
-    char *signature;
-    char *returnType;
+    NameId nameId;
+    const ExportedParam *params;
+    int paramCount;
+    DataType returnType;
+    int returnPointerLevel;
     struct ExportedFunction *next;
 } ExportedFunction;
 
+typedef struct ExportedConst {
+    char *name;
+    NameId nameId;
+    ConstValue value;
+    struct ExportedConst *next;
+} ExportedConst;
+
 typedef struct ExportedField {
     char *name;
-    char *type;
+    DataType type;
     int offset;
     int isPointer;
     int pointerLevel;
@@ -34,15 +55,47 @@ typedef struct ModuleInterface {
     int functionCount;
     ExportedStruct *structs;
     int structCount;
+    ExportedConst *consts;
+    int constCount;
+    uint64_t hash;
+
+    /* Set when loaded from a .orni, names borrow from the mapping */
+    const unsigned char *image;
+    size_t imageSize;
+    int functionsDecoded;
+    int structsDecoded;
+    int constsDecoded;
+
+    /* Exports as a frozen symbol table, built by the first importer */
+    SymbolTable symbols;
+    struct Arena *symbolArena;
 } ModuleInterface;
 
 ModuleInterface *extractExportsWithContext(ASTNode ast, const char *moduleName,
                                            TypeCheckContext ctx);
 
 /**
- * @brief Add imported functions to symbol table
+ * @brief Exported functions, decoded from the mapped .orni on first use
+ */
+ExportedFunction *getInterfaceFunctions(ModuleInterface *iface);
+
+/**
+ * @brief Exported structs, decoded from the mapped .orni on first use
+ */
+ExportedStruct *getInterfaceStructs(ModuleInterface *iface);
+
+/**
+ * @brief Exported consts and their values, decoded from the mapped .orni on first use
+ */
+ExportedConst *getInterfaceConsts(ModuleInterface *iface);
+
+/**
+ * @brief Exported functions, structs and consts as a frozen symbol table, built on first use
+ *
+ * Importers layer it under their global table with addPreludeTable(). It
+ * lives as long as the interface, NULL when it could not be built.
  */
-int addImportsToSymbolTable(SymbolTable table, ModuleInterface *iface);
+SymbolTable getInterfaceSymbols(ModuleInterface *iface);
 
 /**
  * @brief Free module interface
@@ -50,13 +103,19 @@ int addImportsToSymbolTable(SymbolTable table, ModuleInterface *iface);
 void freeModuleInterface(ModuleInterface *iface);
 
 /**
- * @brief Convert DataType to string for .orni output
+ * @brief Canonical hash of the exported surface (signatures, struct layouts and const values).
+ * Importers only need rebuilding when this value changes.
+ */
+uint64_t hashModuleInterface(ModuleInterface *iface);
+
+/**
+ * @brief Write interface to a binary .orni file
  */
-const char *dataTypeToString(DataType type);
+int writeModuleInterface(ModuleInterface *iface, const char *path);
 
 /**
- * @brief Parse type string back to DataType
+ * @brief Map a binary .orni file, NULL if missing, stale version or malformed
  */
-DataType stringToDataType(const char *str);
+ModuleInterface *readModuleInterface(const char *path);
 
 #endif // INTERFACE_H
@@ -0,0 +1,83 @@
+/**
+ * @file arena.c
+ * @brief Chunked bump allocator.
+ */
+
+#include "arena.h"
+
+#include <stdalign.h>
+
+#define ARENA_ALIGN alignof(max_align_t)
+
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t size;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+} ArenaChunk;
+
+struct Arena {
+    ArenaChunk *chunks;     // newest first, allocation happens in the head
+    size_t chunkSize;
+    MemSubsystem sys;
+};
+
+static ArenaChunk *newChunk(Arena *arena, size_t size) {
+    ArenaChunk *chunk = trackedMalloc(arena->sys, sizeof(ArenaChunk) + size);
+    if (!chunk) return NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    return chunk;
+}
+
+Arena *createArena(MemSubsystem sys, size_t chunkSize) {
+    Arena *arena = trackedMalloc(sys, sizeof(Arena));
+    if (!arena) return NULL;
+    arena->chunks = NULL;
+    arena->chunkSize = chunkSize < ARENA_ALIGN ? ARENA_ALIGN : chunkSize;
+    arena->sys = sys;
+    return arena;
+}
+
+void *arenaAlloc(Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    ArenaChunk *chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        chunk = newChunk(arena, size > arena->chunkSize ? size : arena->chunkSize);
+        if (!chunk) return NULL;
+    }
+
+    void *ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+void arenaAdopt(Arena *into, Arena *from) {
+    if (!from) return;
+    ArenaChunk *last = from->chunks;
+    if (last) {
+        while (last->next) last = last->next;
+        // Behind into's head, which keeps serving new allocations
+        if (into->chunks) {
+            last->next = into->chunks->next;
+            into->chunks->next = from->chunks;
+        } else {
+            into->chunks = from->chunks;
+        }
+    }
+    trackedFree(from->sys, from);
+}
+
+void freeArena(Arena *arena) {
+    if (!arena) return;
+    ArenaChunk *chunk = arena->chunks;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        trackedFree(arena->sys, chunk);
+        chunk = next;
+    }
+    trackedFree(arena->sys, arena);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file arena.h
+ * @brief Bump allocator for data that lives and dies together.
+ *
+ * Allocations are carved from large chunks in the order they are made and
+ * can't be freed one by one; freeArena() releases everything at once.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#include "memTrack.h"
+
+typedef struct Arena Arena;
+
+/**
+ * @brief New arena whose chunks are chunkSize bytes (larger requests get their own)
+ * @param sys Subsystem the chunks are accounted to under --mem-report
+ */
+Arena *createArena(MemSubsystem sys, size_t chunkSize);
+
+/**
+ * @brief Uninitialised block aligned for any type, NULL when out of memory
+ */
+void *arenaAlloc(Arena *arena, size_t size);
+
+/**
+ * @brief Move every chunk of from into into and free from
+ *
+ * Blocks carved from from stay where they are and are now released with
+ * into. Both arenas must count against the same subsystem.
+ */
+void arenaAdopt(Arena *into, Arena *from);
+
+/**
+ * @brief Release every chunk and the arena itself
+ */
+void freeArena(Arena *arena);
+
+#endif // ARENA_H
@@ -0,0 +1,155 @@
+/**
+ * @file interner.c
+ * @brief Paged name table plus an open-addressing index over it.
+ */
+
+#include "interner.h"
+#include "memTrack.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define PAGE_BITS 12
+#define PAGE_SIZE (1u << PAGE_BITS)
+#define MAX_PAGES 4096                  // 16M names
+#define TEXT_CHUNK_SIZE (64 * 1024)
+#define INDEX_INITIAL 4096
+
+typedef struct NameEntry {
+    const char *text;
+    uint32_t length;
+    uint32_t hash;
+} NameEntry;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Pages are allocated once and never move, readers index them without the lock */
+static NameEntry *pages[MAX_PAGES];
+static uint32_t nameCount = 1;          // id 0 is NAME_NONE
+
+static NameId *nameIndex = NULL;        // open addressing, NAME_NONE marks an empty slot
+static uint32_t indexCapacity = 0;
+
+static char *textChunk = NULL;
+static size_t textUsed = 0;
+static size_t textCapacity = 0;
+
+/* hash documentation http://www.isthe.com/chongo/tech/comp/fnv/ */
+static uint32_t hashText(const char *str, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static NameEntry *entryFor(NameId id) {
+    return &pages[id >> PAGE_BITS][id & (PAGE_SIZE - 1)];
+}
+
+static uint32_t probe(const char *str, size_t len, uint32_t hash) {
+    uint32_t mask = indexCapacity - 1;
+    uint32_t slot = hash & mask;
+    while (nameIndex[slot] != NAME_NONE) {
+        NameEntry *entry = entryFor(nameIndex[slot]);
+        if (entry->hash == hash && entry->length == len && memcmp(entry->text, str, len) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static int growIndex(void) {
+    uint32_t newCap = indexCapacity ? indexCapacity * 2 : INDEX_INITIAL;
+    NameId *newIndex = trackedCalloc(MEM_LEXER, newCap, sizeof(NameId));
+    if (!newIndex) return 0;
+
+    NameId *old = nameIndex;
+    uint32_t oldCap = indexCapacity;
+    nameIndex = newIndex;
+    indexCapacity = newCap;
+    for (uint32_t i = 0; i < oldCap; i++) {
+        if (old[i] == NAME_NONE) continue;
+        NameEntry *entry = entryFor(old[i]);
+        nameIndex[probe(entry->text, entry->length, entry->hash)] = old[i];
+    }
+    trackedFree(MEM_LEXER, old);
+    return 1;
+}
+
+static const char *copyText(const char *str, size_t len) {
+    if (textCapacity - textUsed < len + 1) {
+        size_t size = len + 1 > TEXT_CHUNK_SIZE ? len + 1 : TEXT_CHUNK_SIZE;
+        char *chunk = trackedMalloc(MEM_LEXER, size);
+        if (!chunk) return NULL;
+        textChunk = chunk;
+        textUsed = 0;
+        textCapacity = size;
+    }
+    char *copy = textChunk + textUsed;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    textUsed += len + 1;
+    return copy;
+}
+
+static NameId addName(const char *str, size_t len, uint32_t hash, uint32_t slot) {
+    NameId id = nameCount;
+    uint32_t page = id >> PAGE_BITS;
+    if (page >= MAX_PAGES) return NAME_NONE;
+    if (!pages[page]) {
+        pages[page] = trackedMalloc(MEM_LEXER, PAGE_SIZE * sizeof(NameEntry));
+        if (!pages[page]) return NAME_NONE;
+    }
+
+    const char *text = copyText(str, len);
+    if (!text) return NAME_NONE;
+
+    NameEntry *entry = entryFor(id);
+    entry->text = text;
+    entry->length = (uint32_t)len;
+    entry->hash = hash;
+    nameIndex[slot] = id;
+    nameCount++;
+    return id;
+}
+
+NameId internName(const char *str, size_t len) {
+    if (!str) return NAME_NONE;
+    uint32_t hash = hashText(str, len);
+
+    pthread_mutex_lock(&lock);
+    // Keep the load at or below 1/2 so probes stay short
+    if ((nameCount + 1) * 2 > indexCapacity && !growIndex()) {
+        pthread_mutex_unlock(&lock);
+        return NAME_NONE;
+    }
+    uint32_t slot = probe(str, len, hash);
+    NameId id = nameIndex[slot] != NAME_NONE ? nameIndex[slot] : addName(str, len, hash, slot);
+    pthread_mutex_unlock(&lock);
+    return id;
+}
+
+NameId findName(const char *str, size_t len) {
+    if (!str) return NAME_NONE;
+    uint32_t hash = hashText(str, len);
+
+    pthread_mutex_lock(&lock);
+    NameId id = indexCapacity ? nameIndex[probe(str, len, hash)] : NAME_NONE;
+    pthread_mutex_unlock(&lock);
+    return id;
+}
+
+const char *nameText(NameId id) {
+    return id == NAME_NONE ? "" : entryFor(id)->text;
+}
+
+uint32_t nameLength(NameId id) {
+    return id == NAME_NONE ? 0 : entryFor(id)->length;
+}
+
+uint32_t nameHash(NameId id) {
+    return id == NAME_NONE ? 0 : entryFor(id)->hash;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file interner.h
+ * @brief Process-wide identifier interner.
+ *
+ * The lexer interns every identifier once and later phases carry the
+ * resulting NameId, so two names are equal exactly when their ids are. Each
+ * id keeps a copy of the text and its hash, which symbol tables use as the
+ * bucket hash instead of rehashing the characters.
+ *
+ * Interning takes a lock and may run on any thread (discovery lexes in
+ * parallel). Entries never move once created, so nameText(), nameLength()
+ * and nameHash() are lock-free.
+ */
+
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t NameId;
+
+#define NAME_NONE ((NameId)0)
+
+/**
+ * @brief Id for the given text, creating it on first use (NAME_NONE on failure)
+ */
+NameId internName(const char *str, size_t len);
+
+/**
+ * @brief Id for text that was interned before, NAME_NONE otherwise
+ */
+NameId findName(const char *str, size_t len);
+
+/**
+ * @brief NUL-terminated copy of the name, valid for the whole process
+ */
+const char *nameText(NameId id);
+
+uint32_t nameLength(NameId id);
+
+/**
+ * @brief 32-bit FNV-1a of the name's text
+ */
+uint32_t nameHash(NameId id);
+
+#endif // INTERNER_H
@@ -0,0 +1,123 @@
+/**
+ * @file memTrack.c
+ * @brief Per-subsystem allocation counters.
+ */
+
+#include "memTrack.h"
+
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+typedef struct SubsystemStats {
+    atomic_uint_fast64_t allocations;
+    atomic_uint_fast64_t bytes;
+    atomic_int_fast64_t live;
+    atomic_int_fast64_t peak;
+} SubsystemStats;
+
+static const char *subsystemNames[MEM_SUBSYSTEM_COUNT] = {
+    "lexer", "parser", "semantic", "ir", "codegen"
+};
+
+static atomic_int enabled = 0;
+static SubsystemStats stats[MEM_SUBSYSTEM_COUNT];
+
+static _Thread_local MemCounters threadTotals;
+
+static void recordAlloc(MemSubsystem sys, void *ptr) {
+    size_t size = malloc_usable_size(ptr);
+    SubsystemStats *s = &stats[sys];
+
+    atomic_fetch_add(&s->allocations, 1);
+    atomic_fetch_add(&s->bytes, size);
+    int_fast64_t live = atomic_fetch_add(&s->live, (int_fast64_t)size) + (int_fast64_t)size;
+    int_fast64_t peak = atomic_load(&s->peak);
+    while (live > peak && !atomic_compare_exchange_weak(&s->peak, &peak, live)) {
+    }
+
+    threadTotals.bytes += size;
+    threadTotals.allocations++;
+}
+
+static void recordFree(MemSubsystem sys, void *ptr) {
+    atomic_fetch_sub(&stats[sys].live, (int_fast64_t)malloc_usable_size(ptr));
+}
+
+void enableMemTracking(void) {
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        atomic_store(&stats[i].allocations, 0);
+        atomic_store(&stats[i].bytes, 0);
+        atomic_store(&stats[i].live, 0);
+        atomic_store(&stats[i].peak, 0);
+    }
+    atomic_store(&enabled, 1);
+}
+
+void disableMemTracking(void) {
+    atomic_store(&enabled, 0);
+}
+
+int memTrackingEnabled(void) {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+void *trackedMalloc(MemSubsystem sys, size_t size) {
+    void *ptr = malloc(size);
+    if (ptr && memTrackingEnabled()) recordAlloc(sys, ptr);
+    return ptr;
+}
+
+void *trackedCalloc(MemSubsystem sys, size_t count, size_t size) {
+    void *ptr = calloc(count, size);
+    if (ptr && memTrackingEnabled()) recordAlloc(sys, ptr);
+    return ptr;
+}
+
+void *trackedRealloc(MemSubsystem sys, void *ptr, size_t size) {
+    if (!memTrackingEnabled()) return realloc(ptr, size);
+
+    // The old block may be released by realloc, take its size first
+    size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+    void *grown = realloc(ptr, size);
+    if (!grown) return NULL;
+
+    atomic_fetch_sub(&stats[sys].live, (int_fast64_t)oldSize);
+    recordAlloc(sys, grown);
+    return grown;
+}
+
+char *trackedStrdup(MemSubsystem sys, const char *str) {
+    char *copy = strdup(str);
+    if (copy && memTrackingEnabled()) recordAlloc(sys, copy);
+    return copy;
+}
+
+void trackedFree(MemSubsystem sys, void *ptr) {
+    if (ptr && memTrackingEnabled()) recordFree(sys, ptr);
+    free(ptr);
+}
+
+MemCounters threadMemCounters(void) {
+    return threadTotals;
+}
+
+long peakRssKb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss;
+}
+
+void printSubsystemMemReport(FILE *out) {
+    fprintf(out, "%-10s %12s %14s %14s %14s\n", "subsystem", "allocations", "allocated KiB",
+            "peak live KiB", "live KiB");
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        SubsystemStats *s = &stats[i];
+        fprintf(out, "%-10s %12llu %14.1f %14.1f %14.1f\n", subsystemNames[i],
+                (unsigned long long)atomic_load(&s->allocations),
+                atomic_load(&s->bytes) / 1024.0, atomic_load(&s->peak) / 1024.0,
+                atomic_load(&s->live) / 1024.0);
+    }
+}
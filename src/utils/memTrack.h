@@ -0,0 +1,61 @@
+/**
+ * @file memTrack.h
+ * @brief Counting allocators behind --mem-report.
+ *
+ * Each compiler subsystem allocates through the tracked* wrappers with its
+ * own tag. While tracking is off they forward straight to the C allocator.
+ * While it is on they count allocations, bytes allocated and live/peak
+ * bytes per subsystem. Sizes come from malloc_usable_size(), so there is
+ * no header and tracked blocks can still be released with plain free().
+ */
+
+#ifndef MEM_TRACK_H
+#define MEM_TRACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum MemSubsystem {
+    MEM_LEXER,
+    MEM_PARSER,
+    MEM_SEMANTIC,
+    MEM_IR,
+    MEM_CODEGEN,
+    MEM_SUBSYSTEM_COUNT
+} MemSubsystem;
+
+/**
+ * @brief Allocation totals of the calling thread across all subsystems
+ */
+typedef struct MemCounters {
+    uint64_t bytes;
+    uint64_t allocations;
+} MemCounters;
+
+void enableMemTracking(void);
+void disableMemTracking(void);
+int memTrackingEnabled(void);
+
+void *trackedMalloc(MemSubsystem sys, size_t size);
+void *trackedCalloc(MemSubsystem sys, size_t count, size_t size);
+void *trackedRealloc(MemSubsystem sys, void *ptr, size_t size);
+char *trackedStrdup(MemSubsystem sys, const char *str);
+void trackedFree(MemSubsystem sys, void *ptr);
+
+/**
+ * @brief Running totals for the calling thread, used for per-phase deltas
+ */
+MemCounters threadMemCounters(void);
+
+/**
+ * @brief Peak resident set size of the process in KiB
+ */
+long peakRssKb(void);
+
+/**
+ * @brief Allocations, bytes, peak live and still-live bytes per subsystem
+ */
+void printSubsystemMemReport(FILE *out);
+
+#endif // MEM_TRACK_H
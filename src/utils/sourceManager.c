@@ -0,0 +1,163 @@
+/**
+ * @file sourceManager.c
+ * @brief mmap-backed source loading with a zero-filled tail.
+ *
+ * The padding comes from the mapping itself. An anonymous region large
+ * enough for the file plus SOURCE_PADDING is reserved first, then the file
+ * is mapped over its start. Bytes past end of file in the last file page
+ * read as zero, and the anonymous pages behind it are zero, so no copy is
+ * needed whatever the file size.
+ */
+
+#include "sourceManager.h"
+#include "memTrack.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static SourceFile *newSource(const char *path) {
+    SourceFile *source = trackedCalloc(MEM_LEXER, 1, sizeof(SourceFile));
+    if (!source) return NULL;
+    source->path = trackedStrdup(MEM_LEXER, path ? path : "");
+    if (!source->path) {
+        trackedFree(MEM_LEXER, source);
+        return NULL;
+    }
+    return source;
+}
+
+SourceFile *mapSourceFile(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    int statOk = fstat(fd, &st) == 0;
+    if (!statOk || !S_ISREG(st.st_mode)) {
+        int err = statOk ? (S_ISDIR(st.st_mode) ? EISDIR : EINVAL) : errno;
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+
+    if ((uint64_t)st.st_size > UINT32_MAX) {
+        close(fd);
+        errno = EFBIG;
+        return NULL;
+    }
+    size_t length = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t reserved = (length + SOURCE_PADDING + page - 1) / page * page;
+
+    char *region = mmap(NULL, reserved, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (length > 0 &&
+        mmap(region, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        int err = errno;
+        munmap(region, reserved);
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+    close(fd);
+
+    SourceFile *source = newSource(path);
+    if (!source) {
+        munmap(region, reserved);
+        errno = ENOMEM;
+        return NULL;
+    }
+    source->data = region;
+    source->length = length;
+    source->mappedSize = reserved;
+    return source;
+}
+
+SourceFile *sourceFromString(const char *text, size_t length, const char *path) {
+    if (length > UINT32_MAX) {
+        errno = EFBIG;
+        return NULL;
+    }
+    SourceFile *source = newSource(path);
+    if (!source) return NULL;
+
+    char *data = trackedMalloc(MEM_LEXER, length + SOURCE_PADDING);
+    if (!data) {
+        releaseSource(source);
+        return NULL;
+    }
+    memcpy(data, text, length);
+    memset(data + length, 0, SOURCE_PADDING);
+    source->data = data;
+    source->length = length;
+    return source;
+}
+
+void releaseSource(SourceFile *source) {
+    if (!source) return;
+    if (source->mappedSize) {
+        munmap((void *)source->data, source->mappedSize);
+    } else {
+        trackedFree(MEM_LEXER, (void *)source->data);
+    }
+    trackedFree(MEM_LEXER, source->lineStarts);
+    trackedFree(MEM_LEXER, source->path);
+    trackedFree(MEM_LEXER, source);
+}
+
+static int buildLineTable(SourceFile *source) {
+    const char *end = source->data + source->length;
+    uint32_t count = 1;
+    for (const char *p = source->data; (p = memchr(p, '\n', end - p)); p++) count++;
+
+    uint32_t *starts = trackedMalloc(MEM_LEXER, count * sizeof(uint32_t));
+    if (!starts) return 0;
+    starts[0] = 0;
+    uint32_t line = 1;
+    for (const char *p = source->data; (p = memchr(p, '\n', end - p)); p++) {
+        starts[line++] = (uint32_t)(p - source->data) + 1;
+    }
+    source->lineStarts = starts;
+    source->lineCount = count;
+    return 1;
+}
+
+/* Index of the last line starting at or before offset */
+static uint32_t lineIndex(const SourceFile *source, uint32_t offset) {
+    uint32_t lo = 0, hi = source->lineCount;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (source->lineStarts[mid] <= offset) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+SourceLocation sourceLocation(SourceFile *source, uint32_t offset) {
+    SourceLocation loc = {0, 0};
+    if (!source || (!source->lineStarts && !buildLineTable(source))) return loc;
+    if (offset > source->length) offset = (uint32_t)source->length;
+    uint32_t index = lineIndex(source, offset);
+    loc.line = index + 1;
+    loc.column = offset - source->lineStarts[index] + 1;
+    return loc;
+}
+
+const char *sourceLineAt(SourceFile *source, uint32_t offset, uint32_t *length) {
+    *length = 0;
+    if (!source || (!source->lineStarts && !buildLineTable(source))) return NULL;
+    if (offset > source->length) offset = (uint32_t)source->length;
+    uint32_t index = lineIndex(source, offset);
+    uint32_t start = source->lineStarts[index];
+    uint32_t end = index + 1 < source->lineCount ? source->lineStarts[index + 1] - 1
+                                                  : (uint32_t)source->length;
+    *length = end - start;
+    return source->data + start;
+}
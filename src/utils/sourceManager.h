@@ -0,0 +1,65 @@
+/**
+ * @file sourceManager.h
+ * @brief Source buffers shared by the lexer, tokens, AST nodes and diagnostics.
+ *
+ * A SourceFile is loaded once and every later stage points into its data
+ * instead of copying it. Files are memory-mapped read-only. The data is
+ * always followed by at least SOURCE_PADDING zero bytes: the first one ends
+ * the text, and the rest let the lexer read whole chunks past the end.
+ *
+ * The buffer stays valid and never moves until releaseSource(), which
+ * unmaps (or frees) it once the module no longer needs its text.
+ *
+ * Positions are 32-bit byte offsets into data. Line and column are only
+ * worked out when asked for, from a table of line start offsets built on the
+ * first lookup. A source belongs to one module task at a time, so the table
+ * is built without locking.
+ */
+
+#ifndef SOURCE_MANAGER_H
+#define SOURCE_MANAGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SOURCE_PADDING 64
+
+typedef struct SourceFile {
+    const char *data;       // length bytes, then SOURCE_PADDING zero bytes
+    size_t length;
+    char *path;
+    size_t mappedSize;      // bytes reserved by mmap, 0 for heap buffers
+    uint32_t *lineStarts;   // offset of every line start, NULL until first lookup
+    uint32_t lineCount;
+} SourceFile;
+
+typedef struct SourceLocation {
+    uint32_t line;          // 1-based
+    uint32_t column;        // 1-based, in bytes
+} SourceLocation;
+
+/**
+ * @brief Map a file read-only, NULL (with errno set) if it cannot be opened or mapped
+ *
+ * Files whose offsets do not fit in 32 bits are refused with EFBIG.
+ */
+SourceFile *mapSourceFile(const char *path);
+
+/**
+ * @brief Padded heap copy of in-memory text, for sources that are not files
+ */
+SourceFile *sourceFromString(const char *text, size_t length, const char *path);
+
+void releaseSource(SourceFile *source);
+
+/**
+ * @brief Line and column of a byte offset, {0, 0} if the table cannot be built
+ */
+SourceLocation sourceLocation(SourceFile *source, uint32_t offset);
+
+/**
+ * @brief The line holding offset as a slice of data, without its newline
+ */
+const char *sourceLineAt(SourceFile *source, uint32_t offset, uint32_t *length);
+
+#endif // SOURCE_MANAGER_H
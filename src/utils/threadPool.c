@@ -0,0 +1,140 @@
+/**
+ * @file threadPool.c
+ * @brief pthread implementation of the worker pool.
+ */
+
+#include "threadPool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_WORKERS 64
+
+typedef struct Task {
+    TaskFunc func;
+    void *arg;
+    struct Task *next;
+} Task;
+
+struct ThreadPool {
+    pthread_t *threads;
+    int threadCount;
+
+    pthread_mutex_t lock;
+    pthread_cond_t hasWork;
+    pthread_cond_t idle;
+
+    Task *head;
+    Task *tail;
+    int pending;    // queued + running
+    int stopping;
+};
+
+int defaultWorkerCount(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) return 1;
+    return n > MAX_WORKERS ? MAX_WORKERS : (int)n;
+}
+
+static void *workerMain(void *arg) {
+    ThreadPool pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->head && !pool->stopping) {
+            pthread_cond_wait(&pool->hasWork, &pool->lock);
+        }
+        if (!pool->head) break;
+
+        Task *task = pool->head;
+        pool->head = task->next;
+        if (!pool->head) pool->tail = NULL;
+        pthread_mutex_unlock(&pool->lock);
+
+        task->func(task->arg);
+        free(task);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ThreadPool createThreadPool(int workerCount) {
+    if (workerCount <= 0) workerCount = defaultWorkerCount();
+    if (workerCount > MAX_WORKERS) workerCount = MAX_WORKERS;
+
+    ThreadPool pool = calloc(1, sizeof(struct ThreadPool));
+    if (!pool) return NULL;
+
+    pool->threads = malloc(sizeof(pthread_t) * workerCount);
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->hasWork, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    for (int i = 0; i < workerCount; i++) {
+        if (pthread_create(&pool->threads[i], NULL, workerMain, pool) != 0) break;
+        pool->threadCount++;
+    }
+    if (pool->threadCount == 0) {
+        freeThreadPool(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+int submitTask(ThreadPool pool, TaskFunc func, void *arg) {
+    Task *task = malloc(sizeof(Task));
+    if (!task) return 0;
+    task->func = func;
+    task->arg = arg;
+    task->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail) {
+        pool->tail->next = task;
+    } else {
+        pool->head = task;
+    }
+    pool->tail = task;
+    pool->pending++;
+    pthread_cond_signal(&pool->hasWork);
+    pthread_mutex_unlock(&pool->lock);
+    return 1;
+}
+
+void waitThreadPool(ThreadPool pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void freeThreadPool(ThreadPool pool) {
+    if (!pool) return;
+
+    waitThreadPool(pool);
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->hasWork);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->hasWork);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->threads);
+    free(pool);
+}
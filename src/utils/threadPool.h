@@ -0,0 +1,43 @@
+/**
+ * @file threadPool.h
+ * @brief Fixed-size worker pool with a FIFO task queue.
+ *
+ * Tasks may submit further tasks; waitThreadPool() returns once the queue
+ * is empty and no task is running, which makes it usable for worklist
+ * algorithms such as module discovery.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+typedef void (*TaskFunc)(void *arg);
+
+struct ThreadPool;
+typedef struct ThreadPool *ThreadPool;
+
+/**
+ * @brief Number of online CPUs, at least 1
+ */
+int defaultWorkerCount(void);
+
+/**
+ * @brief Start a pool with workerCount threads (<= 0 uses defaultWorkerCount)
+ */
+ThreadPool createThreadPool(int workerCount);
+
+/**
+ * @brief Queue a task, returns 0 if it could not be queued
+ */
+int submitTask(ThreadPool pool, TaskFunc func, void *arg);
+
+/**
+ * @brief Block until every submitted task (including nested ones) finished
+ */
+void waitThreadPool(ThreadPool pool);
+
+/**
+ * @brief Wait for pending work, stop the workers and free the pool
+ */
+void freeThreadPool(ThreadPool pool);
+
+#endif // THREAD_POOL_H
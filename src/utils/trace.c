@@ -0,0 +1,236 @@
+/**
+ * @file trace.c
+ * @brief Span recorder behind --time-report and --trace.
+ */
+
+#include "trace.h"
+#include "memTrack.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_REPORT_PHASES 32
+
+typedef struct TraceSpan {
+    const char *phase;
+    char *module;
+    int tid;
+    double start;   // microseconds since enableTracing()
+    double duration;
+    uint64_t bytes;
+    uint64_t allocations;
+    long peakRssKb;
+} TraceSpan;
+
+typedef struct PhaseSummary {
+    const char *phase;
+    int calls;
+    double total;
+    double slowest;
+    const char *slowestModule;
+} PhaseSummary;
+
+static int enabled = 0;
+static double origin = 0;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceSpan *spans = NULL;
+static int spanCount = 0;
+static int spanCapacity = 0;
+static int threadCount = 0;
+static int generation = 0;  // bumped by resetTracing() so thread ids restart at 0
+
+static _Thread_local int threadId = -1;
+static _Thread_local int threadGeneration = -1;
+
+static double nowUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+void enableTracing(void) {
+    resetTracing();
+    origin = nowUs();
+    enabled = 1;
+    traceEnd(NULL, NULL, traceBegin());    // claim tid 0 for the calling thread
+}
+
+int tracingEnabled(void) {
+    return enabled;
+}
+
+TraceMark traceBegin(void) {
+    TraceMark mark = {0};
+    if (!enabled) return mark;
+
+    MemCounters mem = threadMemCounters();
+    mark.time = nowUs() - origin;
+    mark.bytes = mem.bytes;
+    mark.allocations = mem.allocations;
+    return mark;
+}
+
+void traceEnd(const char *phase, const char *module, TraceMark start) {
+    if (!enabled) return;
+    double end = nowUs() - origin;
+    MemCounters mem = threadMemCounters();
+    long rss = phase ? peakRssKb() : 0;
+
+    pthread_mutex_lock(&lock);
+    if (threadGeneration != generation) {
+        threadId = threadCount++;
+        threadGeneration = generation;
+    }
+    if (!phase) {
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+
+    if (spanCount == spanCapacity) {
+        int newCap = spanCapacity == 0 ? 256 : spanCapacity * 2;
+        TraceSpan *grown = realloc(spans, sizeof(TraceSpan) * newCap);
+        if (!grown) {
+            pthread_mutex_unlock(&lock);
+            return;
+        }
+        spans = grown;
+        spanCapacity = newCap;
+    }
+    TraceSpan *span = &spans[spanCount++];
+    span->phase = phase;
+    span->module = module ? strdup(module) : NULL;
+    span->tid = threadId;
+    span->start = start.time;
+    span->duration = end - start.time;
+    span->bytes = mem.bytes - start.bytes;
+    span->allocations = mem.allocations - start.allocations;
+    span->peakRssKb = rss;
+    pthread_mutex_unlock(&lock);
+}
+
+void printTimeReport(FILE *out) {
+    PhaseSummary phases[MAX_REPORT_PHASES];
+    int phaseCount = 0;
+    double wall = nowUs() - origin;
+
+    pthread_mutex_lock(&lock);
+    // Rows keep the order phases first ran in, which follows the pipeline
+    for (int i = 0; i < spanCount; i++) {
+        TraceSpan *span = &spans[i];
+        int p = 0;
+        while (p < phaseCount && strcmp(phases[p].phase, span->phase) != 0) p++;
+        if (p == phaseCount) {
+            if (phaseCount == MAX_REPORT_PHASES) continue;
+            phases[phaseCount++] = (PhaseSummary){.phase = span->phase};
+        }
+        phases[p].calls++;
+        phases[p].total += span->duration;
+        if (span->duration >= phases[p].slowest) {
+            phases[p].slowest = span->duration;
+            phases[p].slowestModule = span->module;
+        }
+    }
+
+    fprintf(out, "\n=== TIME REPORT ===\n");
+    fprintf(out, "%-26s %6s %12s %8s %12s  %s\n", "phase", "calls", "total ms", "% wall",
+            "slowest ms", "slowest module");
+    for (int p = 0; p < phaseCount; p++) {
+        fprintf(out, "%-26s %6d %12.3f %7.1f%% %12.3f  %s\n", phases[p].phase, phases[p].calls,
+                phases[p].total / 1e3, wall > 0 ? 100.0 * phases[p].total / wall : 0,
+                phases[p].slowest / 1e3,
+                phases[p].slowestModule ? phases[p].slowestModule : "-");
+    }
+    fprintf(out, "Wall time: %.3f ms on %d thread(s)", wall / 1e3, threadCount);
+    fprintf(out, " (phases on worker threads overlap, so %% wall can sum past 100)\n");
+    pthread_mutex_unlock(&lock);
+}
+
+void printPhaseMemReport(FILE *out) {
+    pthread_mutex_lock(&lock);
+    fprintf(out, "%-16s %-26s %12s %14s %14s\n", "module", "phase", "allocations",
+            "allocated KiB", "peak RSS KiB");
+
+    // Spans of one module are recorded in pipeline order, list each module once
+    for (int i = 0; i < spanCount; i++) {
+        const char *module = spans[i].module ? spans[i].module : "-";
+        int seen = 0;
+        for (int j = 0; j < i && !seen; j++) {
+            seen = strcmp(spans[j].module ? spans[j].module : "-", module) == 0;
+        }
+        if (seen) continue;
+
+        for (int j = i; j < spanCount; j++) {
+            TraceSpan *span = &spans[j];
+            if (strcmp(span->module ? span->module : "-", module) != 0) continue;
+            fprintf(out, "%-16s %-26s %12llu %14.1f %14ld\n", module, span->phase,
+                    (unsigned long long)span->allocations, span->bytes / 1024.0,
+                    span->peakRssKb);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+static void writeJsonString(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+int writeChromeTrace(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot write trace '%s'\n", path);
+        return 0;
+    }
+
+    pthread_mutex_lock(&lock);
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int t = 0; t < threadCount; t++) {
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                   "\"args\":{\"name\":\"%s %d\"}}", t > 0 ? ",\n" : "", t,
+                t == 0 ? "main" : "worker", t);
+    }
+    for (int i = 0; i < spanCount; i++) {
+        TraceSpan *span = &spans[i];
+        fprintf(f, "%s{\"name\":", i > 0 || threadCount > 0 ? ",\n" : "");
+        writeJsonString(f, span->phase);
+        fprintf(f, ",\"cat\":\"compile\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                span->tid, span->start, span->duration);
+        fprintf(f, ",\"args\":{\"module\":");
+        writeJsonString(f, span->module ? span->module : "-");
+        fprintf(f, ",\"allocations\":%llu,\"bytes\":%llu,\"peakRssKb\":%ld}",
+                (unsigned long long)span->allocations, (unsigned long long)span->bytes,
+                span->peakRssKb);
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n]}\n");
+    pthread_mutex_unlock(&lock);
+
+    return fclose(f) == 0;
+}
+
+void resetTracing(void) {
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < spanCount; i++) {
+        free(spans[i].module);
+    }
+    free(spans);
+    spans = NULL;
+    spanCount = 0;
+    spanCapacity = 0;
+    threadCount = 0;
+    generation++;
+    enabled = 0;
+    pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file trace.h
+ * @brief Compile-time phase tracing for --time-report and --trace.
+ *
+ * Phases are bracketed with traceBegin()/traceEnd(). While tracing is off
+ * both are a single flag check, so the calls stay in the build driver
+ * permanently. Spans can be recorded from any thread; each thread gets a
+ * small sequential id (the main thread is 0) used as the Chrome trace tid.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Where a span started: time plus the thread's allocation totals
+ */
+typedef struct TraceMark {
+    double time;
+    uint64_t bytes;
+    uint64_t allocations;
+} TraceMark;
+
+/**
+ * @brief Start recording spans, wall time is measured from this call
+ */
+void enableTracing(void);
+
+/**
+ * @brief Non-zero between enableTracing() and resetTracing()
+ */
+int tracingEnabled(void);
+
+/**
+ * @brief Mark to pass to traceEnd(), zeroed when tracing is off
+ */
+TraceMark traceBegin(void);
+
+/**
+ * @brief Record a span from start to now
+ * @param phase Static string naming the phase (not copied)
+ * @param module Module the phase ran on, may be NULL (copied)
+ */
+void traceEnd(const char *phase, const char *module, TraceMark start);
+
+/**
+ * @brief Per-phase summary: calls, total, slowest module and share of wall time
+ */
+void printTimeReport(FILE *out);
+
+/**
+ * @brief Bytes and allocations made inside each span, plus peak RSS when it ended,
+ * grouped by module (needs enableMemTracking() for the allocation columns)
+ */
+void printPhaseMemReport(FILE *out);
+
+/**
+ * @brief Write recorded spans as Chrome trace-event JSON (chrome://tracing, Perfetto)
+ */
+int writeChromeTrace(const char *path);
+
+/**
+ * @brief Drop all spans and stop recording
+ */
+void resetTracing(void);
+
+#endif // TRACE_H
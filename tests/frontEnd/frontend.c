@@ -12,7 +12,7 @@ TypeCheckContext compile(const char *src) {
     if (!tokens) return NULL;
     ASTContext *ast = ASTGenerator(tokens);
     if (!ast || !ast->root) return NULL;
-    return typeCheckAST(ast->root, src, "test", NULL);
+    return typeCheckAST(ast->root, tokens->source, "test", NULL);
 }
 
 void assertPass(const char *src) {
@@ -150,6 +150,12 @@ int main() {
     RUN_TEST(test_block_scoping);
     RUN_TEST(test_inner_scope_accesses_outer);
     RUN_TEST(test_scope_variable_not_visible_outside_fails);
+    RUN_TEST(test_scope_stack_tracks_shadowing);
+    RUN_TEST(test_prelude_is_shared_between_modules);
+    RUN_TEST(test_type_check_annotates_bindings);
+    RUN_TEST(test_type_check_bodies_on_pool);
+    RUN_TEST(test_fatal_error_on_worker_waits_for_flush);
+    RUN_TEST(test_diagnostics_follow_source_order);
 
     // Pointers
     RUN_TEST(test_pointer_declaration);
@@ -162,17 +168,38 @@ int main() {
 
     // Module exports
     RUN_TEST(test_export_function);
+    RUN_TEST(test_export_const);
+    RUN_TEST(test_export_non_constant_const_fails);
+
+    // Lexer tokens and interned identifier names
+    RUN_TEST(test_every_keyword_is_recognized);
+    RUN_TEST(test_longest_operator_wins);
+    RUN_TEST(test_positions_after_long_comments_and_strings);
+    RUN_TEST(test_dense_source_outgrows_estimate);
+    RUN_TEST(test_identifiers_share_interned_names);
+    RUN_TEST(test_mapped_source_ending_on_page_boundary);
+    RUN_TEST(test_locations_past_sixteen_bits);
+
+    // Flat AST
+    RUN_TEST(test_flat_ast_matches_pointer_tree);
+    RUN_TEST(test_flat_ast_long_statement_chain);
+    RUN_TEST(test_flat_ast_cache_round_trip);
+    RUN_TEST(test_flat_ast_cache_rechecks_against_new_imports);
+    RUN_TEST(test_deferred_bodies_match_eager_parse);
 
     // Full program integration
     RUN_TEST(test_fibonacci_like);
     RUN_TEST(test_factorial_like);
     RUN_TEST(test_multi_function_program);
     RUN_TEST(test_mixed_types_program);
+    RUN_TEST(test_const_loop_runs_at_compile_time);
 
     // Arrays
     RUN_TEST(test_array_declaration);
     RUN_TEST(test_array_index_non_int_fails);
     RUN_TEST(test_array_index_out_of_bounds_const_fails);
+    RUN_TEST(test_array_size_from_const_expression);
+    RUN_TEST(test_array_index_past_const_call_size_fails);
 
     return UNITY_END();
 }
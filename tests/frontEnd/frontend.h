@@ -126,11 +126,19 @@ void test_nested_if(void);
 void test_block_scoping(void);
 void test_inner_scope_accesses_outer(void);
 void test_scope_variable_not_visible_outside_fails(void);
+void test_scope_stack_tracks_shadowing(void);
+void test_prelude_is_shared_between_modules(void);
+void test_type_check_annotates_bindings(void);
+void test_type_check_bodies_on_pool(void);
+void test_fatal_error_on_worker_waits_for_flush(void);
+void test_diagnostics_follow_source_order(void);
 
 // Arrays
 void test_array_declaration(void);
 void test_array_index_non_int_fails(void);
 void test_array_index_out_of_bounds_const_fails(void);
+void test_array_size_from_const_expression(void);
+void test_array_index_past_const_call_size_fails(void);
 
 // Pointers
 void test_pointer_declaration(void);
@@ -143,11 +151,32 @@ void test_struct_duplicate_fields_fails(void);
 
 // Modules
 void test_export_function(void);
+void test_export_const(void);
+void test_export_non_constant_const_fails(void);
+
+// Lexer
+void test_every_keyword_is_recognized(void);
+void test_longest_operator_wins(void);
+void test_positions_after_long_comments_and_strings(void);
+void test_dense_source_outgrows_estimate(void);
+void test_identifiers_share_interned_names(void);
+void test_mapped_source_ending_on_page_boundary(void);
+void test_locations_past_sixteen_bits(void);
+
+// Flat AST
+void test_flat_ast_matches_pointer_tree(void);
+void test_flat_ast_long_statement_chain(void);
+void test_flat_ast_cache_round_trip(void);
+void test_flat_ast_cache_rechecks_against_new_imports(void);
+
+// Deferred function bodies
+void test_deferred_bodies_match_eager_parse(void);
 
 // Integration programs
 void test_fibonacci_like(void);
 void test_factorial_like(void);
 void test_multi_function_program(void);
 void test_mixed_types_program(void);
+void test_const_loop_runs_at_compile_time(void);
 
 #endif // FRONTEND_H
\ No newline at end of file
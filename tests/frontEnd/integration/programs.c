@@ -1,4 +1,10 @@
 #include "../frontend.h"
+#include "unity.h"
+#include "lexer.h"
+#include "parser.h"
+#include "ir.h"
+
+#include <string.h>
 
 void test_fibonacci_like(void) {
     assertPass(
@@ -35,4 +41,53 @@ void test_mixed_types_program(void) {
         "let s: str = \"hello\";\n"
         "if (b) { i = i + 1; }"
     );
-}
\ No newline at end of file
+}
+
+static IrInstruction *findDefinition(IrContext *ir, const char *name) {
+    NameId id = internName(name, strlen(name));
+    for (IrInstruction *inst = ir->instructions; inst; inst = inst->next) {
+        if (inst->op == IR_COPY && inst->result.type == OPERAND_VAR && inst->result.value.var.id == id) {
+            return inst;
+        }
+    }
+    return NULL;
+}
+
+void test_const_loop_runs_at_compile_time(void) {
+    const char *src = "fn sumTo(n: int) -> int {\n"
+                      "    let s: int = 0; let i: int = 0;\n"
+                      "    while i < n { i++; s += i; }\n"
+                      "    return s;\n"
+                      "}\n"
+                      "fn loud(n: int) -> int { syscall(1, 1, 0, 0, 0, 0, 0); return n; }\n"
+                      "const total: int = sumTo(10);\n"
+                      "const twice: int = total * 2;\n"
+                      "const heard: int = loud(1);\n";
+    TokenList *tokens = lex(src, "test");
+    ASTContext *ast = ASTGenerator(tokens);
+    TEST_ASSERT_NOT_NULL(ast);
+    TypeCheckContext ctx = createTypeCheckContext(tokens->source, "test");
+    ctx->ast = ast;
+    TEST_ASSERT_NOT_NULL(typeCheckAST(ast->root, tokens->source, "test", ctx));
+    IrContext *ir = generateIr(ast->root, ctx);
+    TEST_ASSERT_NOT_NULL(ir);
+
+    IrInstruction *total = findDefinition(ir, "total");
+    TEST_ASSERT_NOT_NULL(total);
+    TEST_ASSERT_EQUAL_INT(OPERAND_CONSTANT, total->ar1.type);
+    TEST_ASSERT_EQUAL_INT(55, total->ar1.value.constant.intVal);
+    // Reads of a const run this way fold like any other
+    IrInstruction *twice = findDefinition(ir, "twice");
+    TEST_ASSERT_NOT_NULL(twice);
+    TEST_ASSERT_EQUAL_INT(OPERAND_CONSTANT, twice->ar1.type);
+    TEST_ASSERT_EQUAL_INT(110, twice->ar1.value.constant.intVal);
+    // A system call cannot happen at compile time, the call stays
+    IrInstruction *heard = findDefinition(ir, "heard");
+    TEST_ASSERT_NOT_NULL(heard);
+    TEST_ASSERT_EQUAL_INT(OPERAND_TEMP, heard->ar1.type);
+
+    freeIrContext(ir);
+    freeTypeCheckContext(ctx);
+    freeASTContext(ast);
+    freeTokens(tokens);
+}
@@ -0,0 +1,33 @@
+#include "../frontend.h"
+#include "unity.h"
+
+#include <string.h>
+
+void test_identifiers_share_interned_names(void) {
+    const char *src = "let count: int = 1;\n"
+                      "fn double(count: int) -> int { return count + 2; }\n";
+    TokenList *tokens = lex(src, "test");
+    TEST_ASSERT_NOT_NULL(tokens);
+
+    NameId count = NAME_NONE;
+    for (size_t i = 0; i < tokens->count; i++) {
+        Token tok = tokenAt(tokens, i);
+        if (tok.type == TK_NUM || tok.type == TK_SEMI || tok.type == TK_PLUS) {
+            TEST_ASSERT_EQUAL_UINT32(NAME_NONE, tok.name);
+            continue;
+        }
+        if (tok.length != 5 || memcmp(tokenStart(tokens, &tok), "count", 5) != 0) continue;
+        if (count == NAME_NONE) count = tok.name;
+        TEST_ASSERT_EQUAL_UINT32(count, tok.name);
+    }
+    TEST_ASSERT_NOT_EQUAL(NAME_NONE, count);
+    TEST_ASSERT_EQUAL_STRING("count", nameText(count));
+    TEST_ASSERT_EQUAL_UINT32(5, nameLength(count));
+    TEST_ASSERT_EQUAL_UINT32(count, findName("count", 5));
+
+    // keywords get ids too since they can name functions
+    TEST_ASSERT_NOT_EQUAL(NAME_NONE, findName("double", 6));
+    TEST_ASSERT_EQUAL_UINT32(NAME_NONE, findName("never lexed", 11));
+
+    freeTokens(tokens);
+}
@@ -0,0 +1,79 @@
+#include "../frontend.h"
+#include "unity.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+void test_mapped_source_ending_on_page_boundary(void) {
+    // A file filling whole pages has no slack in its last page, the zero tail
+    // has to come from the pages reserved behind it
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char path[] = "/tmp/orn_sourceXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+
+    char *text = malloc(page);
+    TEST_ASSERT_NOT_NULL(text);
+    memset(text, ' ', page);
+    memcpy(text, "let total: int = 1;", 19);
+    memcpy(text + page - 5, "count", 5);
+    TEST_ASSERT_EQUAL_INT((int)page, (int)write(fd, text, page));
+    close(fd);
+
+    SourceFile *source = mapSourceFile(path);
+    unlink(path);
+    TEST_ASSERT_NOT_NULL(source);
+    TEST_ASSERT_EQUAL_INT((int)page, (int)source->length);
+    for (size_t i = 0; i < SOURCE_PADDING; i++) {
+        TEST_ASSERT_EQUAL_INT(0, source->data[page + i]);
+    }
+
+    TokenList *tokens = lexSource(source);
+    TEST_ASSERT_NOT_NULL(tokens);
+    TEST_ASSERT_EQUAL_PTR(source->data, tokens->buffer);
+    TEST_ASSERT_EQUAL_INT(9, (int)tokens->count);
+    Token last = tokenAt(tokens, 7);
+    TEST_ASSERT_EQUAL_INT(TK_LIT, last.type);
+    TEST_ASSERT_EQUAL_INT(5, (int)last.length);
+    TEST_ASSERT_EQUAL_INT((int)page - 5, (int)last.offset);
+    TEST_ASSERT_EQUAL_INT(TK_EOF, tokenType(tokens, 8));
+    freeTokens(tokens);
+    free(text);
+
+    TEST_ASSERT_NULL(mapSourceFile("/tmp/orn_source_missing.orn"));
+}
+
+void test_locations_past_sixteen_bits(void) {
+    // 70000 empty lines, then a line whose second token starts past column 65536
+    size_t lines = 70000, pad = 70000;
+    size_t size = lines + 2 + pad + 8;
+    char *src = malloc(size);
+    TEST_ASSERT_NOT_NULL(src);
+    memset(src, '\n', lines);
+    char *p = src + lines;
+    *p++ = 'a';
+    memset(p, ' ', pad);
+    p += pad;
+    memcpy(p, "b;", 3);
+
+    TokenList *tokens = lex(src, "test");
+    TEST_ASSERT_NOT_NULL(tokens);
+    TEST_ASSERT_EQUAL_INT(4, (int)tokens->count);
+
+    Token first = tokenAt(tokens, 0), second = tokenAt(tokens, 1);
+    SourceLocation a = tokenLocation(tokens, &first);
+    SourceLocation b = tokenLocation(tokens, &second);
+    TEST_ASSERT_EQUAL_INT((int)lines + 1, (int)a.line);
+    TEST_ASSERT_EQUAL_INT(1, (int)a.column);
+    TEST_ASSERT_EQUAL_INT((int)lines + 1, (int)b.line);
+    TEST_ASSERT_EQUAL_INT((int)pad + 2, (int)b.column);
+
+    uint32_t length;
+    const char *line = tokenSourceLine(tokens, &second, &length);
+    TEST_ASSERT_EQUAL_PTR(tokens->buffer + lines, line);
+    TEST_ASSERT_EQUAL_INT((int)pad + 3, (int)length);
+    freeTokens(tokens);
+    free(src);
+}
@@ -0,0 +1,93 @@
+#include "../frontend.h"
+#include "unity.h"
+
+#include <stdlib.h>
+
+static void assertTokenTypes(const char *src, const TokenType *expected, size_t count) {
+    TokenList *tokens = lex(src, "test");
+    TEST_ASSERT_NOT_NULL(tokens);
+    TEST_ASSERT_EQUAL_INT((int)count + 1, (int)tokens->count);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_INT(expected[i], tokenType(tokens, i));
+    }
+    TEST_ASSERT_EQUAL_INT(TK_EOF, tokenType(tokens, count));
+    freeTokens(tokens);
+}
+
+void test_every_keyword_is_recognized(void) {
+    const char *src = "as bool char const double else export false float fn for from "
+                      "i16 i32 i64 i8 if import int let null return rostr str struct "
+                      "true u16 u32 u64 u8 void while";
+    const TokenType expected[] = {
+        TK_AS, TK_BOOL, TK_I8, TK_CONST, TK_DOUBLE, TK_ELSE, TK_EXPORT, TK_FALSE, TK_FLOAT,
+        TK_FN, TK_FOR, TK_FROM, TK_I16, TK_I32, TK_I64, TK_I8, TK_IF, TK_IMPORT, TK_I32,
+        TK_LET, TK_NULL, TK_RETURN, TK_STRING, TK_STR_WRAP, TK_STRUCT, TK_TRUE, TK_U16,
+        TK_U32, TK_U64, TK_U8, TK_VOID, TK_WHILE,
+    };
+    assertTokenTypes(src, expected, sizeof(expected) / sizeof(expected[0]));
+
+    // Near misses hash somewhere too and must fall back to identifiers
+    const TokenType lits[] = {TK_LIT, TK_LIT, TK_LIT, TK_LIT, TK_LIT, TK_LIT, TK_LIT};
+    assertTokenTypes("asx i9 u128 fo intx In returns", lits, sizeof(lits) / sizeof(lits[0]));
+}
+
+void test_longest_operator_wins(void) {
+    const TokenType expected[] = {
+        TK_LSHIFT_ASSIGN, TK_LSHIFT, TK_LESS_EQ, TK_LESS, TK_RSHIFT_ASSIGN, TK_RSHIFT,
+        TK_GREATER_EQ, TK_ARROW, TK_DECR, TK_MINUS_ASSIGN, TK_INCR, TK_AND, TK_AND_ASSIGN,
+        TK_OR, TK_BIT_OR, TK_NOT_EQ, TK_NOT, TK_EQ, TK_ASSIGN, TK_INVALID,
+    };
+    assertTokenTypes("<<= << <= < >>= >> >= -> -- -= ++ && &= || | != ! == = @", expected,
+                     sizeof(expected) / sizeof(expected[0]));
+}
+
+void test_positions_after_long_comments_and_strings(void) {
+    // Runs longer than one 16-byte chunk, with newlines on both sides of chunk edges
+    const char *src = "/* a block comment that spans\n"
+                      "   several lines\n\n and more than sixteen bytes */ first\n"
+                      "// line comment running past a chunk boundary\n"
+                      "    \t  \n\n          second \"a string with \\\" escapes, longer than 16\"\n"
+                      "identifier_longer_than_sixteen_bytes /*\n*/third";
+    TokenList *tokens = lex(src, "test");
+    TEST_ASSERT_NOT_NULL(tokens);
+    TEST_ASSERT_EQUAL_INT(6, (int)tokens->count);
+
+    const int lines[] = {4, 8, 8, 9, 10};
+    const int columns[] = {33, 11, 18, 1, 3};
+    for (int i = 0; i < 5; i++) {
+        Token token = tokenAt(tokens, i);
+        SourceLocation loc = tokenLocation(tokens, &token);
+        TEST_ASSERT_EQUAL_INT(lines[i], (int)loc.line);
+        TEST_ASSERT_EQUAL_INT(columns[i], (int)loc.column);
+    }
+    TEST_ASSERT_EQUAL_INT(TK_STR, tokenType(tokens, 2));
+    TEST_ASSERT_EQUAL_INT(42, (int)tokenAt(tokens, 2).length);
+    TEST_ASSERT_EQUAL_INT(36, (int)tokenAt(tokens, 3).length);
+    freeTokens(tokens);
+}
+
+void test_dense_source_outgrows_estimate(void) {
+    // Two bytes per token, twice as dense as the capacity estimate
+    size_t pairs = 50000;
+    char *src = malloc(pairs * 2 + 1);
+    TEST_ASSERT_NOT_NULL(src);
+    for (size_t i = 0; i < pairs; i++) {
+        src[2 * i] = 'x';
+        src[2 * i + 1] = ';';
+    }
+    src[pairs * 2] = '\0';
+
+    TokenList *tokens = lex(src, "test");
+    TEST_ASSERT_NOT_NULL(tokens);
+    TEST_ASSERT_EQUAL_INT((int)(pairs * 2 + 1), (int)tokens->count);
+    NameId x = findName("x", 1);
+    for (size_t i = 0; i < pairs * 2; i += 2) {
+        TEST_ASSERT_EQUAL_INT(TK_LIT, tokenType(tokens, i));
+        TEST_ASSERT_EQUAL_UINT32(x, tokenAt(tokens, i).name);
+        TEST_ASSERT_EQUAL_INT(TK_SEMI, tokenType(tokens, i + 1));
+        TEST_ASSERT_EQUAL_INT((int)i + 1, (int)tokens->offsets[i + 1]);
+    }
+    TEST_ASSERT_EQUAL_INT(TK_EOF, tokenType(tokens, pairs * 2));
+    freeTokens(tokens);
+    free(src);
+}
@@ -1,5 +1,36 @@
 #include "../frontend.h"
+#include "interface.h"
+#include "unity.h"
 
 void test_export_function(void) {
     assertPass("export fn add(a: int, b: int) -> int { return a + b; }");
-}
\ No newline at end of file
+}
+
+void test_export_const(void) {
+    assertPass("export const K: int = 6 * 7;");
+
+    // Importers only get the value, so the interface has to carry it
+    TokenList *tokens = lex("export const K: int = 6 * 7;", "test");
+    ASTContext *ast = ASTGenerator(tokens);
+    TEST_ASSERT_NOT_NULL(ast);
+    TypeCheckContext ctx = typeCheckAST(ast->root, tokens->source, "test", NULL);
+    TEST_ASSERT_NOT_NULL(ctx);
+    ModuleInterface *iface = extractExportsWithContext(ast->root, "test", ctx);
+    TEST_ASSERT_NOT_NULL(iface);
+
+    ExportedConst *k = getInterfaceConsts(iface);
+    TEST_ASSERT_NOT_NULL(k);
+    TEST_ASSERT_EQUAL_STRING("K", k->name);
+    TEST_ASSERT_EQUAL_INT(TYPE_I32, k->value.type);
+    TEST_ASSERT_EQUAL_INT(42, (int)k->value.intVal);
+    TEST_ASSERT_NULL(k->next);
+
+    freeModuleInterface(iface);
+    freeTypeCheckContext(ctx);
+    freeASTContext(ast);
+    freeTokens(tokens);
+}
+
+void test_export_non_constant_const_fails(void) {
+    assertFail("let v: int = 3; export const K: int = v;");
+}
@@ -0,0 +1,49 @@
+#include "../frontend.h"
+#include "unity.h"
+
+static void assertSameTree(ASTNode eager, ASTNode deferred) {
+    for (; eager; eager = eager->brothers, deferred = deferred->brothers) {
+        TEST_ASSERT_NOT_NULL(deferred);
+        TEST_ASSERT_EQUAL_INT(eager->nodeType, deferred->nodeType);
+        TEST_ASSERT_EQUAL_PTR(eager->start, deferred->start);
+        TEST_ASSERT_EQUAL_UINT32(eager->length, deferred->length);
+        assertSameTree(eager->children, deferred->children);
+    }
+    TEST_ASSERT_NULL(deferred);
+}
+
+void test_deferred_bodies_match_eager_parse(void) {
+    const char *src = "fn clamp(v: int, hi: int) -> int {\n"
+                      "    if (v > hi) { return hi; } else { let t: int = { v }; return t; }\n"
+                      "}\n"
+                      "const k: int = 3;\n"
+                      "fn main() -> void { let x: int = clamp(k, 2); print(x); }\n";
+    TokenList *tokens = lex(src, "test");
+    ASTContext *eager = ASTGenerator(tokens);
+    ASTContext *deferred = ASTGeneratorDeferred(tokens);
+    TEST_ASSERT_NOT_NULL(eager);
+    TEST_ASSERT_NOT_NULL(deferred);
+
+    int functions = 0;
+    for (ASTNode stmt = deferred->root->children; stmt; stmt = stmt->brothers) {
+        if (stmt->nodeType != FUNCTION_DEFINITION) continue;
+        ASTNode body = stmt->children->brothers->brothers;
+        // The placeholder spans the braces and holds nothing yet
+        TEST_ASSERT_EQUAL_INT(DEFERRED_BODY, body->nodeType);
+        TEST_ASSERT_NULL(body->children);
+        TEST_ASSERT_EQUAL_INT('{', body->start[0]);
+        TEST_ASSERT_EQUAL_INT('}', body->start[body->length - 1]);
+
+        TEST_ASSERT_EQUAL_PTR(body, functionBody(deferred, stmt));
+        TEST_ASSERT_EQUAL_INT(BLOCK_STATEMENT, body->nodeType);
+        // A parsed body is returned as is
+        TEST_ASSERT_EQUAL_PTR(body, functionBody(deferred, stmt));
+        functions++;
+    }
+    TEST_ASSERT_EQUAL_INT(2, functions);
+    assertSameTree(eager->root, deferred->root);
+
+    freeASTContext(deferred);
+    freeASTContext(eager);
+    freeTokens(tokens);
+}
@@ -0,0 +1,179 @@
+#include "../frontend.h"
+#include "flatAST.h"
+#include "arena.h"
+#include "unity.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void assertSameTree(ASTNode node, const FlatAST *flat, FlatNode n) {
+    for (; node; node = node->brothers, n = flatNextSibling(flat, n)) {
+        TEST_ASSERT_NOT_EQUAL(FLAT_NONE, n);
+        TEST_ASSERT_EQUAL_INT(node->nodeType, flatKind(flat, n));
+        TEST_ASSERT_EQUAL_INT(node->start ? node->length : 0, flatLength(flat, n));
+        TEST_ASSERT_EQUAL_UINT32(node->name, flatName(flat, n));
+        if (node->start) TEST_ASSERT_EQUAL_PTR(node->start, flatStart(flat, n));
+        // preorder numbering puts the first child right after its parent
+        if (node->children) TEST_ASSERT_EQUAL_UINT32(n + 1, flatFirstChild(flat, n));
+        assertSameTree(node->children, flat, flatFirstChild(flat, n));
+    }
+    TEST_ASSERT_EQUAL(FLAT_NONE, n);
+}
+
+void test_flat_ast_matches_pointer_tree(void) {
+    const char *src = "struct Point { x: int y: int };\n"
+                      "fn add(a: int, b: int) -> int { return a + b * 2; }\n"
+                      "let p: Point;\n"
+                      "p.x = 1;\n"
+                      "const z: int = add(p.x, 3) > 2 ? 1 : 0;\n";
+    TokenList *tokens = lex(src, "test");
+    ASTContext *ast = ASTGenerator(tokens);
+    TEST_ASSERT_NOT_NULL(ast);
+
+    FlatAST *flat = flattenAST(ast);
+    TEST_ASSERT_NOT_NULL(flat);
+    TEST_ASSERT_EQUAL_INT(PROGRAM, flatKind(flat, FLAT_ROOT));
+    TEST_ASSERT_EQUAL(FLAT_NONE, flatNextSibling(flat, FLAT_ROOT));
+    assertSameTree(ast->root->children, flat, flatFirstChild(flat, FLAT_ROOT));
+
+    freeFlatAST(flat);
+    freeASTContext(ast);
+    freeTokens(tokens);
+}
+
+void test_flat_ast_long_statement_chain(void) {
+    const int statements = 50000;
+    const char *stmt = "let a: int = 1;\n";
+    size_t len = strlen(stmt);
+    char *src = malloc(len * statements + 1);
+    for (int i = 0; i < statements; i++) memcpy(src + i * len, stmt, len);
+    src[len * statements] = '\0';
+
+    TokenList *tokens = lex(src, "test");
+    ASTContext *ast = ASTGenerator(tokens);
+    FlatAST *flat = flattenAST(ast);
+    TEST_ASSERT_NOT_NULL(flat);
+
+    int count = 0;
+    for (FlatNode n = flatFirstChild(flat, FLAT_ROOT); n; n = flatNextSibling(flat, n)) count++;
+    TEST_ASSERT_EQUAL_INT(statements, count);
+
+    freeFlatAST(flat);
+    freeASTContext(ast);
+    freeTokens(tokens);
+    free(src);
+}
+
+static void assertSameNodes(ASTNode expected, ASTNode actual) {
+    for (; expected; expected = expected->brothers, actual = actual->brothers) {
+        TEST_ASSERT_NOT_NULL(actual);
+        TEST_ASSERT_EQUAL_INT(expected->nodeType, actual->nodeType);
+        TEST_ASSERT_EQUAL_PTR(expected->start, actual->start);
+        TEST_ASSERT_EQUAL_UINT32(expected->length, actual->length);
+        TEST_ASSERT_EQUAL_UINT32(expected->name, actual->name);
+        assertSameNodes(expected->children, actual->children);
+    }
+    TEST_ASSERT_NULL(actual);
+}
+
+void test_flat_ast_cache_round_trip(void) {
+    const char *src = "import \"geom\";\n"
+                      "struct Point { x: int y: int };\n"
+                      "fn scale(p: *Point, k: int) -> void { p.x *= k; p.y = p.y * k; }\n"
+                      "const s: string = \"done\";\n";
+    TokenList *tokens = lex(src, "test");
+    char path[] = "/tmp/orn_astXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    // Bodies still waiting to be parsed cannot be stored
+    ASTContext *deferred = ASTGeneratorDeferred(tokens);
+    FlatAST *flat = flattenAST(deferred);
+    TEST_ASSERT_FALSE(saveFlatAST(flat, 42, path));
+    freeFlatAST(flat);
+    freeASTContext(deferred);
+
+    ASTContext *ast = ASTGenerator(tokens);
+    flat = flattenAST(ast);
+    TEST_ASSERT_TRUE(saveFlatAST(flat, 42, path));
+    // Another source hash means the stored tree is stale
+    TEST_ASSERT_NULL(loadFlatAST(path, 43, tokens->source));
+    ASTContext *loaded = loadFlatAST(path, 42, tokens->source);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_NULL(loaded->tokens);
+    assertSameNodes(ast->root, loaded->root);
+
+    // Moving a node to offset 0 still links up, only the payload hash tells
+    FlatNode moved = flat->count - 1;
+    while (!flat->starts[moved]) moved--;
+    FILE *f = fopen(path, "r+b");
+    TEST_ASSERT_NOT_NULL(f);
+    fseek(f, -(long)flat->count * 17 + (long)moved * 4, SEEK_END);
+    uint32_t start = 0;
+    fwrite(&start, sizeof(start), 1, f);
+    fclose(f);
+    TEST_ASSERT_NULL(loadFlatAST(path, 42, tokens->source));
+    unlink(path);
+
+    freeASTContext(loaded);
+    freeFlatAST(flat);
+    freeASTContext(ast);
+    freeTokens(tokens);
+}
+
+static ASTNode findLiteral(ASTNode node) {
+    for (; node; node = node->brothers) {
+        if (node->nodeType == LITERAL) return node;
+        ASTNode found = findLiteral(node->children);
+        if (found) return found;
+    }
+    return NULL;
+}
+
+/* Type checks root with an import declaring take(x: paramType), returns the literal's type */
+static DataType checkWithImport(ASTContext *ast, SourceFile *source, DataType paramType) {
+    Arena *arena = createArena(MEM_SEMANTIC, 1024);
+    SymbolTable imported = createSymbolTable(arena, NULL);
+    addFunctionSymbolFromString(imported, "take", TYPE_I64, createParameter(arena, NULL, 0, paramType), 1, NULL);
+
+    TypeCheckContext ctx = createTypeCheckContext(source, "test");
+    TEST_ASSERT_NOT_NULL(ctx);
+    addPreludeTable(ctx->global, imported);
+    ctx->ast = ast;
+    resetErrorCount();
+    ctx = typeCheckAST(ast->root, source, "test", ctx);
+    TEST_ASSERT_NOT_NULL(ctx);
+    TEST_ASSERT_EQUAL_INT(0, getErrorCount());
+
+    DataType type = nodeDataType(ctx, findLiteral(ast->root));
+    freeTypeCheckContext(ctx);
+    freeArena(arena);
+    return type;
+}
+
+void test_flat_ast_cache_rechecks_against_new_imports(void) {
+    TokenList *tokens = lex("let n: i64 = take(200);\n", "test");
+    char path[] = "/tmp/orn_astXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    // The build saves the tree after checking it against the imports of the day
+    ASTContext *ast = ASTGenerator(tokens);
+    TEST_ASSERT_EQUAL_INT(TYPE_I32, checkWithImport(ast, tokens->source, TYPE_I32));
+    FlatAST *flat = flattenAST(ast);
+    TEST_ASSERT_TRUE(saveFlatAST(flat, 42, path));
+
+    // Only the import changed: the literal resolves against the new parameter
+    ASTContext *loaded = loadFlatAST(path, 42, tokens->source);
+    unlink(path);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(TYPE_U8, checkWithImport(loaded, tokens->source, TYPE_U8));
+
+    freeASTContext(loaded);
+    freeFlatAST(flat);
+    freeASTContext(ast);
+    freeTokens(tokens);
+}
@@ -1,4 +1,11 @@
 #include "../frontend.h"
+#include "unity.h"
+#include "threadPool.h"
+#include "arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 void test_block_scoping(void) {
     assertPass(
@@ -19,4 +26,254 @@ void test_scope_variable_not_visible_outside_fails(void) {
         "if (true) { let y: int = 1; }\n"
         "let z: int = y;"
     );
-}
\ No newline at end of file
+}
+
+void test_scope_stack_tracks_shadowing(void) {
+    TypeCheckContext ctx = createTypeCheckContext(NULL, "test");
+    TEST_ASSERT_NOT_NULL(ctx);
+    NameId x = internName("x", 1);
+    NameId y = internName("y", 1);
+
+    Symbol outer = addSymbol(ctx->global, x, TYPE_I32, NULL);
+    SymbolTable fn = createSymbolTable(ctx->arena, ctx->global);
+    SymbolTable block = createSymbolTable(ctx->arena, fn);
+    Symbol inner = addSymbol(block, x, TYPE_BOOL, NULL);
+
+    // Entering the block pushes the function scope on the way
+    setCurrentScope(ctx, block);
+    TEST_ASSERT_EQUAL_PTR(block, ctx->scopes->top);
+    TEST_ASSERT_EQUAL_PTR(inner, lookupSymbol(block, x));
+
+    // Declared in an outer scope while the block is active: visible, but under the block's x
+    Symbol fnX = addSymbol(fn, x, TYPE_I64, NULL);
+    Symbol fnY = addSymbol(fn, y, TYPE_I64, NULL);
+    TEST_ASSERT_EQUAL_PTR(inner, lookupSymbol(block, x));
+    TEST_ASSERT_EQUAL_PTR(fnY, lookupSymbol(block, y));
+
+    setCurrentScope(ctx, fn);
+    TEST_ASSERT_EQUAL_PTR(fnX, lookupSymbol(fn, x));
+    setCurrentScope(ctx, ctx->global);
+    TEST_ASSERT_EQUAL_PTR(outer, lookupSymbol(ctx->global, x));
+    TEST_ASSERT_NULL(lookupSymbol(ctx->global, y));
+
+    // A table off the stack still resolves by walking its parents
+    TEST_ASSERT_EQUAL_PTR(inner, lookupSymbol(block, x));
+    freeTypeCheckContext(ctx);
+}
+
+void test_prelude_is_shared_between_modules(void) {
+    TypeCheckContext first = createTypeCheckContext(NULL, "first");
+    TypeCheckContext second = createTypeCheckContext(NULL, "second");
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+
+    // Built-ins are one table read by every global scope
+    NameId sys = internName("syscall", 7);
+    Symbol builtin = lookupSymbolCurrentOnly(builtInSymbols(), sys);
+    TEST_ASSERT_NOT_NULL(builtin);
+    TEST_ASSERT_EQUAL_PTR(builtin, lookupSymbol(first->global, sys));
+    TEST_ASSERT_EQUAL_PTR(builtin, lookupSymbol(second->global, sys));
+
+    // An imported table is read in place, from the stack top or by walking
+    Arena *arena = createArena(MEM_SEMANTIC, 1024);
+    SymbolTable imported = createSymbolTable(arena, NULL);
+    NameId x = internName("x", 1);
+    Symbol shared = addSymbol(imported, x, TYPE_I32, NULL);
+    TEST_ASSERT_TRUE(addPreludeTable(first->global, imported));
+    TEST_ASSERT_TRUE(addPreludeTable(second->global, imported));
+
+    SymbolTable block = createSymbolTable(first->arena, first->global);
+    setCurrentScope(first, block);
+    TEST_ASSERT_EQUAL_PTR(shared, lookupSymbol(block, x));
+    TEST_ASSERT_EQUAL_PTR(shared, lookupSymbol(second->global, x));
+
+    // It counts as part of the global scope, inner scopes may still shadow it
+    TEST_ASSERT_NULL(addSymbol(first->global, x, TYPE_BOOL, NULL));
+    Symbol inner = addSymbol(block, x, TYPE_BOOL, NULL);
+    TEST_ASSERT_EQUAL_PTR(inner, lookupSymbol(block, x));
+    setCurrentScope(first, first->global);
+    TEST_ASSERT_EQUAL_PTR(shared, lookupSymbol(first->global, x));
+    TEST_ASSERT_NULL(shared->shadowed);
+    TEST_ASSERT_EQUAL_INT(1, imported->symbolCount);
+
+    freeTypeCheckContext(first);
+    freeTypeCheckContext(second);
+    freeArena(arena);
+}
+
+/* Records the symbol bound to every x read under node, in source order */
+static int collectReads(TypeCheckContext ctx, ASTNode node, NameId x, Symbol *out, int count) {
+    for (; node; node = node->brothers) {
+        if (node->nodeType == VARIABLE && node->name == x) out[count++] = nodeSymbol(ctx, node);
+        count = collectReads(ctx, node->children, x, out, count);
+    }
+    return count;
+}
+
+void test_type_check_annotates_bindings(void) {
+    const char *src = "let x: int = 1;\n"
+                      "fn f(x: i64) -> i64 { let y: i64 = x + 2; return y; }\n"
+                      "if (true) { let x: bool = true; let z: bool = x; }\n"
+                      "let w: int = x * 3;\n";
+    TokenList *tokens = lex(src, "test");
+    ASTContext *ast = ASTGenerator(tokens);
+    TEST_ASSERT_NOT_NULL(ast);
+    TypeCheckContext ctx = typeCheckAST(ast->root, tokens->source, "test", NULL);
+    TEST_ASSERT_NOT_NULL(ctx);
+    TEST_ASSERT_EQUAL_INT(0, getErrorCount());
+
+    NameId x = internName("x", 1);
+    Symbol reads[4];
+    TEST_ASSERT_EQUAL_INT(3, collectReads(ctx, ast->root, x, reads, 0));
+    // Each read is bound to the declaration in scope, not to whatever x came last
+    TEST_ASSERT_EQUAL_INT(TYPE_I64, reads[0]->type);
+    TEST_ASSERT_EQUAL_INT(TYPE_BOOL, reads[1]->type);
+    TEST_ASSERT_EQUAL_PTR(lookupSymbol(ctx->global, x), reads[2]);
+
+    // Declarations carry their own symbol, expressions their type
+    ASTNode fn = ast->root->children->brothers;
+    TEST_ASSERT_EQUAL_INT(FUNCTION_DEFINITION, fn->nodeType);
+    TEST_ASSERT_EQUAL_PTR(lookupSymbol(ctx->global, fn->name), nodeSymbol(ctx, fn));
+    ASTNode w = fn->brothers->brothers->children;
+    ASTNode product = w->children->brothers->children;
+    TEST_ASSERT_EQUAL_INT(MUL_OP, product->nodeType);
+    TEST_ASSERT_EQUAL_INT(TYPE_I32, nodeDataType(ctx, product));
+    TEST_ASSERT_EQUAL_PTR(lookupSymbol(ctx->global, w->name), nodeSymbol(ctx, w));
+
+    freeTypeCheckContext(ctx);
+    freeASTContext(ast);
+    freeTokens(tokens);
+}
+
+/* Checks src with bodies on pool (NULL checks them in turn), returns the error count */
+static int checkOnPool(const char *src, ThreadPool pool, DataType *returned, int functions) {
+    TokenList *tokens = lex(src, "test");
+    ASTContext *ast = ASTGeneratorDeferred(tokens);
+    TEST_ASSERT_NOT_NULL(ast);
+    TypeCheckContext ctx = createTypeCheckContext(tokens->source, "test");
+    ctx->ast = ast;
+    ctx->pool = pool;
+    resetErrorCount();
+    ctx = typeCheckAST(ast->root, tokens->source, "test", ctx);
+    int errors = getErrorCount();
+    if (ctx) {
+        int i = 0;
+        for (ASTNode fn = ast->root->children; fn; fn = fn->brothers) {
+            if (fn->nodeType != FUNCTION_DEFINITION) continue;
+            // The body was expanded on a worker, its nodes were annotated there
+            ASTNode body = fn->children->brothers->brothers;
+            TEST_ASSERT_EQUAL_INT(BLOCK_STATEMENT, body->nodeType);
+            ASTNode ret = body->children->brothers->children;
+            TEST_ASSERT_EQUAL_INT(VARIABLE, ret->nodeType);
+            Symbol v = nodeSymbol(ctx, ret);
+            TEST_ASSERT_NOT_NULL(v);
+            TEST_ASSERT_EQUAL_PTR(nodeSymbol(ctx, body->children->children), v);
+            if (i < functions) returned[i] = v->type;
+            i++;
+        }
+        TEST_ASSERT_EQUAL_INT(functions, i);
+        freeTypeCheckContext(ctx);
+    }
+    freeASTContext(ast);
+    freeTokens(tokens);
+    return errors;
+}
+
+void test_type_check_bodies_on_pool(void) {
+    enum { FUNCTIONS = 40 };
+    char src[FUNCTIONS * 80 + 64];
+    size_t len = snprintf(src, sizeof(src), "const k: int = 2;\n");
+    for (int i = 0; i < FUNCTIONS; i++) {
+        const char *type = i % 3 ? "int" : "i64";
+        len += snprintf(src + len, sizeof(src) - len,
+                        "fn f%d(p: %s) -> %s { let v: %s = p + %d; return v; }\n", i, type, type, type, i);
+    }
+    ThreadPool pool = createThreadPool(4);
+    DataType returned[FUNCTIONS];
+    TEST_ASSERT_EQUAL_INT(0, checkOnPool(src, pool, returned, FUNCTIONS));
+    for (int i = 0; i < FUNCTIONS; i++) {
+        TEST_ASSERT_EQUAL_INT(i % 3 ? TYPE_I32 : TYPE_I64, returned[i]);
+    }
+
+    // A body sees the globals declared above its function and no others,
+    // and the buffered errors add up to what checking in turn reports
+    len = 0;
+    for (int i = 0; i < FUNCTIONS; i++) {
+        len += snprintf(src + len, sizeof(src) - len,
+                        "fn g%d(p: int) -> int { let v: int = p + late; return v; }\n", i);
+    }
+    snprintf(src + len, sizeof(src) - len, "let late: int = 1;\n");
+    int errors = checkOnPool(src, pool, returned, FUNCTIONS);
+    TEST_ASSERT_TRUE(errors >= FUNCTIONS);
+    TEST_ASSERT_EQUAL_INT(errors, checkOnPool(src, NULL, returned, FUNCTIONS));
+    freeThreadPool(pool);
+}
+
+void test_fatal_error_on_worker_waits_for_flush(void) {
+    DiagnosticBuffer buffer;
+    TEST_ASSERT_TRUE(beginDiagnostics(&buffer));
+    int fatals = getFatalCount();
+    repError(ERROR_INTERNAL_PARSER_ERROR, "test");
+    repError(ERROR_MEMORY_ALLOCATION_FAILED, "test");
+    endDiagnostics();
+
+    // Still running: the first fatal waits in the buffer for its turn to be printed
+    TEST_ASSERT_EQUAL_INT(ERROR_INTERNAL_PARSER_ERROR, buffer.fatal);
+    TEST_ASSERT_EQUAL_INT(fatals, getFatalCount());
+    free(buffer.text);
+}
+
+/* Type checks a program that fails with its diagnostics printed into a buffer, the text is the caller's */
+static char *captureFailedCheck(const char *src, ThreadPool pool) {
+    TokenList *tokens = lex(src, "test");
+    ASTContext *ast = ASTGeneratorDeferred(tokens);
+    TEST_ASSERT_NOT_NULL(ast);
+    TypeCheckContext ctx = createTypeCheckContext(tokens->source, "test");
+    ctx->ast = ast;
+    ctx->pool = pool;
+    DiagnosticBuffer buffer;
+    TEST_ASSERT_TRUE(beginDiagnostics(&buffer));
+    setSilentMode(0);
+    TEST_ASSERT_NULL(typeCheckAST(ast->root, tokens->source, "test", ctx));
+    setSilentMode(1);
+    endDiagnostics();
+    freeASTContext(ast);
+    freeTokens(tokens);
+    return buffer.text;
+}
+
+static void assertReportedInOrder(const char *text, const char *first, const char *second) {
+    const char *a = strstr(text, first);
+    const char *b = strstr(text, second);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(a < b);
+}
+
+void test_diagnostics_follow_source_order(void) {
+    // Bodies are checked after every declaration, their errors still come in between
+    char *text = captureFailedCheck("let q: int = 5;\n"
+                                    "fn f() -> int { let a: int = undefinedThing; return a; }\n"
+                                    "let y: int = nope;\n", NULL);
+    TEST_ASSERT_NOT_NULL(text);
+    assertReportedInOrder(text, "undefinedThing", "nope");
+    free(text);
+
+    // The same across the tasks of a pool
+    enum { FUNCTIONS = 40 };
+    char src[FUNCTIONS * 80 + 64];
+    size_t len = 0;
+    for (int i = 0; i < FUNCTIONS; i++) {
+        const char *value = i == 3 ? "missingEarly" : i == 30 ? "missingLate" : "p";
+        len += snprintf(src + len, sizeof(src) - len,
+                        "fn g%d(p: int) -> int { let v: int = %s; return v; }\n", i, value);
+        if (i == 10) len += snprintf(src + len, sizeof(src) - len, "fn g5(p: int) -> int { return p; }\n");
+    }
+    ThreadPool pool = createThreadPool(4);
+    text = captureFailedCheck(src, pool);
+    freeThreadPool(pool);
+    TEST_ASSERT_NOT_NULL(text);
+    assertReportedInOrder(text, "missingEarly", "(g5)");
+    assertReportedInOrder(text, "(g5)", "missingLate");
+    free(text);
+}
@@ -10,4 +10,13 @@ void test_array_index_non_int_fails(void) {
 
 void test_array_index_out_of_bounds_const_fails(void) {
     assertFail("let arr: int[2]; const idx: int = 2; let x: int = arr[idx];");
-}
\ No newline at end of file
+}
+
+void test_array_size_from_const_expression(void) {
+    assertPass("const n: int = 2 * 3; let arr: int[n + 1]; let x: int = arr[6];");
+}
+
+void test_array_index_past_const_call_size_fails(void) {
+    assertFail("fn square(v: int) -> int { return v * v; } const n: int = square(3); "
+               "let arr: int[n]; let x: int = arr[9];");
+}
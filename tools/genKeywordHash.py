@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Generate the keyword perfect hash used by src/frontend/lexer/lexer.c.
+
+Each keyword is reduced to a 32-bit key made of its first two bytes, its last
+byte and its length (see keywordKey() in lexer.c). A first multiplicative hash
+picks one of KEYWORD_BUCKETS buckets; every bucket stores a displacement that
+sends its keys to free slots of a table with exactly one slot per keyword.
+Buckets are placed largest first, trying displacements in increasing order.
+
+Run it after changing the keyword set and paste the output over the block
+between the "generated by tools/genKeywordHash.py" markers in lexer.c.
+"""
+
+KEYWORDS = [
+    ("as", "TK_AS"), ("bool", "TK_BOOL"), ("char", "TK_I8"), ("const", "TK_CONST"),
+    ("double", "TK_DOUBLE"), ("else", "TK_ELSE"), ("export", "TK_EXPORT"),
+    ("false", "TK_FALSE"), ("float", "TK_FLOAT"), ("fn", "TK_FN"), ("for", "TK_FOR"),
+    ("from", "TK_FROM"), ("i16", "TK_I16"), ("i32", "TK_I32"), ("i64", "TK_I64"),
+    ("i8", "TK_I8"), ("if", "TK_IF"), ("import", "TK_IMPORT"), ("int", "TK_I32"),
+    ("let", "TK_LET"), ("null", "TK_NULL"), ("return", "TK_RETURN"), ("rostr", "TK_STRING"),
+    ("str", "TK_STR_WRAP"), ("struct", "TK_STRUCT"), ("true", "TK_TRUE"), ("u16", "TK_U16"),
+    ("u32", "TK_U32"), ("u64", "TK_U64"), ("u8", "TK_U8"), ("void", "TK_VOID"),
+    ("while", "TK_WHILE"),
+]
+
+BUCKET_BITS = 3
+SLOT_BITS = 5
+MASK32 = 0xFFFFFFFF
+
+
+def key(word):
+    b = word.encode()
+    return b[0] | b[1] << 8 | b[-1] << 16 | len(b) << 24
+
+
+def bucket(k):
+    return ((k * 0x9E3779B1) & MASK32) >> (32 - BUCKET_BITS)
+
+
+def slot(k, displacement):
+    return (((k ^ displacement) * 0x85EBCA6B) & MASK32) >> (32 - SLOT_BITS)
+
+
+def main():
+    assert len(KEYWORDS) == 1 << SLOT_BITS, "table must have one slot per keyword"
+    keys = [key(w) for w, _ in KEYWORDS]
+    assert len(set(keys)) == len(keys), "two keywords share a key"
+
+    buckets = [[] for _ in range(1 << BUCKET_BITS)]
+    for i, k in enumerate(keys):
+        buckets[bucket(k)].append(i)
+
+    table = [None] * (1 << SLOT_BITS)
+    displacements = [0] * len(buckets)
+    for b in sorted(range(len(buckets)), key=lambda b: -len(buckets[b])):
+        for d in range(1 << 16):
+            slots = [slot(keys[i], d) for i in buckets[b]]
+            if len(set(slots)) == len(slots) and all(table[s] is None for s in slots):
+                for i, s in zip(buckets[b], slots):
+                    table[s] = i
+                displacements[b] = d
+                break
+        else:
+            raise SystemExit("no displacement found for bucket %d" % b)
+
+    print("/* generated by tools/genKeywordHash.py, do not edit */")
+    print("#define KEYWORD_BUCKET_BITS %d" % BUCKET_BITS)
+    print("#define KEYWORD_SLOT_BITS %d" % SLOT_BITS)
+    print()
+    print("static const uint16_t keywordDisplacement[1 << KEYWORD_BUCKET_BITS] = {")
+    print("\t" + ", ".join(str(d) for d in displacements))
+    print("};")
+    print()
+    print("static const Keyword keywords[1 << KEYWORD_SLOT_BITS] = {")
+    for i in table:
+        word, tok = KEYWORDS[i]
+        print('\t{"%s", %d, %s},' % (word, len(word), tok))
+    print("};")
+    print("/* end of generated keyword hash */")
+
+
+if __name__ == "__main__":
+    main()